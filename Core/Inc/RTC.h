@@ -6,6 +6,7 @@
 
 #include "stm32f1xx_hal.h"
 #include <stdint.h>
+#include <stdbool.h>
 
 /**
  * @brief Struktura przechowująca dane o czasie
@@ -39,4 +40,23 @@ void RTC_SetTime(const RTC_TimeTypeDef *time);
  */
 void RTC_ReadTime(RTC_TimeTypeDef *time);
 
+/**
+ * @brief  Odczyt samych sekund (1 bajt po I2C) – wykrywanie granicy sekundy.
+ * @param  seconds: wskaźnik na wynik (0..59).
+ * @retval true, jeśli odczyt się udał.
+ */
+bool RTC_ReadSeconds(uint8_t *seconds);
+
+/**
+ * @brief  Odczyt / zapis bajtu RAM układu (rejestr 0x03, podtrzymywany bateryjnie).
+ * @retval true, jeśli transakcja I2C się udała.
+ */
+bool RTC_ReadRam(uint8_t *value);
+bool RTC_WriteRam(uint8_t value);
+
+/**
+ * @brief  Liczba nieudanych transakcji I2C z RTC od startu (telemetria).
+ */
+uint16_t RTC_GetErrorCount(void);
+
 #endif /* RTC_H */
@@ -15,4 +15,41 @@ void CheckAlarmTrigger(const RTC_TimeTypeDef *rtc_info);
  */
 void AlarmPreSet(void);
 
+/**
+ * @brief Zapis bieżącego alarmu (alarmData) w pamięci ustawień – przetrwa reset.
+ */
+void Alarm_Save(void);
+
+/**
+ * @brief Ile sekund zostało do alarmu (telemetria).
+ * @param now Aktualny czas RTC.
+ * @return Sekundy do alarmu lub -1, jeśli alarm już minął.
+ */
+int32_t Alarm_SecondsToGo(const RTC_TimeTypeDef *now);
+
+/**
+ * @brief Alarm jako sekundy od 2000-01-01 (calendar.h) i ustawienie z tej postaci.
+ */
+uint32_t Alarm_GetEpoch(void);
+void Alarm_SetEpoch(uint32_t epoch);
+
+/**
+ * @brief Przycięcie daty alarmu do długości miesiąca (np. po zmianie miesiąca
+ *        z 31.01 na luty) i przeliczenie dnia tygodnia.
+ */
+void Alarm_Normalize(void);
+
+/**
+ * @brief Drzemka: alarm ponownie ALARM_SNOOZE_S od teraz (przeniesienie przez
+ *        północ, koniec miesiąca i roku). Zmienia tylko alarm w RAM.
+ */
+void Alarm_Snooze(const RTC_TimeTypeDef *now);
+
+/**
+ * @brief Przesunięcie drzemki względem alarmu zapisanego we flashu (sekundy, 0 = brak)
+ *        i jego odtworzenie po resecie (resume.c).
+ */
+uint16_t Alarm_GetSnoozeS(void);
+void Alarm_RestoreSnooze(uint16_t seconds);
+
 #endif /* INC_ALARM_H_ */
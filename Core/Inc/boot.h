@@ -0,0 +1,52 @@
+// Created by: Marcin Dziedzic
+// boot.h
+
+#ifndef BOOT_H
+#define BOOT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Etapy startu (w kolejności). Czasy liczone od HAL_Init.
+ *        Do BOOT_FIRST_FRAME wszystko dzieje się przed pętlą główną,
+ *        dalej – w kolejnych obiegach pętli (inicjalizacja odroczona).
+ */
+typedef enum
+{
+    BOOT_PERIPH,       /**< Peryferia CubeMX (GPIO, DMA, UART, TIM, I2C) */
+    BOOT_DRIVERS,      /**< Lampa, obwiednie, enkoder, przycisk, UART, ustawienia */
+    BOOT_LCD,          /**< Inicjalizacja wyświetlacza */
+    BOOT_FIRST_FRAME,  /**< Ekran startowy na LCD */
+    BOOT_RTC,          /**< Pierwszy odczyt RTC (odroczony) */
+    BOOT_UI,           /**< Menu/stan sprzed resetu odtworzony – UI reaguje na enkoder */
+    BOOT_SENSOR,       /**< Czujnik światła uruchomiony (odroczony) */
+    BOOT_READY,        /**< Pierwsza próbka czujnika – wszystko działa */
+    BOOT_STAGE_COUNT
+} BootStage_e;
+
+/**
+ * @brief Znacznik czasu zakończenia etapu (tylko pierwsze wywołanie się liczy).
+ *        BOOT_READY wysyła też raport przez USART2.
+ */
+void Boot_Mark(BootStage_e stage);
+
+/**
+ * @brief Czy etap został już zakończony?
+ */
+bool Boot_Done(BootStage_e stage);
+
+/**
+ * @brief Raport startu (czasy etapów w ms) przez bufor nadawczy USART2.
+ */
+void Boot_Report(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BOOT_H
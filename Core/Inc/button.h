@@ -0,0 +1,90 @@
+// Created by: Marcin Dziedzic
+// button.h
+
+#ifndef BUTTON_H
+#define BUTTON_H
+
+#include "stm32f1xx_hal.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Próg integratora (ms): tyle kolejnych "głosów" za nowym stanem, zanim
+ *        zostanie on uznany. Jednocześnie stała zwłoka reakcji przycisku.
+ */
+#define BUTTON_INTEGRATOR_MAX   5U
+
+/**
+ * @brief Czasy zdarzeń (ms).
+ *        LONG    – przytrzymanie dłuższe niż BUTTON_LONG_MS,
+ *        REPEAT  – co BUTTON_REPEAT_MS po zdarzeniu LONG (dopóki wciśnięty),
+ *        DOUBLE  – drugie wciśnięcie w czasie BUTTON_DOUBLE_MS od puszczenia.
+ */
+#define BUTTON_LONG_MS          800U
+#define BUTTON_REPEAT_MS        150U
+#define BUTTON_DOUBLE_MS        300U
+
+/**
+ * @brief Pojemność kolejki zdarzeń (potęga 2).
+ */
+#define BUTTON_QUEUE_LEN        8U
+
+/**
+ * @brief Rodzaj zdarzenia przycisku.
+ */
+typedef enum
+{
+    BTN_EVT_PRESS,      /**< Wciśnięcie (po odfiltrowaniu drgań) */
+    BTN_EVT_RELEASE,    /**< Puszczenie */
+    BTN_EVT_LONG,       /**< Długie przytrzymanie (raz na wciśnięcie) */
+    BTN_EVT_DOUBLE,     /**< Drugie wciśnięcie krótko po pierwszym (po BTN_EVT_PRESS) */
+    BTN_EVT_REPEAT      /**< Autopowtarzanie przy przytrzymaniu */
+} ButtonEventType_e;
+
+/**
+ * @brief Zdarzenie z kolejki: rodzaj + chwila wystąpienia (HAL_GetTick, ms).
+ */
+typedef struct
+{
+    uint8_t  type;      /**< ButtonEventType_e */
+    uint32_t timeMs;    /**< Znacznik czasu zdarzenia */
+} ButtonEvent_t;
+
+/**
+ * @brief Inicjalizacja – pin przycisku (aktywny stan niski, podciągnięty do VCC).
+ * @param port Port GPIO przycisku
+ * @param pin  Pin GPIO przycisku
+ */
+void Button_Init(GPIO_TypeDef *port, uint16_t pin);
+
+/**
+ * @brief Próbkowanie przycisku – wywoływane co 1 ms z SysTick_Handler.
+ */
+void Button_Tick(void);
+
+/**
+ * @brief Pobranie najstarszego zdarzenia z kolejki.
+ * @param evt Miejsce na zdarzenie
+ * @return true, jeśli zdarzenie było dostępne
+ */
+bool Button_GetEvent(ButtonEvent_t *evt);
+
+/**
+ * @brief Czy przycisk jest (po odfiltrowaniu) wciśnięty?
+ */
+bool Button_IsDown(void);
+
+/**
+ * @brief Liczba zdarzeń utraconych przez przepełnienie kolejki.
+ */
+uint32_t Button_GetDropped(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BUTTON_H */
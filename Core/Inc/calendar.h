@@ -0,0 +1,70 @@
+// Created by: Marcin Dziedzic
+// calendar.h
+
+#ifndef CALENDAR_H
+#define CALENDAR_H
+
+#include "RTC.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Zakres kalendarza = zakres PCF85063: lata 2000..2099 (pole year 0..99).
+ *        Epoka: 2000-01-01 00:00:00 (sobota). W tym zakresie co czwarty rok
+ *        jest przestępny (2000 dzieli się przez 400, 2100 już poza zakresem).
+ */
+#define CAL_SECONDS_PER_DAY   86400UL
+#define CAL_YEAR_MAX          99U
+
+/**
+ * @brief Czy rok (0..99 => 2000..2099) jest przestępny?
+ */
+bool Cal_IsLeap(uint8_t year);
+
+/**
+ * @brief Liczba dni miesiąca (28..31); 0 dla miesiąca spoza 1..12.
+ */
+uint8_t Cal_DaysInMonth(uint8_t year, uint8_t month);
+
+/**
+ * @brief Numer dnia od 2000-01-01 (= 0). Pola muszą być poprawne (Cal_IsValid).
+ */
+uint16_t Cal_DayNumber(uint8_t year, uint8_t month, uint8_t day);
+
+/**
+ * @brief Dzień tygodnia: 0 = niedziela ... 6 = sobota (konwencja PCF85063).
+ */
+uint8_t Cal_Weekday(uint8_t year, uint8_t month, uint8_t day);
+
+/**
+ * @brief Czas -> sekundy od 2000-01-01 00:00:00 (stały czas, bez pętli po latach).
+ *        Pole weekday jest ignorowane.
+ */
+uint32_t Cal_ToEpoch(const RTC_TimeTypeDef *t);
+
+/**
+ * @brief Sekundy od 2000-01-01 -> czas (łącznie z dniem tygodnia), stały czas.
+ */
+void Cal_FromEpoch(uint32_t epoch, RTC_TimeTypeDef *t);
+
+/**
+ * @brief Czy wszystkie pola mieszczą się w zakresie (dzień wg długości miesiąca)?
+ *        Pole weekday jest pomijane – zawsze wynika z daty.
+ */
+bool Cal_IsValid(const RTC_TimeTypeDef *t);
+
+/**
+ * @brief Przycięcie pól do zakresów (dzień do długości miesiąca, np. 31.02 -> 28/29.02)
+ *        i przeliczenie dnia tygodnia.
+ */
+void Cal_Clamp(RTC_TimeTypeDef *t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CALENDAR_H
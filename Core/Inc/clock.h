@@ -0,0 +1,49 @@
+// Created by: Marcin Dziedzic
+// clock.h
+
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include "RTC.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Margines (ms) przed przewidywaną zmianą sekundy, od którego zaczynamy
+ *        odpytywać RTC. Poza oknem czas pochodzi z pamięci podręcznej.
+ */
+#define CLOCK_GUARD_MS       30U
+
+/**
+ * @brief Inicjalizacja: pełny odczyt RTC; granica sekundy nie jest jeszcze znana.
+ */
+void Clock_Init(void);
+
+/**
+ * @brief Śledzenie granicy sekundy RTC – wywoływane w każdym obiegu pętli.
+ *        W pobliżu przewidywanej zmiany czyta sam rejestr sekund (1 bajt),
+ *        a po jej wykryciu – pełny czas (raz na sekundę).
+ * @param now Aktualny czas (HAL_GetTick())
+ * @return true w obiegu, w którym wykryto nową sekundę RTC.
+ */
+bool Clock_Poll(uint32_t now);
+
+/**
+ * @brief Ponowny pełny odczyt i utrata synchronizacji – wołać po RTC_SetTime().
+ */
+void Clock_Resync(void);
+
+/**
+ * @brief Ostatnio odczytany czas RTC (aktualny z dokładnością do obiegu pętli).
+ */
+const RTC_TimeTypeDef *Clock_Now(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CLOCK_H
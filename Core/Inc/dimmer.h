@@ -0,0 +1,75 @@
+// Created by: Marcin Dziedzic
+// dimmer.h
+
+#ifndef DIMMER_H
+#define DIMMER_H
+
+#include "stm32f1xx_hal.h"
+#include "r_encoder.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Skala ściemniacza: jasność postrzegana (CIE L*) w procentach 0..100.
+ */
+#define DIMMER_POS_MAX          100U
+
+/**
+ * @brief Maksymalny krok (w %) przy szybkim obrocie (REncoder_Accelerate).
+ */
+#define DIMMER_STEP_MAX         10U
+
+/**
+ * @brief Przejęcie lampy przez ściemniacz. Pozycja startowa odpowiada bieżącej
+ *        jasności; od tej chwili ząbek enkodera przestawia CCR lampy z przerwania
+ *        (capture CC1/CC2 TIM1 albo Dimmer_Tick), więc zmiana wchodzi z najbliższym
+ *        okresem PWM.
+ *        Przed wywołaniem kanał trzeba zwolnić (fade, regulator, obwiednia).
+ * @param henc     Enkoder (timer i liczba zliczeń na ząbek)
+ * @param htimPwm  Timer PWM lampy (TIM3)
+ * @param channel  Kanał PWM lampy
+ */
+void Dimmer_Enter(REncoder_HandleTypeDef *henc, TIM_HandleTypeDef *htimPwm, uint32_t channel);
+
+/**
+ * @brief Zwolnienie lampy – wyłącza przerwania enkodera, jasność zostaje.
+ */
+void Dimmer_Exit(void);
+
+/**
+ * @brief Czy ściemniacz steruje lampą?
+ */
+bool Dimmer_IsActive(void);
+
+/**
+ * @brief Bieżąca pozycja ściemniacza (0..DIMMER_POS_MAX).
+ */
+uint8_t Dimmer_GetPosition(void);
+
+/**
+ * @brief Pozycja (jasność postrzegana, %) -> poziom PWM 0..ENV_LEVEL_MAX.
+ */
+uint16_t Dimmer_PosToLevel(uint8_t pos);
+
+/**
+ * @brief Obsługa zbocza enkodera – wywoływana z HAL_TIM_IC_CaptureCallback dla TIM1.
+ * @param htim Timer, który zgłosił przerwanie
+ */
+void Dimmer_EncoderEdge(TIM_HandleTypeDef *htim);
+
+/**
+ * @brief Odczyt licznika enkodera co 1 ms – wywoływane z SysTick_Handler.
+ *        Capture działa tylko na zboczach narastających, więc ostatnie zliczenia
+ *        ząbka (zbocza opadające) przychodzą tędy.
+ */
+void Dimmer_Tick(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DIMMER_H */
@@ -0,0 +1,189 @@
+// Created by: Marcin Dziedzic
+// envelope.h
+
+#ifndef ENVELOPE_H
+#define ENVELOPE_H
+
+#include "stm32f1xx_hal.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Poziom jasności w obwiedni: 0 = zgaszona, ENV_LEVEL_MAX = pełna jasność.
+ */
+#define ENV_LEVEL_MAX        0xFFFFU
+
+/**
+ * @brief Pomocnicze makro: jasność w procentach (0..100) -> poziom obwiedni.
+ */
+#define ENV_LEVEL_PCT(p)     ((uint16_t)(((uint32_t)(p) * ENV_LEVEL_MAX) / 100U))
+
+/**
+ * @brief Czas w minutach -> ms (do tabel klatek kluczowych).
+ */
+#define ENV_MIN(m)           ((uint32_t)(m) * 60000UL)
+
+/**
+ * @brief Liczba niezależnych odtwarzaczy (po jednym na kanał TIM3).
+ */
+#define ENV_MAX_PLAYERS      4U
+
+/**
+ * @brief Okres przerwania update TIM3 w µs (64 MHz / 65536 ≈ 976.6 Hz).
+ */
+#define ENV_TICK_US          1024U
+
+/**
+ * @brief Brak pętli w obwiedni (pole loopFrom).
+ */
+#define ENV_NO_LOOP          0xFFU
+
+/**
+ * @brief Kształt przejścia z poprzedniej klatki do bieżącej.
+ */
+typedef enum
+{
+    ENV_CURVE_LINEAR,    /**< Liniowo */
+    ENV_CURVE_EASE_IN,   /**< Powolny start, szybki koniec (t^2) */
+    ENV_CURVE_EASE_OUT,  /**< Szybki start, powolny koniec (1-(1-t)^2) */
+    ENV_CURVE_SMOOTH,    /**< Smoothstep (3t^2 - 2t^3) */
+    ENV_CURVE_STEP       /**< Skok do poziomu dopiero w chwili klatki */
+} EnvCurve_e;
+
+/**
+ * @brief Klatka kluczowa obwiedni.
+ *        timeMs liczony od początku obwiedni, klatki muszą być posortowane rosnąco,
+ *        pierwsza klatka ma timeMs = 0.
+ */
+typedef struct
+{
+    uint32_t timeMs;     /**< Chwila klatki (ms od startu) */
+    uint16_t level;      /**< Docelowy poziom (0..ENV_LEVEL_MAX) */
+    uint8_t  curve;      /**< EnvCurve_e – kształt dojścia do tej klatki */
+} EnvKeyframe_t;
+
+/**
+ * @brief Obwiednia: stała tabela klatek (we flashu) + opcjonalna pętla.
+ *        Po dojściu do ostatniej klatki odtwarzanie wraca do klatki loopFrom
+ *        (ENV_NO_LOOP = koniec, poziom ostatniej klatki zostaje na wyjściu).
+ */
+typedef struct
+{
+    const EnvKeyframe_t *frames;  /**< Tabela klatek */
+    uint8_t count;                /**< Liczba klatek (>= 2) */
+    uint8_t loopFrom;             /**< Indeks klatki początku pętli lub ENV_NO_LOOP */
+} Envelope_t;
+
+/**
+ * @brief Stan odtwarzacza obwiedni dla jednego kanału PWM.
+ *        Modyfikowany wyłącznie w przerwaniu TIM3 (poza startem/stopem).
+ */
+typedef struct
+{
+    TIM_HandleTypeDef *htim;      /**< Uchwyt timera PWM */
+    uint32_t channel;             /**< Kanał PWM */
+    const Envelope_t *env;        /**< Odtwarzana obwiednia */
+
+    volatile bool isActive;       /**< Czy odtwarzanie trwa? */
+    uint8_t  segment;             /**< Indeks klatki docelowej bieżącego odcinka */
+    uint32_t elapsedMs;           /**< Czas od startu obwiedni (ms) */
+    uint16_t fracUs;              /**< Reszta czasu poniżej 1 ms (µs) */
+    uint32_t segRecip;            /**< 2^32 / długość odcinka (ms) – stała Q32 */
+    uint16_t level;               /**< Ostatnio wystawiony poziom */
+    uint16_t originLevel;         /**< Poziom wyjścia w chwili startu (zastępuje klatkę 0) */
+    bool     firstPass;           /**< Pierwsze przejście (przed powrotem pętli) */
+} EnvPlayer_t;
+
+/**
+ * @brief Gotowe obwiednie.
+ *        ENV_DAWN   – 30 min świtu, 5 min podtrzymania, potem błyski aż do wyłączenia.
+ *        ENV_BREATH – łagodne "oddychanie" (pętla).
+ *        ENV_NIGHT  – 20-minutowe wygaszanie na noc.
+ */
+extern const Envelope_t ENV_DAWN;
+extern const Envelope_t ENV_BREATH;
+extern const Envelope_t ENV_NIGHT;
+
+/**
+ * @brief Czas (ms) od startu ENV_DAWN do osiągnięcia pełnej jasności.
+ */
+#define ENV_DAWN_RAMP_MS     ENV_MIN(30)
+
+/**
+ * @brief Inicjalizacja silnika obwiedni – włącza przerwanie update timera PWM.
+ * @param htim Uchwyt timera PWM (TIM3).
+ */
+void Envelope_Init(TIM_HandleTypeDef *htim);
+
+/**
+ * @brief Start odtwarzania obwiedni na wybranym kanale (przerywa poprzednią).
+ *        Pierwszy odcinek startuje od bieżącej jasności wyjścia, a nie od poziomu
+ *        klatki 0, więc wejście obwiedni nie powoduje skoku.
+ * @param htim    Uchwyt timera PWM
+ * @param channel Kanał PWM (TIM_CHANNEL_1..4)
+ * @param env     Obwiednia (musi żyć przez cały czas odtwarzania)
+ */
+void Envelope_Play(TIM_HandleTypeDef *htim, uint32_t channel, const Envelope_t *env);
+
+/**
+ * @brief Przesuwa trwającą obwiednię do zadanej chwili (wznowienie po resecie).
+ *        Wołać zaraz po Envelope_Play; pierwszy odcinek i tak startuje od bieżącej jasności.
+ * @param channel   Kanał PWM
+ * @param elapsedMs Czas od startu obwiedni (ms)
+ */
+void Envelope_Seek(uint32_t channel, uint32_t elapsedMs);
+
+/**
+ * @brief Obwiednia odtwarzana na kanale albo NULL.
+ * @param channel Kanał PWM
+ */
+const Envelope_t *Envelope_Current(uint32_t channel);
+
+/**
+ * @brief Czas od startu obwiedni (ms; w pętli liczony od jej zawinięcia).
+ * @param channel Kanał PWM
+ */
+uint32_t Envelope_GetElapsedMs(uint32_t channel);
+
+/**
+ * @brief Zatrzymuje odtwarzanie na kanale; wyjście zostaje na bieżącym poziomie.
+ * @param channel Kanał PWM
+ */
+void Envelope_Stop(uint32_t channel);
+
+/**
+ * @brief Czy na kanale trwa odtwarzanie obwiedni?
+ * @param channel Kanał PWM
+ */
+bool Envelope_IsActive(uint32_t channel);
+
+/**
+ * @brief Przeliczenie poziomu jasności na wartość CCR (wyjście odwrócone:
+ *        CCR = ARR -> zgaszona, CCR = 0 -> pełna jasność).
+ * @param htim  Uchwyt timera PWM
+ * @param level Poziom 0..ENV_LEVEL_MAX
+ */
+uint32_t Envelope_LevelToCompare(TIM_HandleTypeDef *htim, uint16_t level);
+
+/**
+ * @brief Przeliczenie CCR na poziom jasności (odwrotność Envelope_LevelToCompare).
+ * @param htim    Uchwyt timera PWM
+ * @param compare Wartość CCR
+ */
+uint16_t Envelope_CompareToLevel(TIM_HandleTypeDef *htim, uint32_t compare);
+
+/**
+ * @brief Krok silnika – wywoływany z przerwania update TIM3 (co ENV_TICK_US).
+ * @param htim Uchwyt timera, który zgłosił przerwanie
+ */
+void Envelope_TimerTick(TIM_HandleTypeDef *htim);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ENVELOPE_H
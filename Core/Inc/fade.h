@@ -5,12 +5,24 @@
 #define FADE_H
 
 #include "stm32f1xx_hal.h"
+#include "envelope.h"
 #include <stdbool.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * @brief Pełna jasność lampy w skali poziomów fade (ta sama skala co obwiednie).
+ */
+#define LEDFADE_LEVEL_MAX   ENV_LEVEL_MAX
+
+/**
+ * @brief Najdłuższy czas rampy (ms, ~35,8 min). Postęp liczony jest w µs na 32 bitach,
+ *        a okres pulsowania to 2 * czas rampy – dłuższe czasy są do tej wartości obcinane.
+ */
+#define LEDFADE_TIME_MAX_MS (UINT32_MAX / 2000U)
+
 /**
  * @brief Kierunek fade:
  *        - FADE_IN:  z 100% do 0% (np. CCR: arr -> 0)
@@ -24,18 +36,22 @@ typedef enum
 
 /**
  * @brief Tryb pracy fade:
- *        - FADE_MODE_SINGLE: jeden cykl (FADE_IN lub FADE_OUT) i koniec.
+ *        - FADE_MODE_SINGLE: jedna rampa (fromLevel -> toLevel) i koniec.
  *        - FADE_MODE_PULSE: cykliczne rozjaśnianie i przygaszanie
  *                           (FADE_IN -> FADE_OUT -> FADE_IN -> OUT...).
+ *        - FADE_MODE_ENVELOPE: wyjściem steruje obwiednia (envelope.c) z przerwania TIM3.
  */
 typedef enum
 {
     FADE_MODE_SINGLE,
-    FADE_MODE_PULSE
+    FADE_MODE_PULSE,
+    FADE_MODE_ENVELOPE
 } FadeMode_e;
 
 /**
  * @brief Struktura przechowująca stan procesu fade/pulse (bez HAL_Delay).
+ *        Jest jedynym "właścicielem" wyjścia lampy – każda zmiana jasności
+ *        (rampa, pulsowanie, obwiednia) przechodzi przez funkcje LedFade_*.
  */
 typedef struct
 {
@@ -45,12 +61,15 @@ typedef struct
     bool isActive;            /**< Czy proces trwa? */
     FadeMode_e mode;          /**< Pojedynczy cykl czy pulsowanie w kółko */
     FadeDirection_e direction;/**< Aktualny kierunek (FADE_IN / FADE_OUT) */
-    uint16_t steps;           /**< Liczba kroków w jednym cyklu */
-    uint16_t currentStep;     /**< Aktualny krok */
+    uint16_t steps;           /**< Liczba kroków w jednym cyklu (0 = pełna rozdzielczość) */
+    uint16_t currentStep;     /**< Ostatnio wystawiony krok */
     uint16_t arr;             /**< AutoReload timera (maks licznika) */
 
-    uint32_t stepInterval;    /**< Co ile ms wykonujemy 1 krok */
-    uint32_t lastTime;        /**< Ostatni moment (ms, z HAL_GetTick) wykonania kroku */
+    uint16_t fromLevel;       /**< Poziom początkowy rampy (FADE_MODE_SINGLE) */
+    uint16_t toLevel;         /**< Poziom docelowy rampy (FADE_MODE_SINGLE) */
+
+    uint32_t startUs;         /**< Początek bieżącego cyklu (µs, LedFade_NowUs) */
+    uint32_t durationUs;      /**< Czas jednego cyklu (µs) */
 
     /**
      *  Dla trybu PULSE:
@@ -60,14 +79,26 @@ typedef struct
      */
 } LedFadeHandle_t;
 
+/**
+ * @brief Przypisanie kanału PWM do obiektu fade, start PWM i zgaszenie lampy.
+ * @param handle  Obiekt stanu
+ * @param htim    Uchwyt timera
+ * @param channel Kanał PWM
+ */
+void LedFade_Init(LedFadeHandle_t *handle,
+                  TIM_HandleTypeDef *htim,
+                  uint32_t channel);
+
 /**
  * @brief Rozpoczęcie pojedynczego rozjaśniania lub przyciemniania (FADE_MODE_SINGLE).
+ *        Rampa startuje od bieżącej jasności, a czas jest skracany proporcjonalnie
+ *        do pozostałej drogi (prędkość zmiany jasności jest stała).
  * @param handle      Obiekt stanu
  * @param htim        Uchwyt timera
  * @param channel     Kanał PWM
  * @param direction   FADE_IN (rozjaśnianie) lub FADE_OUT (przyciemnianie)
  * @param steps       Ilość kroków w całym cyklu
- * @param totalTimeMs Czas (ms) całego cyklu
+ * @param totalTimeMs Czas (ms) całego cyklu, najwyżej LEDFADE_TIME_MAX_MS
  */
 void LedFade_Start(LedFadeHandle_t *handle,
                    TIM_HandleTypeDef *htim,
@@ -78,12 +109,14 @@ void LedFade_Start(LedFadeHandle_t *handle,
 
 /**
  * @brief Uruchamia tryb PULSE (rozjaśnianie -> przyciemnianie -> rozjaśnianie -> ...).
+ *        Faza startowa dobierana jest do bieżącej jasności (bez skoku).
  * @param handle      Obiekt stanu
  * @param htim        Uchwyt timera
  * @param channel     Kanał PWM
  * @param steps       Ilość kroków na rozjaśnianie i tyle samo na przyciemnianie
  * @param totalTimeMs Czas (ms) FADE_IN (oraz tyle samo na FADE_OUT),
- *                    sumarycznie cykl "góra + dół" = 2 * totalTimeMs
+ *                    sumarycznie cykl "góra + dół" = 2 * totalTimeMs;
+ *                    najwyżej LEDFADE_TIME_MAX_MS
  */
 void LedFade_PulseStart(LedFadeHandle_t *handle,
                         TIM_HandleTypeDef *htim,
@@ -92,14 +125,54 @@ void LedFade_PulseStart(LedFadeHandle_t *handle,
                         uint32_t totalTimeMs);
 
 /**
- * @brief Funkcja wywoływana cyklicznie (np. w pętli głównej),
- *        obsługuje krok fade/pulse jeśli upłynął odpowiedni czas stepInterval.
+ * @brief Płynne przejście od bieżącej jasności do zadanego poziomu.
+ *        Przerywa trwający fade, pulsowanie lub obwiednię.
+ * @param handle     Obiekt stanu (po LedFade_Init)
+ * @param level      Poziom docelowy 0..LEDFADE_LEVEL_MAX
+ * @param durationMs Czas przejścia (0 = natychmiast, najwyżej LEDFADE_TIME_MAX_MS)
+ */
+void LedFade_RetargetTo(LedFadeHandle_t *handle, uint16_t level, uint32_t durationMs);
+
+/**
+ * @brief Zatrzymuje fade/pulsowanie/obwiednię; jasność zostaje na bieżącym poziomie.
+ * @param handle Obiekt stanu (po LedFade_Init)
+ */
+void LedFade_Stop(LedFadeHandle_t *handle);
+
+/**
+ * @brief Odtwarzanie obwiedni na kanale lampy (start od bieżącej jasności).
+ * @param handle Obiekt stanu (po LedFade_Init)
+ * @param env    Obwiednia
+ */
+void LedFade_PlayEnvelope(LedFadeHandle_t *handle, const Envelope_t *env);
+
+/**
+ * @brief Bieżąca jasność odczytana z wyjścia PWM (0..LEDFADE_LEVEL_MAX).
+ * @param handle Obiekt stanu (po LedFade_Init)
+ */
+uint16_t LedFade_GetLevel(const LedFadeHandle_t *handle);
+
+/**
+ * @brief Funkcja wywoływana cyklicznie (np. w pętli głównej).
+ *        Krok liczony jest z czasu, który upłynął od startu cyklu, więc opóźnienia
+ *        pętli nie wydłużają fade – zaległe kroki są pomijane, a nie doliczane.
  * @param handle  Obiekt stanu fade
- * @return true, jeśli zakończono pojedynczy cykl (FADE_MODE_SINGLE).
- *         W trybie PULSE zwraca false (chyba że chcemy wykryć inny koniec).
+ * @return true, jeśli właśnie zakończono rampę (FADE_MODE_SINGLE)
+ *         lub obwiednię bez pętli (FADE_MODE_ENVELOPE). W trybie PULSE zwraca false.
  */
 bool LedFade_Process(LedFadeHandle_t *handle);
 
+/**
+ * @brief Obiekt fade lampy (kanał TIM3_CH4) – zdefiniowany w main.c.
+ */
+extern LedFadeHandle_t g_fadeHandle;
+
+/**
+ * @brief Bieżący czas w µs (HAL_GetTick + licznik SysTick), zawija się co ~71 min.
+ *        Nadaje się wyłącznie do liczenia różnic czasu.
+ */
+uint32_t LedFade_NowUs(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,79 @@
+// Created by: Marcin Dziedzic
+// lamp_reg.h
+
+#ifndef LAMP_REG_H
+#define LAMP_REG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Zakres i krok nastawy natężenia oświetlenia (lx).
+ */
+#define LAMPREG_TARGET_MIN      10U
+#define LAMPREG_TARGET_MAX      1000U
+#define LAMPREG_TARGET_STEP     10U
+#define LAMPREG_TARGET_DEFAULT  300U
+
+/**
+ * @brief Nastawy regulatora PI (Q8, jednostka: poziom jasności na 1 lx uchybu).
+ *        KP – część proporcjonalna, KI – przyrost całki na próbkę czujnika.
+ */
+#define LAMPREG_KP_Q8           (32 * 256)
+#define LAMPREG_KI_Q8           (8 * 256)
+
+/**
+ * @brief Maksymalna zmiana jasności na jedną próbkę czujnika (ogranicznik prędkości).
+ */
+#define LAMPREG_MAX_STEP        2048
+
+/**
+ * @brief Strefa nieczułości (lx) – w jej obrębie całka nie jest zmieniana.
+ */
+#define LAMPREG_DEADBAND_LX     2
+
+/**
+ * @brief Włącza regulację: lampa utrzymuje zadane natężenie oświetlenia w pokoju.
+ *        Całka startuje od bieżącej jasności lampy (bez skoku przy włączeniu).
+ * @param targetLux Nastawa (LAMPREG_TARGET_MIN..LAMPREG_TARGET_MAX)
+ */
+void LampReg_Enable(uint16_t targetLux);
+
+/**
+ * @brief Wyłącza regulację; lampa zostaje na bieżącej jasności.
+ */
+void LampReg_Disable(void);
+
+/**
+ * @brief Czy regulacja jest włączona?
+ */
+bool LampReg_IsEnabled(void);
+
+/**
+ * @brief Zmiana nastawy (także przy włączonej regulacji).
+ * @param targetLux Nastawa w lx
+ */
+void LampReg_SetTarget(uint16_t targetLux);
+
+/**
+ * @brief Aktualna nastawa w lx.
+ */
+uint16_t LampReg_GetTarget(void);
+
+/**
+ * @brief Krok regulatora – wywoływany po każdej nowej próbce czujnika
+ *        (LightSen_Sample zwróciło true). Wyjście idzie przez silnik fade
+ *        rampą o długości okresu próbkowania.
+ * @param filteredLux Przefiltrowany odczyt czujnika (lx)
+ */
+void LampReg_Update(uint16_t filteredLux);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LAMP_REG_H */
@@ -48,9 +48,15 @@ extern const uint8_t ROW_16[];
 #define SET_DDRAM_ADDR            0x80  /**< Ustawienie adresu pamięci DDRAM */
 
 /**
- * @brief Makro do opóźnień bazujące na HAL (milisekundy).
- */
-#define DELAY(X) HAL_Delay(X)
+ * @brief Czasy wg noty HD44780 (µs): impuls EN >= 450 ns, polecenie 37 µs,
+ *        CLEAR/HOME 1.52 ms, sekwencja resetu 4.1 ms; po włączeniu zasilania >= 40 ms.
+ *        Odliczane licznikiem SysTick zamiast HAL_Delay (które czeka 1-2 ms na bajt).
+ */
+#define LCD_EN_PULSE_US   1U
+#define LCD_EXEC_US       50U
+#define LCD_CLEAR_US      2000U
+#define LCD_RESET_US      4500U
+#define LCD_POWER_UP_MS   40U
 
 /**
  * @brief Tryb pracy bitów i rejestrów.
@@ -5,7 +5,7 @@
 #define LIGHT_SEN_H_
 
 #include <stdint.h>
-#include "lcd.h"
+#include <stdbool.h>
 #include "stm32f1xx_hal.h"
 
 /**
@@ -14,7 +14,24 @@
 #define BH1750_ADDRESS 0x23
 
 /**
- * @brief Inicjalizacja czujnika światła (BH1750).
+ * @brief Okres próbkowania w trybie ciągłym H-res (pomiar trwa max. 180 ms).
+ */
+#define LIGHTSEN_SAMPLE_MS 180U
+
+/**
+ * @brief Limit czasu transakcji I2C (ms) – brak czujnika lub zablokowana magistrala
+ *        nie zatrzymuje startu ani pętli głównej.
+ */
+#define LIGHTSEN_I2C_TIMEOUT_MS 10U
+
+/**
+ * @brief Stała filtru wykładniczego: nowa próbka wchodzi z wagą 1/2^SHIFT.
+ */
+#define LIGHTSEN_FILTER_SHIFT 2U
+
+/**
+ * @brief Inicjalizacja czujnika światła (BH1750) – start pomiarów ciągłych.
+ *        Nie czeka na pierwszy wynik; LightSen_Sample odczyta go po LIGHTSEN_SAMPLE_MS.
  * @param hi2c Uchwyt (handler) do interfejsu I2C.
  */
 void LightSen_Init(I2C_HandleTypeDef *hi2c);
@@ -27,10 +44,27 @@ void LightSen_Init(I2C_HandleTypeDef *hi2c);
 uint16_t LightSen_ReadLux(I2C_HandleTypeDef *hi2c);
 
 /**
- * @brief Wyświetlenie na LCD bieżącej wartości z czujnika światła.
- * @param lcd Wskaźnik do struktury obsługującej LCD.
- * @param lux Aktualna wartość luksów do wyświetlenia.
+ * @brief Okresowe próbkowanie czujnika (wołane w każdej iteracji pętli głównej).
+ *        Odczyt wykonywany jest co LIGHTSEN_SAMPLE_MS, zgodnie z rytmem pomiarów BH1750.
+ * @param hi2c Uchwyt do interfejsu I2C.
+ * @param now  Aktualny czas (HAL_GetTick()).
+ * @return true, jeśli pojawiła się nowa przefiltrowana próbka.
+ */
+bool LightSen_Sample(I2C_HandleTypeDef *hi2c, uint32_t now);
+
+/**
+ * @brief Czy jest już pierwsza próbka (czujnik gotowy)?
+ */
+bool LightSen_IsReady(void);
+
+/**
+ * @brief Ostatnia przefiltrowana wartość natężenia światła (lx).
+ */
+uint16_t LightSen_GetFilteredLux(void);
+
+/**
+ * @brief Liczba nieudanych transakcji I2C z czujnikiem od startu (telemetria).
  */
-void LightSen_DisplayLux(Lcd_HandleTypeDef *lcd, uint16_t lux);
+uint16_t LightSen_GetErrorCount(void);
 
 #endif /* LIGHT_SEN_H_ */
@@ -0,0 +1,88 @@
+// Created by: Marcin Dziedzic
+// log.h
+
+#ifndef LOG_H
+#define LOG_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Pojemność bufora w słowach (potęga dwójki). Rekord = nagłówek + czas + argumenty.
+ */
+#ifndef LOG_RING_WORDS
+#define LOG_RING_WORDS       128U
+#endif
+
+/**
+ * @brief Maksymalna liczba argumentów jednego wpisu.
+ */
+#define LOG_ARGS_MAX         4U
+
+/**
+ * @brief Port ITM dla logu przez SWO. Jeśli debugger (SWV) go włączył, log idzie
+ *        tam zamiast na USART2.
+ */
+#define LOG_ITM_PORT         24U
+
+/**
+ * @brief Nagłówek rekordu: [31] wpis kompletny, [30:28] liczba argumentów,
+ *        [15:0] identyfikator = przesunięcie tekstu formatu w sekcji .log_fmt.
+ */
+#define LOG_HDR_VALID        0x80000000UL
+#define LOG_HDR_NARGS_SHIFT  28U
+#define LOG_HDR_ID_MASK      0x0000FFFFUL
+
+#ifndef LOG_DISABLE
+
+/**
+ * @brief Wpis do logu: LOG("usb%u: over-current", port).
+ *        Tekst formatu trafia do sekcji .log_fmt, której nie ma we flashu – zostaje
+ *        tylko w pliku ELF dla dekodera (Tools/log_decode.py). Urządzenie zapisuje
+ *        identyfikator i surowe argumenty (liczby całkowite: %d %u %x %c; bez %s i %f).
+ *        Wolno wołać z przerwań – bez blokad i formatowania.
+ */
+#define LOG(fmt, ...)                                                                  \
+    do                                                                                 \
+    {                                                                                  \
+        static const char logFmt[] __attribute__((section(".log_fmt"), used)) = fmt;  \
+        _Static_assert(LOG_NARGS(__VA_ARGS__) <= LOG_ARGS_MAX,                         \
+                       "LOG: za dużo argumentów");                                     \
+        Log_Emit(((uint32_t)(uintptr_t)logFmt & LOG_HDR_ID_MASK) |                     \
+                 ((uint32_t)LOG_NARGS(__VA_ARGS__) << LOG_HDR_NARGS_SHIFT),            \
+                 (const uint32_t[]){ 0U, __VA_ARGS__ } + 1);                           \
+    } while (0)
+
+/**
+ * @brief Liczba argumentów makra (rozmiar tablicy z jednym słowem zapasu – działa też bez argumentów).
+ */
+#define LOG_NARGS(...)        ((sizeof((uint32_t[]){ 0U, __VA_ARGS__ }) / sizeof(uint32_t)) - 1U)
+
+/**
+ * @brief Rezerwacja miejsca (LDREX/STREX), zapis argumentów i nagłówka.
+ *        Pełny bufor = wpis odrzucony (licznik w Log_Process).
+ * @param header Nagłówek bez LOG_HDR_VALID
+ * @param args   Argumenty (liczba w nagłówku)
+ */
+void Log_Emit(uint32_t header, const uint32_t *args);
+
+/**
+ * @brief Opróżnianie bufora w tle (pętla główna): ramki na USART2 albo słowa na port ITM.
+ */
+void Log_Process(void);
+
+#else
+
+#define LOG(fmt, ...)         do { } while (0)
+#define Log_Process()         do { } while (0)
+
+#endif // LOG_DISABLE
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LOG_H
@@ -0,0 +1,75 @@
+// Created by: Marcin Dziedzic
+// memstat.h
+
+#ifndef MEMSTAT_H
+#define MEMSTAT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Wzorzec, którym kod startowy (startup_stm32f103rbtx.s) zamalowuje RAM
+ *        od _end (początek sterty) do szczytu stosu. Zmiana – w obu miejscach.
+ */
+#define MEMSTAT_PAINT           0xA5A5A5A5UL
+
+/**
+ * @brief Próg ostrzeżenia (bajty): zapas stosu lub sterty względem rezerwacji
+ *        ze skryptu linkera (_Min_Stack_Size / _Min_Heap_Size).
+ */
+#define MEMSTAT_WARN_MARGIN     128
+
+/**
+ * @brief Okres pomiaru w pętli głównej (ms); skan wolnego RAM trwa ~0.3 ms.
+ */
+#define MEMSTAT_PERIOD_MS       1000U
+
+/**
+ * @brief Budżet RAM (bajty). Zapasy są ze znakiem: ujemny = przekroczona rezerwacja
+ *        (stos zszedł poniżej _Min_Stack_Size albo sterta przekroczyła _Min_Heap_Size).
+ */
+typedef struct
+{
+    uint16_t dataSize;      /**< .data (zmienne inicjalizowane) */
+    uint16_t bssSize;       /**< .bss (zmienne zerowane) */
+    uint16_t stackReserved; /**< _Min_Stack_Size */
+    uint16_t heapReserved;  /**< _Min_Heap_Size */
+    uint16_t stackUsed;     /**< Najgłębsze zużycie stosu od startu */
+    uint16_t heapUsed;      /**< Szczyt sterty (_sbrk) od startu */
+    int16_t  stackMargin;   /**< stackReserved - stackUsed */
+    int16_t  heapMargin;    /**< heapReserved - heapUsed */
+    uint16_t freeGap;       /**< Nigdy nieużyty RAM między stertą a stosem */
+    bool     warning;       /**< Któryś zapas spadł poniżej MEMSTAT_WARN_MARGIN */
+} MemStat_t;
+
+/**
+ * @brief Pierwszy pomiar (statyczny podział RAM i stan po starcie).
+ */
+void MemStat_Init(void);
+
+/**
+ * @brief Pomiar co MEMSTAT_PERIOD_MS. Przy nowym minimum zapasu poniżej progu
+ *        wysyła ostrzeżenie przez USART2 (raz na każde pogorszenie).
+ * @param now Bieżący czas (HAL_GetTick)
+ */
+void MemStat_Process(uint32_t now);
+
+/**
+ * @brief Wyniki ostatniego pomiaru.
+ */
+const MemStat_t *MemStat_Get(void);
+
+/**
+ * @brief Raport budżetu RAM przez USART2.
+ */
+void MemStat_Report(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MEMSTAT_H
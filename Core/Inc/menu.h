@@ -11,20 +11,96 @@
 #include "stm32f1xx_hal.h"
 
 /**
- * @brief Enumeracja reprezentująca stany głównego menu i podmenu.
+ * @brief Enumeracja reprezentująca stany (ekrany) interfejsu.
+ *        Wszystkie listy menu obsługuje jeden stan MENU_STATE (silnik menu),
+ *        osobne stany mają tylko ekrany nietypowe. Ekrany są dziećmi stanu
+ *        złożonego MENU_UI_STATE, ALARM_TRIGGERED leży obok niego (wywłaszcza ekrany).
  */
 typedef enum {
-    MENU_STATE,            /**< Przeglądanie głównego menu */
-    OPTION_STATE,          /**< Wybrano jedną z opcji "ENTER"/"EXIT" */
-    SUBMENU_2,             /**< Sub-menu USB1 */
-    SUBMENU_2B,            /**< Sub-menu USB2 */
-    SUBMENU_L_BULB,        /**< Sub-menu lampki */
-    SUBMENU_ALARM,         /**< Sub-menu: "SET", "L_SENSOR", "BACK" */
+    MENU_STATE,            /**< Przeglądanie listy menu (główne lub podmenu) */
+    OPTION_STATE,          /**< Widok informacyjny (TIME, SENSOR) odświeżany co sekundę RTC */
+    MENU_TOGGLE_STATE,     /**< Ekran ON/OFF/BACK pozycji typu MENU_ITEM_TOGGLE */
+    MENU_VALUE_STATE,      /**< Edycja wartości pozycji typu MENU_ITEM_VALUE */
     SUBMENU_ALARM_SET,     /**< Ustawianie alarmu (dzień, miesiąc, rok, godzina, min, sek) */
     ALARM_TRIGGERED,       /**< Stan alarmu w trakcie wywołania */
-    SUBMENU_ALARM_LSENSOR  /**< Obsługa czujnika światła (ON/OFF/BACK) */
+    SUBMENU_DIMMER,        /**< Ściemniacz – jasność lampy ustawiana pokrętłem */
+    MENU_UI_STATE,         /**< Stan złożony: wszystkie ekrany (z historią) */
+    MENU_STATE_COUNT       /**< Liczba stanów (rozmiar tablicy stanów) */
 } MenuState;
 
+/**
+ * @brief Brak stanu – rodzic stanów najwyższego poziomu.
+ */
+#define MENU_STATE_NONE  MENU_STATE_COUNT
+
+/**
+ * @brief Rodzaj pozycji menu.
+ */
+typedef enum {
+    MENU_ITEM_SUBMENU,     /**< Wejście do podmenu */
+    MENU_ITEM_TOGGLE,      /**< Przełącznik ON/OFF (get/set) */
+    MENU_ITEM_VALUE,       /**< Edytor wartości liczbowej powiązanej ze zmienną */
+    MENU_ITEM_ACTION,      /**< Dowolna akcja (np. wejście na ekran nietypowy) */
+    MENU_ITEM_BACK         /**< Powrót do menu nadrzędnego */
+} MenuItemType_e;
+
+typedef struct MenuItem MenuItem_t;
+
+/**
+ * @brief Menu: stała tabela pozycji (we flashu).
+ */
+typedef struct {
+    const MenuItem_t *items;   /**< Pozycje menu */
+    uint8_t count;             /**< Liczba pozycji */
+} Menu_t;
+
+/**
+ * @brief Limit pozycji jednego menu: kursor zapisywany na 3 bitach w kontekście
+ *        wznowienia (Menu_SaveContext, 16-bitowy rejestr BKP).
+ */
+#define MENU_ITEMS_MAX  8U
+
+/**
+ * @brief Parametry przełącznika ON/OFF.
+ */
+typedef struct {
+    bool (*get)(void);         /**< Bieżący stan (true = ON) */
+    void (*set)(bool on);      /**< Zmiana stanu (wraz z efektami ubocznymi) */
+} MenuToggle_t;
+
+/**
+ * @brief Parametry edytora wartości. Zmienna jest zapisywana dopiero po
+ *        zatwierdzeniu (wciśnięcie), następnie wołane jest commit().
+ */
+typedef struct {
+    uint16_t *var;             /**< Powiązana zmienna */
+    uint16_t min;              /**< Wartość minimalna */
+    uint16_t max;              /**< Wartość maksymalna */
+    uint16_t step;             /**< Krok na jeden ząbek (przed przyspieszeniem) */
+    const char *unit;          /**< Jednostka wyświetlana za wartością */
+    void (*commit)(uint16_t value);  /**< Po zatwierdzeniu (może być NULL) */
+    uint16_t (*readback)(void);      /**< Odczyt bieżący do porównania (może być NULL) */
+} MenuValue_t;
+
+/**
+ * @brief Pozycja menu: etykieta, rodzaj i parametry zależne od rodzaju.
+ */
+struct MenuItem {
+    const char *label;         /**< Etykieta (max 15 znaków) */
+    uint8_t type;              /**< MenuItemType_e */
+    union {
+        const Menu_t *submenu;                     /**< MENU_ITEM_SUBMENU */
+        MenuToggle_t toggle;                       /**< MENU_ITEM_TOGGLE */
+        MenuValue_t value;                         /**< MENU_ITEM_VALUE */
+        void (*action)(Lcd_HandleTypeDef *lcd);    /**< MENU_ITEM_ACTION */
+    } u;
+};
+
+/**
+ * @brief Menu główne (korzeń drzewa menu).
+ */
+extern const Menu_t mainMenu;
+
 /**
  * @brief Struktura przechowująca dane alarmu.
  */
@@ -44,22 +120,12 @@ typedef struct {
 extern AlarmData alarmData;
 
 /**
- * @brief Aktualny stan głównej maszyny stanów menu.
+ * @brief Aktualny stan (liść) głównej maszyny stanów menu.
  */
 extern MenuState gState;
 
 /**
- * @brief Indeks wybranej opcji w menu głównym (0..menuCount-1).
- */
-extern int8_t menuIndex;
-
-/**
- * @brief Liczba pozycji w menu głównym (rozmiar tablicy menuItems).
- */
-extern int menuCount;
-
-/**
- * @brief Indeks w bieżącym sub-menu.
+ * @brief Indeks w bieżącym ekranie ON/OFF/BACK.
  */
 extern int8_t currentSubMenuIndex;
 
@@ -78,19 +144,28 @@ extern int usb2_OnOff;
  */
 extern int l_BulbOnOff;
 
+/**
+ * @brief Czujnik światła przy alarmie: 1=ON, 2=OFF.
+ */
+extern int8_t lightSensorMode;
+
 /**
  * @brief Które pole w alarmie jest edytowane (0=day,1=month,2=year,3=hour,4=min,5=sec).
  */
 extern int8_t alarmSetIndex;
 
+/**
+ * @brief Nastawa regulacji lampy w lx (zmienna powiązana z pozycją LAMP_REG/TARGET).
+ */
+extern uint16_t lampRegEditLux;
+
 /* -------------------- Deklaracje funkcji -------------------- */
 
 /**
- * @brief Wyświetla menu alarmu: SET / L_SENSOR / BACK.
- * @param lcd       Wskaźnik do struktury LCD.
- * @param subIndex  Indeks aktualnie wybranej opcji (0..2).
+ * @brief Unieważnia zapamiętaną zawartość wierszy LCD – najbliższa ramka
+ *        wyśle oba wiersze w całości (np. po Lcd_clear lub obcym zapisie).
  */
-void DisplayAlarmMenu(Lcd_HandleTypeDef *lcd, int8_t subIndex);
+void Menu_InvalidateRows(void);
 
 /**
  * @brief Wyświetla ekran ustawiania alarmu (dzień, miesiąc, rok, godzina, min, sek).
@@ -108,20 +183,50 @@ void DisplayAlarmSet(Lcd_HandleTypeDef *lcd, int8_t alarmSetIndex, bool blinkOn)
 void DisplayAlarmTriggered(Lcd_HandleTypeDef *lcd, int8_t subIndex);
 
 /**
- * @brief Główne menu skrolowane, wyświetla 2 pozycje na ekranie i wyróżnia zaznaczoną.
+ * @brief Lista menu, 2 pozycje na ekranie, zaznaczona oznaczona strzałką.
+ *        Wypisywane są tylko wiersze, które się zmieniły.
  * @param lcd          Wskaźnik do struktury LCD.
- * @param index        Aktualny indeks menu (0..menuCount-1).
- * @param forceRefresh Jeśli true, wykonaj pełny odśwież ekranu (np. powrót z innego menu).
+ * @param menu         Wyświetlane menu.
+ * @param index        Indeks zaznaczonej pozycji (0..menu->count-1).
+ * @param forceRefresh Jeśli true, wykonaj pełny odśwież ekranu (np. powrót z innego ekranu).
+ */
+void Menu_Display(Lcd_HandleTypeDef *lcd, const Menu_t *menu, uint8_t index, bool forceRefresh);
+
+/**
+ * @brief Widok TIME: bieżąca data i czas z RTC.
+ * @param lcd Wskaźnik do struktury LCD.
+ */
+void Menu_ViewTime(Lcd_HandleTypeDef *lcd);
+
+/**
+ * @brief Widok SENSOR: przefiltrowany odczyt czujnika światła.
+ * @param lcd Wskaźnik do struktury LCD.
+ */
+void Menu_ViewSensor(Lcd_HandleTypeDef *lcd);
+
+/**
+ * @brief Widok STATUS portu USB: stan (ON/OFF/FAULT z czasem do ponowienia)
+ *        i liczba przeciążeń od startu.
+ * @param lcd Wskaźnik do struktury LCD.
  */
-void Menu_Display(Lcd_HandleTypeDef *lcd, uint8_t index, bool forceRefresh);
+void Menu_ViewUsb1(Lcd_HandleTypeDef *lcd);
+void Menu_ViewUsb2(Lcd_HandleTypeDef *lcd);
 
 /**
- * @brief Wyświetla zawartość wybranej opcji menu (np. TIME, SENSOR, itp.).
+ * @brief Ekran edycji wartości: etykieta i wartość (wiersz 0), odczyt bieżący (wiersz 1).
  * @param lcd   Wskaźnik do struktury LCD.
- * @param index Indeks pozycji w głównym menu.
- * @param hi2c  Uchwyt do I2C (np. do sensora BH1750).
+ * @param item  Edytowana pozycja (MENU_ITEM_VALUE).
+ * @param value Edytowana (niezatwierdzona) wartość.
  */
-void Menu_ShowOption(Lcd_HandleTypeDef *lcd, uint8_t index, I2C_HandleTypeDef *hi2c);
+void DisplayValueEdit(Lcd_HandleTypeDef *lcd, const MenuItem_t *item, uint16_t value);
+
+/**
+ * @brief Wyświetla ekran ściemniacza: jasność w % (wiersz 0) i pasek (wiersz 1).
+ * @param lcd          Wskaźnik do struktury LCD.
+ * @param percent      Pozycja ściemniacza 0..100.
+ * @param forceRefresh true przy wejściu na ekran (ładuje znaki paska do CGRAM).
+ */
+void DisplayDimmer(Lcd_HandleTypeDef *lcd, uint8_t percent, bool forceRefresh);
 
 /**
  * @brief Wyświetla sub-menu ON/OFF/BACK, z podświetlaniem wybranej opcji strzałką.
@@ -131,4 +236,22 @@ void Menu_ShowOption(Lcd_HandleTypeDef *lcd, uint8_t index, I2C_HandleTypeDef *h
  */
 void DisplaySubMenuON_OFF(Lcd_HandleTypeDef *lcd, int8_t subIndex, int device_OnOff);
 
+/**
+ * @brief Przełączniki wyjść – te same funkcje dla menu i konsoli UART.
+ *        Usb1_Set/Usb2_Set zmieniają żądany stan portu (usb_port.h), przeciążenie
+ *        nie zmienia usb_OnOff – port wraca sam po ponowieniu.
+ *        Bulb_Set wyłącza regulację wg czujnika i płynnie zapala/gasi lampę.
+ *        Każda zmiana jest zapisywana w pamięci ustawień (settings.h).
+ */
+void Usb1_Set(bool on);
+void Usb2_Set(bool on);
+void Bulb_Set(bool on);
+void LSensor_Set(bool on);
+
+/**
+ * @brief Przywraca przełączniki (USB, lampa, regulator, czujnik) zapisane we flashu.
+ *        Wołać po Settings_Init(), przed Menu_Start().
+ */
+void Menu_LoadSettings(void);
+
 #endif /* MENU_H */
@@ -15,18 +15,82 @@ extern "C" {
 #include <stdbool.h>
 
 /**
- * @brief Prototypy funkcji obsługujących poszczególne stany menu.
- */
-
-void HandleMenuState(int val, uint32_t now, Lcd_HandleTypeDef *lcd);
-void HandleOptionState(int val, uint32_t now, Lcd_HandleTypeDef *lcd);
-void HandleSubMenu2State(int val, uint32_t now, Lcd_HandleTypeDef *lcd);
-void HandleSubMenu2BState(int val, uint32_t now, Lcd_HandleTypeDef *lcd);
-void HandleSubMenuLBState(int val, uint32_t now, Lcd_HandleTypeDef *lcd);
-void HandleSubMenuAlarmState(int val, uint32_t now, Lcd_HandleTypeDef *lcd);
-void HandleSubMenuAlarmSetState(int val, uint32_t now, Lcd_HandleTypeDef *lcd);
-void HandleAlarmTriggered(int val, uint32_t now, Lcd_HandleTypeDef *lcd);
-void HandleSubMenuAlarmLSensorState(int val, uint32_t now, Lcd_HandleTypeDef *lcd);
+ * @brief Rodzaje zdarzeń automatu menu.
+ */
+typedef enum
+{
+    UI_EVT_ALARM,      /**< Nadszedł czas alarmu (zgłaszane przez Menu_Post) */
+    UI_EVT_SECOND,     /**< Nowa sekunda RTC (zgłaszane przez Menu_Post) */
+    UI_EVT_BUTTON,     /**< Zdarzenie przycisku enkodera (arg = ButtonEventType_e) */
+    UI_EVT_ROTATE,     /**< Obrót enkodera (arg = ząbki, <0 lewo, >0 prawo) */
+    UI_EVT_TICK        /**< Każdy obieg pętli – odświeżanie, mruganie */
+} UiEventType_e;
+
+/**
+ * @brief Zdarzenie przekazywane do handlera stanu (i dalej do rodziców).
+ */
+typedef struct
+{
+    uint8_t  type;     /**< UiEventType_e */
+    int16_t  arg;      /**< Parametr zależny od rodzaju */
+    uint32_t now;      /**< Czas zdarzenia (HAL_GetTick()) */
+} UiEvent_t;
+
+/**
+ * @brief Start silnika menu – menu główne na ekranie.
+ * @param lcd Wskaźnik do struktury LCD.
+ */
+void Menu_Start(Lcd_HandleTypeDef *lcd);
+
+/**
+ * @brief Bieżący ekran (liść automatu + kursory otwartych list) w 16 bitach.
+ */
+uint16_t Menu_SaveContext(void);
+
+/**
+ * @brief Odtworzenie ekranu zapisanego przez Menu_SaveContext (zamiast Menu_Start).
+ *        Ekrany edycji wracają do listy; alarm wraca na ekran ALARM_TRIGGERED.
+ * @param lcd Wskaźnik do struktury LCD.
+ * @param ctx Zapisany kontekst.
+ * @return false, jeśli kontekst nie pasuje do drzewa menu (nic nie zmieniono).
+ */
+bool Menu_RestoreContext(Lcd_HandleTypeDef *lcd, uint16_t ctx);
+
+/**
+ * @brief Obsługa wejść (wywoływana raz na obieg pętli głównej): zgłoszone zdarzenia,
+ *        kolejka przycisku, obrót i TICK trafiają kolejno do bieżącego stanu.
+ * @param val Przyrost enkodera w ząbkach (<0 lewo, >0 prawo, 0 brak ruchu)
+ * @param now Aktualny czas (HAL_GetTick())
+ * @param lcd Wskaźnik do struktury LCD.
+ */
+void Menu_Dispatch(int val, uint32_t now, Lcd_HandleTypeDef *lcd);
+
+/**
+ * @brief Powrót z ekranu nietypowego do ostatnio otwartej listy menu.
+ * @param lcd Wskaźnik do struktury LCD.
+ */
+void Menu_Back(Lcd_HandleTypeDef *lcd);
+
+/**
+ * @brief Otwarcie widoku informacyjnego (odświeżany co sekundę RTC, wyjście przyciskiem).
+ * @param lcd  Wskaźnik do struktury LCD.
+ * @param view Funkcja rysująca widok.
+ */
+void Menu_OpenView(Lcd_HandleTypeDef *lcd, void (*view)(Lcd_HandleTypeDef *lcd));
+
+/**
+ * @brief Akcje pozycji menu otwierające ekrany nietypowe.
+ * @param lcd Wskaźnik do struktury LCD.
+ */
+void Menu_OpenAlarmSet(Lcd_HandleTypeDef *lcd);
+void Menu_OpenDimmer(Lcd_HandleTypeDef *lcd);
+
+/**
+ * @brief Zgłoszenie zdarzenia spoza automatu (kontekst pętli głównej, nie przerwania).
+ *        Obsłużone na początku najbliższego Menu_Dispatch.
+ * @param type Rodzaj zdarzenia (np. UI_EVT_ALARM).
+ */
+void Menu_Post(UiEventType_e type);
 
 #ifdef __cplusplus
 }
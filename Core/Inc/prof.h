@@ -0,0 +1,116 @@
+// Created by: Marcin Dziedzic
+// prof.h
+
+#ifndef PROF_H
+#define PROF_H
+
+#include "stm32f1xx_hal.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Profiler włączony w konfiguracji Debug (CubeIDE definiuje DEBUG).
+ *        PROF_DISABLE wyłącza go mimo to; w Release makra znikają całkowicie.
+ */
+#if defined(DEBUG) && !defined(PROF_DISABLE)
+#define PROF_ENABLED         1
+#else
+#define PROF_ENABLED         0
+#endif
+
+/**
+ * @brief Liczba przedziałów histogramu: przedział k = czasy 2^k..2^(k+1)-1 cykli,
+ *        ostatni zbiera wszystko powyżej (2^23 cykli ≈ 131 ms przy 64 MHz).
+ */
+#define PROF_HIST_BINS       24U
+
+/**
+ * @brief Miejsca na handlery stanów menu (PROF_HANDLE + numer stanu).
+ */
+#define PROF_HANDLE_SLOTS    8U
+
+/**
+ * @brief Mierzone obszary.
+ */
+typedef enum
+{
+    PROF_LOOP,           /**< Cały obieg pętli głównej (bez HAL_Delay) */
+    PROF_RTC_READ,       /**< RTC_ReadTime */
+    PROF_LUX_READ,       /**< LightSen_ReadLux */
+    PROF_LCD_STRING,     /**< Lcd_string */
+    PROF_RENDER,         /**< Render_Frame */
+    PROF_HANDLE,         /**< Handlery stanów menu – PROF_HANDLE_SLOTS kolejnych pozycji */
+    PROF_ID_COUNT = PROF_HANDLE + PROF_HANDLE_SLOTS
+} ProfId_e;
+
+/**
+ * @brief Statystyka jednego obszaru (czasy w cyklach DWT CYCCNT).
+ */
+typedef struct
+{
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;                      /**< Suma – średnia = sum / count */
+    uint32_t hist[PROF_HIST_BINS];     /**< Histogram log2 */
+} ProfStat_t;
+
+#if PROF_ENABLED
+
+/**
+ * @brief Pomiar obszaru: PROF_BEGIN(x) ... PROF_END(x, id) w tym samym bloku.
+ *        Koszt: odczyt CYCCNT na wejściu i wywołanie Prof_Record na wyjściu.
+ */
+#define PROF_BEGIN(tag)       uint32_t prof_t0_##tag = DWT->CYCCNT
+#define PROF_END(tag, id)     Prof_Record((id), DWT->CYCCNT - prof_t0_##tag)
+
+/**
+ * @brief Włączenie licznika cykli i kalibracja narzutu pary BEGIN/END.
+ */
+void Prof_Init(void);
+
+/**
+ * @brief Dopisanie jednego pomiaru (cykle) do statystyki obszaru.
+ */
+void Prof_Record(uint32_t id, uint32_t cycles);
+
+/**
+ * @brief Statystyka obszaru (tylko do odczytu).
+ */
+const ProfStat_t *Prof_Get(uint32_t id);
+
+/**
+ * @brief Wyzerowanie wszystkich statystyk.
+ */
+void Prof_Reset(void);
+
+/**
+ * @brief Zgłoszenie zrzutu (np. z przerwania przycisku B1).
+ */
+void Prof_RequestDump(void);
+
+/**
+ * @brief Zrzut tekstowy przez bufor nadawczy UART, jeśli został zgłoszony
+ *        (kontekst pętli głównej).
+ */
+void Prof_DumpIfRequested(void);
+
+#else
+
+#define PROF_BEGIN(tag)       do { } while (0)
+#define PROF_END(tag, id)     do { } while (0)
+#define Prof_Init()           do { } while (0)
+#define Prof_Reset()          do { } while (0)
+#define Prof_RequestDump()    do { } while (0)
+#define Prof_DumpIfRequested() do { } while (0)
+
+#endif // PROF_ENABLED
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PROF_H
@@ -6,6 +6,31 @@
 
 #include "stm32f1xx_hal.h"
 
+/**
+ * @brief  Domyślna liczba zliczeń licznika na jeden ząbek (klik) pokrętła.
+ *         TI12 zlicza wszystkie 4 zbocza okresu kwadratury; typowy EC11 ma
+ *         jeden pełny okres na ząbek.
+ */
+#define REENCODER_COUNTS_PER_DETENT  4
+
+/**
+ * @brief  Przyspieszenie (wspólne dla menu i ściemniacza): poniżej
+ *         REENCODER_ACCEL_MIN_DPS ząbków/s krok = 1, od REENCODER_ACCEL_MAX_DPS
+ *         krok maksymalny, pomiędzy liniowo. Po przerwie REENCODER_ACCEL_IDLE_MS
+ *         prędkość liczona jest od nowa.
+ */
+#define REENCODER_ACCEL_MIN_DPS      8U
+#define REENCODER_ACCEL_MAX_DPS      60U
+#define REENCODER_ACCEL_IDLE_MS      250U
+
+/**
+ * @brief  Stan estymatora prędkości obrotu (jeden na odbiorcę ruchu).
+ */
+typedef struct {
+    uint32_t last_ms;   // chwila poprzedniego ruchu
+    uint16_t speed;     // uśredniona prędkość (ząbki/s)
+} REncoder_AccelTypeDef;
+
 /**
  * @brief  Struktura przechowująca potrzebne informacje o enkoderze.
  */
@@ -14,6 +39,8 @@ typedef struct {
     GPIO_TypeDef      *btn_port;   // port przycisku
     uint16_t          btn_pin;     // pin przycisku
     int16_t           last_count;  // poprzednia wartość licznika
+    int16_t           residue;     // zliczenia poniżej pełnego ząbka (przenoszone dalej)
+    uint8_t           counts_per_detent; // zliczenia licznika na jeden ząbek
 } REncoder_HandleTypeDef;
 
 /**
@@ -29,14 +56,30 @@ void REncoder_Init(REncoder_HandleTypeDef *henc,
                    uint16_t btn_pin);
 
 /**
- * @brief  Odczyt aktualnego stanu enkodera i wykrycie zdarzeń.
+ * @brief  Zmiana liczby zliczeń na ząbek (np. enkoder z połową okresu na klik = 2).
+ * @param  henc              - wskaźnik do struktury REncoder_HandleTypeDef.
+ * @param  counts_per_detent - zliczenia licznika na jeden ząbek (>= 1).
+ */
+void REncoder_SetCountsPerDetent(REncoder_HandleTypeDef *henc, uint8_t counts_per_detent);
+
+/**
+ * @brief  Odczyt przyrostu położenia pokrętła od poprzedniego wywołania.
+ *         Reszta poniżej pełnego ząbka jest zachowywana, więc żaden ruch nie ginie
+ *         między odczytami, a drganie styku (+1/-1) znosi się samo.
  * @param  henc - wskaźnik do struktury REncoder_HandleTypeDef.
- * @retval Zwraca:
- *         - 1  -> Obrót w prawo
- *         - 0  -> Obrót w lewo
- *         - 2  -> Wciśnięcie przycisku
- *         - -1 -> Brak zdarzenia
+ * @retval Liczba ząbków ze znakiem: > 0 obrót w prawo, < 0 w lewo, 0 brak ruchu.
  */
 int REncoder_Update(REncoder_HandleTypeDef *henc);
 
+/**
+ * @brief  Skalowanie przyrostu wg prędkości obrotu (ząbki na sekundę).
+ *         Bezpieczne w przerwaniu, o ile dany stan ma jednego użytkownika.
+ * @param  acc      - stan estymatora prędkości.
+ * @param  detents  - przyrost w ząbkach (ze znakiem).
+ * @param  now      - bieżący czas w ms (HAL_GetTick()).
+ * @param  max_step - maksymalny mnożnik przy szybkim obrocie (>= 1).
+ * @retval Przyrost po przyspieszeniu (detents * krok).
+ */
+int REncoder_Accelerate(REncoder_AccelTypeDef *acc, int detents, uint32_t now, uint8_t max_step);
+
 #endif // R_ENCODER_H
@@ -0,0 +1,84 @@
+// Created by: Marcin Dziedzic
+// render.h
+
+#ifndef RENDER_H
+#define RENDER_H
+
+#include "lcd.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Wymiary bufora ramki (LCD 16x2).
+ */
+#define RENDER_ROWS          2U
+#define RENDER_COLS          16U
+
+/**
+ * @brief Maksymalna liczba ramek na sekundę (przebiegów wysyłających zmiany do LCD).
+ */
+#ifndef RENDER_FPS
+#define RENDER_FPS           30U
+#endif
+
+#define RENDER_FRAME_MS      (1000U / RENDER_FPS)
+
+/**
+ * @brief Statystyki przebiegów renderowania.
+ */
+typedef struct
+{
+    uint32_t frames;      /**< Ramki, w których coś wysłano do LCD */
+    uint32_t skipped;     /**< Pominięte sloty ramek (pętla spóźniona o pełny okres lub więcej) */
+    uint32_t coalesced;   /**< Zmiany bufora nadpisane przed wysłaniem (zaoszczędzone zapisy) */
+    uint32_t chars;       /**< Wysłane znaki */
+    uint32_t lastUs;      /**< Czas ostatniej ramki (µs) */
+    uint32_t maxUs;       /**< Najdłuższa ramka (µs) */
+} RenderStats_t;
+
+/**
+ * @brief Inicjalizacja bufora ramki (pusty ekran, cały do wysłania).
+ */
+void Render_Init(void);
+
+/**
+ * @brief Zapis wiersza do bufora ramki (uzupełnienie spacjami do 16 znaków).
+ *        Nie dotyka LCD – zmienione kolumny zostaną wysłane w najbliższej ramce.
+ * @param row  Wiersz (0..RENDER_ROWS-1)
+ * @param text Tekst (dłuższy niż 16 znaków jest obcinany)
+ */
+void Render_PutRow(uint8_t row, const char *text);
+
+/**
+ * @brief Wymuszenie wysłania całego ekranu w najbliższej ramce.
+ */
+void Render_Invalidate(void);
+
+/**
+ * @brief Przebieg renderowania – wywoływany w każdym obiegu pętli; co RENDER_FRAME_MS
+ *        wysyła do LCD tylko zmienione fragmenty wierszy.
+ * @param lcd Wskaźnik do struktury LCD.
+ * @param now Aktualny czas (HAL_GetTick())
+ * @return true, jeśli w tym wywołaniu coś zostało wysłane.
+ */
+bool Render_Frame(Lcd_HandleTypeDef *lcd, uint32_t now);
+
+/**
+ * @brief Statystyki renderowania (tylko do odczytu).
+ */
+const RenderStats_t *Render_GetStats(void);
+
+/**
+ * @brief Wyzerowanie statystyk.
+ */
+void Render_ResetStats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RENDER_H
@@ -0,0 +1,49 @@
+// Created by: Marcin Dziedzic
+// resume.h
+
+#ifndef RESUME_H
+#define RESUME_H
+
+#include "lcd.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Okres odświeżania migawki stanu w rejestrach BKP (ms).
+ */
+#define RESUME_PERIOD_MS        100U
+
+/**
+ * @brief Migawka starsza niż tyle sekund (wg RTC) oznacza zimny start.
+ */
+#define RESUME_MAX_AGE_S        60U
+
+/**
+ * @brief Wiek (minuty) bajtu RAM RTC, przy którym jeszcze z niego korzystamy.
+ */
+#define RESUME_RAM_MAX_AGE_MIN  2U
+
+/**
+ * @brief Start interfejsu: odtworzenie ekranu, lampy i alarmu z poprzedniej pracy
+ *        albo Menu_Start(). Pełna migawka z rejestrów BKP, a gdy domena backup
+ *        straciła zasilanie – tylko lampa i alarm z bajtu RAM PCF85063. Wołać po Clock_Init(), AlarmPreSet() i Menu_LoadSettings().
+ *        Bez zapisu do flasha.
+ * @param lcd Wskaźnik do struktury LCD.
+ */
+void Resume_Start(Lcd_HandleTypeDef *lcd);
+
+/**
+ * @brief Zapis migawki stanu (co RESUME_PERIOD_MS do BKP, bajt RAM RTC tylko przy zmianie).
+ * @param now Aktualny czas (HAL_GetTick())
+ */
+void Resume_Process(uint32_t now);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RESUME_H
@@ -0,0 +1,73 @@
+// Created by: Marcin Dziedzic
+// settings.h
+
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Klucze ustawień zapisywanych we flashu.
+ *        Nowe klucze dopisujemy na końcu – numer klucza jest zapisany w rekordach.
+ */
+typedef enum
+{
+    SET_KEY_ALARM_DATE = 0,  /**< (rok << 16) | (miesiąc << 8) | dzień */
+    SET_KEY_ALARM_TIME,      /**< (godzina << 16) | (minuta << 8) | sekunda */
+    SET_KEY_LSENSOR,         /**< lightSensorMode (1=ON, 2=OFF) */
+    SET_KEY_USB1,            /**< usb_OnOff (1=ON, 2=OFF) */
+    SET_KEY_USB2,            /**< usb2_OnOff (1=ON, 2=OFF) */
+    SET_KEY_LAMP,            /**< l_BulbOnOff (1=ON, 2=OFF) */
+    SET_KEY_LAMPREG,         /**< Regulator lampy: 1=włączony, 0=wyłączony */
+    SET_KEY_LAMPREG_TARGET,  /**< Nastawa regulatora (lx) */
+    SET_KEY_TELEMETRY,       /**< Telemetria: 1=wysyłana, 0=wyłączona */
+    SET_KEY_COUNT
+} SettingKey_e;
+
+/**
+ * @brief Statystyka magazynu (np. do konsoli).
+ */
+typedef struct
+{
+    uint16_t used;          /**< Zajęte rekordy na aktywnej stronie (z nagłówkiem) */
+    uint16_t capacity;      /**< Liczba rekordów na stronę */
+    uint16_t generation;    /**< Numer aktywnej strony (rośnie przy każdej kompaktacji) */
+    uint16_t badRecords;    /**< Rekordy z błędnym CRC pominięte przy starcie */
+    uint32_t scanUs;        /**< Czas odczytu przy starcie (µs) */
+} SettingsStats_t;
+
+/**
+ * @brief Odczyt ustawień przy starcie: wybór aktywnej strony i jedno przejście
+ *        po jej rekordach. Pusta/uszkodzona pamięć = formatowanie pierwszej strony.
+ */
+void Settings_Init(void);
+
+/**
+ * @brief Ostatnio zapisana wartość klucza.
+ * @return false, jeśli klucz nie był jeszcze zapisany (value bez zmian).
+ */
+bool Settings_Get(SettingKey_e key, uint32_t *value);
+
+/**
+ * @brief Zapis wartości: jeden 8-bajtowy rekord dopisany za ostatnim.
+ *        Ta sama wartość co zapisana = brak zapisu. Pełna strona = kompaktacja
+ *        do strony zapasowej (kasowanie ~20 ms, tylko raz na ~120 zmian).
+ * @return false przy błędzie programowania flasha.
+ */
+bool Settings_Set(SettingKey_e key, uint32_t value);
+
+/**
+ * @brief Statystyka magazynu.
+ */
+const SettingsStats_t *Settings_GetStats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SETTINGS_H
@@ -0,0 +1,53 @@
+// Created by: Marcin Dziedzic
+// shell.h
+
+#ifndef SHELL_H
+#define SHELL_H
+
+#include "stm32f1xx_hal.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Bufor odbiorczy DMA (cykliczny) i maksymalna długość linii polecenia.
+ */
+#define SHELL_RX_SIZE        256U
+#define SHELL_LINE_MAX       64U
+#define SHELL_ARGS_MAX       6U
+
+/**
+ * @brief Start odbioru: DMA w trybie cyklicznym + przerwanie IDLE.
+ * @param huart Uchwyt UART z podłączonym kanałem DMA RX.
+ */
+void Shell_Init(UART_HandleTypeDef *huart);
+
+/**
+ * @brief Sygnał z przerwania (IDLE, połowa/koniec bufora DMA) – są nowe dane.
+ */
+void Shell_RxEvent(void);
+
+/**
+ * @brief Wznowienie odbioru po błędzie UART (HAL_UART_ErrorCallback).
+ * @param huart Uchwyt UART, który zgłosił błąd.
+ */
+void Shell_RxRestart(UART_HandleTypeDef *huart);
+
+/**
+ * @brief Przetworzenie odebranych znaków i wykonanie pełnych linii.
+ *        Wołane w pętli głównej; nic nie robi, jeśli przerwanie nie zgłosiło danych.
+ */
+void Shell_Process(void);
+
+/**
+ * @brief Odpowiedź powłoki (printf do bufora nadawczego UART, bez czekania).
+ */
+void Shell_Printf(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SHELL_H
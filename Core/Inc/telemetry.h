@@ -0,0 +1,100 @@
+// Created by: Marcin Dziedzic
+// telemetry.h
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "stm32f1xx_hal.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Okres wysyłania ramek (ms). 34 bajty przy 115200 bd to ~3 ms transmisji.
+ */
+#define TELEMETRY_PERIOD_MS  200U
+
+/**
+ * @brief Nagłówek ramki i wersja formatu (dekoder: Tools/telemetry_decode.py).
+ */
+#define TELEMETRY_SYNC0      0xA5U
+#define TELEMETRY_SYNC1      0x5AU
+#define TELEMETRY_VERSION    1U
+
+/**
+ * @brief Bity pola flags.
+ */
+#define TELEMETRY_FLAG_ALARM     0x01U   /**< Alarm w trakcie wywołania */
+#define TELEMETRY_FLAG_LAMP      0x02U   /**< Lampa włączona (l_BulbOnOff == 1) */
+#define TELEMETRY_FLAG_LAMPREG   0x04U   /**< Regulator lampy aktywny */
+#define TELEMETRY_FLAG_DIMMER    0x08U   /**< Ściemniacz aktywny */
+#define TELEMETRY_FLAG_USB1_FLT  0x10U   /**< USB1 wyłączony po przeciążeniu */
+#define TELEMETRY_FLAG_USB2_FLT  0x20U   /**< USB2 wyłączony po przeciążeniu */
+#define TELEMETRY_FLAG_MEM_LOW   0x40U   /**< Zapas stosu/sterty poniżej MEMSTAT_WARN_MARGIN */
+
+/**
+ * @brief Ramka telemetrii (little-endian, bez wyrównania).
+ *        CRC-16/CCITT-FALSE (0x1021, start 0xFFFF) liczone od version do dropped.
+ */
+typedef struct __attribute__((packed))
+{
+    uint8_t  sync[2];      /**< TELEMETRY_SYNC0, TELEMETRY_SYNC1 */
+    uint8_t  version;      /**< TELEMETRY_VERSION */
+    uint8_t  length;       /**< Liczba bajtów od seq do crc (bez crc) */
+    uint16_t seq;          /**< Numer kolejny ramki */
+    uint32_t tickMs;       /**< HAL_GetTick() w chwili budowania */
+    uint16_t loopAvgUs;    /**< Średni okres pętli głównej od poprzedniej ramki (µs) */
+    uint16_t loopMaxUs;    /**< Najdłuższy okres pętli od poprzedniej ramki (µs) */
+    uint8_t  state;        /**< gState */
+    uint8_t  flags;        /**< TELEMETRY_FLAG_x */
+    uint16_t lux;          /**< Przefiltrowane natężenie światła (lx) */
+    uint16_t level;        /**< Jasność lampy 0..65535 (wypełnienie PWM) */
+    int32_t  alarmInS;     /**< Sekundy do alarmu, -1 = brak alarmu dziś */
+    uint16_t rtcErrors;    /**< Błędy I2C – RTC */
+    uint16_t luxErrors;    /**< Błędy I2C – czujnik światła */
+    uint16_t stackUsed;    /**< Najgłębsze zużycie stosu od startu (bajty, memstat.h) */
+    uint16_t dropped;      /**< Ramki pominięte z braku miejsca w buforze nadawczym */
+    uint16_t crc;          /**< CRC ramki */
+} TelemetryFrame_t;
+
+/**
+ * @brief Inicjalizacja: odczyt ustawienia włączenia (SET_KEY_TELEMETRY) i start pomiaru okresu pętli.
+ *        Ramki idą przez bufor nadawczy UART (uart_tx.h) – razem z odpowiedziami konsoli.
+ */
+void Telemetry_Init(void);
+
+/**
+ * @brief Znacznik początku obiegu pętli głównej (pomiar okresu pętli).
+ */
+void Telemetry_LoopMark(void);
+
+/**
+ * @brief Co TELEMETRY_PERIOD_MS buduje ramkę i dopisuje ją do bufora nadawczego.
+ * @param now Aktualny czas (HAL_GetTick())
+ */
+void Telemetry_Process(uint32_t now);
+
+/**
+ * @brief Ramka z bieżącym stanem, bez wysyłania i bez zmiany licznika seq.
+ * @param frame Ramka do wypełnienia
+ */
+void Telemetry_Snapshot(TelemetryFrame_t *frame);
+
+/**
+ * @brief Włączenie/wyłączenie okresowego wysyłania ramek (zapamiętywane we flashu).
+ */
+void Telemetry_SetEnabled(bool on);
+
+/**
+ * @brief Czy ramki są wysyłane?
+ */
+bool Telemetry_IsEnabled(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TELEMETRY_H
@@ -0,0 +1,109 @@
+// Created by: Marcin Dziedzic
+// trace.h
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "stm32f1xx_hal.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Tracer włączony w konfiguracji Debug (jak profiler, prof.h).
+ *        TRACE_DISABLE wyłącza go mimo to; w Release makra znikają całkowicie.
+ */
+#if defined(DEBUG) && !defined(TRACE_DISABLE)
+#define TRACE_ENABLED        1
+#else
+#define TRACE_ENABLED        0
+#endif
+
+/**
+ * @brief Pojemność bufora w RAM (potęga dwójki, 8 B na zdarzenie).
+ */
+#ifndef TRACE_RING_SIZE
+#define TRACE_RING_SIZE      64U
+#endif
+
+/**
+ * @brief Zdarzenie id idzie portem ITM TRACE_ITM_PORT_BASE + id
+ *        (port 0 zostaje dla printf przez SWV).
+ */
+#define TRACE_ITM_PORT_BASE  1U
+
+/**
+ * @brief Prędkość SWO (NRZ): 64 MHz / 32. ST-LINK/V2 obsługuje 2 MHz;
+ *        w SWV ustawić ten sam zegar rdzenia i prędkość.
+ */
+#define TRACE_SWO_BAUD       2000000U
+
+/**
+ * @brief Słowo ITM: [31:11] czas w µs (młodsze 21 bitów, zawija się co ~2.1 s),
+ *        [10:0] argument. TRACE_EVT_SECOND co sekundę pozwala rozwinąć czas
+ *        po stronie hosta (Tools/trace_timeline.py).
+ */
+#define TRACE_ARG_BITS       11U
+#define TRACE_ARG_MASK       ((1U << TRACE_ARG_BITS) - 1U)
+
+/**
+ * @brief Rodzaje zdarzeń (kolejność = numery w Tools/trace_timeline.py).
+ */
+typedef enum
+{
+    TRACE_EVT_STATE,       /**< Przejście automatu menu; arg = nowy MenuState */
+    TRACE_EVT_ISR_ENTER,   /**< Wejście w przerwanie; arg = numer wyjątku (IPSR) */
+    TRACE_EVT_ISR_EXIT,    /**< Wyjście z przerwania; arg = numer wyjątku */
+    TRACE_EVT_I2C_START,   /**< Początek transakcji I2C; arg = adres 7-bit */
+    TRACE_EVT_I2C_STOP,    /**< Koniec transakcji; arg = HAL_StatusTypeDef */
+    TRACE_EVT_LCD_START,   /**< Początek ramki LCD (Render_Frame) */
+    TRACE_EVT_LCD_STOP,    /**< Koniec ramki; arg = wysłane znaki */
+    TRACE_EVT_FADE_STEP,   /**< Zmiana jasności lampy; arg = poziom >> 5 */
+    TRACE_EVT_SECOND,      /**< Nowa sekunda RTC; arg = sekundy */
+    TRACE_EVT_COUNT
+} TraceEvt_e;
+
+#if TRACE_ENABLED
+
+/**
+ * @brief Zapis zdarzenia (także z przerwań). Koszt: odczyt CYCCNT, wpis do bufora
+ *        i jeden zapis do portu ITM – bez czekania; pełne FIFO = zdarzenie tylko w RAM.
+ */
+#define TRACE(id, arg)        Trace_Event((id), (uint16_t)(arg))
+#define TRACE_ISR_ENTER()     Trace_Event(TRACE_EVT_ISR_ENTER, (uint16_t)__get_IPSR())
+#define TRACE_ISR_EXIT()      Trace_Event(TRACE_EVT_ISR_EXIT, (uint16_t)__get_IPSR())
+
+/**
+ * @brief Włączenie CYCCNT, ITM (porty zdarzeń) i wyjścia SWO na PB3.
+ *        Debugger z włączonym SWV może te ustawienia nadpisać – wtedy wygrywa on.
+ */
+void Trace_Init(void);
+
+/**
+ * @brief Dopisanie zdarzenia do bufora i strumienia ITM.
+ */
+void Trace_Event(TraceEvt_e id, uint16_t arg);
+
+/**
+ * @brief Zrzut bufora (od najstarszego) przez USART2 – gdy SWO nie jest podłączone.
+ *        Format linii: "trc <µs> <id> <arg>".
+ */
+void Trace_Dump(void);
+
+#else
+
+#define TRACE(id, arg)        do { } while (0)
+#define TRACE_ISR_ENTER()     do { } while (0)
+#define TRACE_ISR_EXIT()      do { } while (0)
+#define Trace_Init()          do { } while (0)
+#define Trace_Dump()          do { } while (0)
+
+#endif // TRACE_ENABLED
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TRACE_H
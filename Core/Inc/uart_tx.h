@@ -0,0 +1,71 @@
+// Created by: Marcin Dziedzic
+// uart_tx.h
+
+#ifndef UART_TX_H
+#define UART_TX_H
+
+#include "stm32f1xx_hal.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Pojemność bufora nadawczego (potęga 2).
+ */
+#define UARTTX_RING_SIZE     512U
+
+/**
+ * @brief Inicjalizacja bufora nadawczego UART (wysyłanie przez DMA TX).
+ * @param huart Uchwyt UART z podłączonym kanałem DMA TX.
+ */
+void UartTx_Init(UART_HandleTypeDef *huart);
+
+/**
+ * @brief Dopisanie bloku do bufora (w całości albo wcale) i ewentualny start DMA.
+ *        Nie czeka – wołane z pętli głównej.
+ * @param data Dane
+ * @param len  Liczba bajtów
+ * @return len, jeśli blok się zmieścił, 0 jeśli został odrzucony.
+ */
+uint16_t UartTx_Write(const void *data, uint16_t len);
+
+/**
+ * @brief Jak UartTx_Write, ale najpierw czeka (maks. timeoutMs), aż DMA zwolni
+ *        miejsce na blok. Dla zrzutów dłuższych niż bufor – wołane z pętli głównej,
+ *        czas oczekiwania liczy się do terminów zadań (watchdog.h).
+ * @param data      Dane
+ * @param len       Liczba bajtów
+ * @param timeoutMs Najdłuższe oczekiwanie na miejsce
+ * @return len, jeśli blok się zmieścił, 0 jeśli został odrzucony.
+ */
+uint16_t UartTx_WriteWait(const void *data, uint16_t len, uint32_t timeoutMs);
+
+/**
+ * @brief Domyślne oczekiwanie na linię zrzutu (profiler, ślad zdarzeń). Po jego
+ *        upływie linia przepada – czas całego zrzutu pozostaje ograniczony.
+ */
+#define UARTTX_DUMP_WAIT_MS  10U
+
+/**
+ * @brief Wolne miejsce w buforze (bajty).
+ */
+uint16_t UartTx_Free(void);
+
+/**
+ * @brief Liczba bloków odrzuconych z braku miejsca.
+ */
+uint32_t UartTx_GetDropped(void);
+
+/**
+ * @brief Koniec transmisji DMA – wywoływane z HAL_UART_TxCpltCallback.
+ * @param huart Uchwyt UART, który zakończył nadawanie.
+ */
+void UartTx_TxComplete(UART_HandleTypeDef *huart);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UART_TX_H
@@ -0,0 +1,95 @@
+// Created by: Marcin Dziedzic
+// usb_port.h
+
+#ifndef USB_PORT_H
+#define USB_PORT_H
+
+#include "stm32f1xx_hal.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Porty zasilania USB (klucze z wyjściem FLT, aktywnym stanem niskim).
+ */
+typedef enum
+{
+    USB_PORT_1,
+    USB_PORT_2,
+    USB_PORT_COUNT
+} UsbPort_e;
+
+/**
+ * @brief Stan portu.
+ */
+typedef enum
+{
+    USB_STATE_OFF,       /**< Wyłączony przez użytkownika */
+    USB_STATE_ON,        /**< Zasilanie włączone, brak przeciążenia */
+    USB_STATE_FAULT      /**< Przeciążenie – zasilanie odcięte, czeka na ponowienie */
+} UsbPortState_e;
+
+/**
+ * @brief Odstęp pierwszego ponowienia po przeciążeniu; każde kolejne przeciążenie
+ *        bez stabilnej pracy podwaja odstęp, aż do USB_RETRY_MAX_MS.
+ */
+#define USB_RETRY_FIRST_MS   250U
+#define USB_RETRY_MAX_MS     30000U
+
+/**
+ * @brief Praca bez przeciążenia (ms), po której odstęp ponowień wraca do początku.
+ */
+#define USB_STABLE_MS        5000U
+
+/**
+ * @brief Inicjalizacja: oba porty wyłączone (stan z ustawień wystawia Menu_LoadSettings).
+ *        Linie FLT zgłaszają przeciążenie przez EXTI (zbocze opadające).
+ */
+void UsbPort_Init(void);
+
+/**
+ * @brief Żądanie włączenia/wyłączenia portu. Włączenie kasuje licznik kolejnych
+ *        przeciążeń (ręczne ponowienie od razu, bez czekania na backoff).
+ * @param port USB_PORT_1 / USB_PORT_2
+ * @param on   true = zasilanie włączone
+ */
+void UsbPort_Set(UsbPort_e port, bool on);
+
+/**
+ * @brief Bieżący stan portu (UsbPortState_e).
+ */
+UsbPortState_e UsbPort_GetState(UsbPort_e port);
+
+/**
+ * @brief Liczba przeciążeń od startu.
+ */
+uint16_t UsbPort_GetFaultCount(UsbPort_e port);
+
+/**
+ * @brief Czas (ms) do najbliższego ponowienia; 0 poza stanem USB_STATE_FAULT.
+ * @param now Bieżący czas (HAL_GetTick)
+ */
+uint32_t UsbPort_GetRetryInMs(UsbPort_e port, uint32_t now);
+
+/**
+ * @brief Obsługa przerwania EXTI linii FLT – odcina zasilanie portu od razu,
+ *        w przerwaniu. Wołać z HAL_GPIO_EXTI_Callback.
+ * @param GPIO_Pin Pin, który zgłosił przerwanie
+ */
+void UsbPort_FaultIrq(uint16_t GPIO_Pin);
+
+/**
+ * @brief Ponowienia z wykładniczym odstępem i kontrola poziomu linii FLT
+ *        (zbocze mogło wystąpić, gdy port był wyłączony). Wołać w pętli głównej.
+ * @param now Bieżący czas (HAL_GetTick)
+ */
+void UsbPort_Process(uint32_t now);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* USB_PORT_H */
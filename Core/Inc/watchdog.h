@@ -0,0 +1,85 @@
+// Created by: Marcin Dziedzic
+// watchdog.h
+
+#ifndef WATCHDOG_H
+#define WATCHDOG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Czas do resetu bez odświeżenia IWDG (ms, LSI 40 kHz / 32; LSI ma rozrzut ±50%).
+ */
+#define WDG_TIMEOUT_MS          1000U
+
+/**
+ * @brief Zadania nadzorowane przez watchdog (kolejność jak w pętli głównej).
+ */
+typedef enum
+{
+    WDG_TASK_FADE,       /**< LedFade_Process */
+    WDG_TASK_SENSOR,     /**< LightSen_Sample + regulator lampy */
+    WDG_TASK_CLOCK,      /**< Clock_Poll (odczyt RTC) */
+    WDG_TASK_INPUT,      /**< Enkoder i automat menu */
+    WDG_TASK_RENDER,     /**< Render_Frame (zapis do LCD) */
+    WDG_TASK_COUNT,
+    WDG_TASK_NONE = 0xFF
+} WdgTask_e;
+
+/**
+ * @brief Terminy zgłoszeń zadań (ms). Wszystkie zadania wołane są w każdym obiegu
+ *        pętli (~10 ms); termin to najdłuższy dopuszczalny odstęp między ich krokami,
+ *        z zapasem na kasowanie strony flasha, zrzuty profilera i śladu zdarzeń
+ *        (polecenie "trace" konsoli) i transakcje I2C z limitem czasu.
+ */
+#define WDG_DEADLINE_FADE_MS    250U
+#define WDG_DEADLINE_SENSOR_MS  500U
+#define WDG_DEADLINE_CLOCK_MS   500U
+#define WDG_DEADLINE_INPUT_MS   300U
+#define WDG_DEADLINE_RENDER_MS  300U
+
+/**
+ * @brief Start IWDG i odczyt przyczyny poprzedniego resetu (rekord w RAM bez
+ *        inicjalizacji + flaga IWDGRSTF). Raport trafia na USART2 – wołać po Shell_Init.
+ *        Od tej chwili IWDG odświeża wyłącznie Wdg_Tick.
+ */
+void Wdg_Init(void);
+
+/**
+ * @brief Rejestracja zadania: od teraz musi się zgłaszać co najwyżej co deadlineMs.
+ *        Zadania startujące później (np. czujnik po inicjalizacji odroczonej)
+ *        rejestruje się dopiero wtedy, gdy zaczynają działać.
+ */
+void Wdg_Register(WdgTask_e task, uint16_t deadlineMs);
+
+/**
+ * @brief Początek kroku zadania – jeśli zawiśnie w środku, raport wskaże właśnie je.
+ */
+void Wdg_Begin(WdgTask_e task);
+
+/**
+ * @brief Koniec kroku zadania (zgłoszenie "żyję"); mierzy też najdłuższy odstęp zgłoszeń.
+ */
+void Wdg_Checkin(WdgTask_e task);
+
+/**
+ * @brief Nadzór – wywoływany z SysTick (1 kHz). Odświeża IWDG tylko wtedy, gdy
+ *        wszystkie zarejestrowane zadania zgłosiły się w swoim terminie; pierwsze
+ *        przekroczenie zapisuje winne zadanie i blokuje odświeżanie do resetu.
+ */
+void Wdg_Tick(void);
+
+/**
+ * @brief Raport: przyczyna poprzedniego resetu i najdłuższe odstępy zgłoszeń zadań.
+ */
+void Wdg_Report(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WATCHDOG_H
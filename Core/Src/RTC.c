@@ -2,6 +2,9 @@
 // RTC.c
 
 #include "RTC.h"
+#include "prof.h"
+#include "calendar.h"
+#include "trace.h"
 
 /*
    PCF85063AT (obudowa SO8) ma 7-bitowy adres 0x51.
@@ -11,6 +14,11 @@
 */
 #define PCF85063A_WRITE_ADDR   0xA2
 #define PCF85063A_READ_ADDR    0xA3
+#define PCF85063A_ADDR7        0x51   // adres w zdarzeniach tracera
+
+// Limit czasu transakcji (ms): 7 bajtów przy 100 kHz to <1 ms, zablokowana
+// magistrala nie może zatrzymać pętli głównej (nadzór watchdoga)
+#define RTC_I2C_TIMEOUT_MS     10U
 
 /* Używane rejestry wg dokumentacji:
    - 0x04 => Seconds (BCD, bit7=OS)
@@ -20,11 +28,15 @@
    - 0x08 => Weekdays (0..6, nie jest BCD)
    - 0x09 => Months
    - 0x0A => Years (0..99)
+   - 0x03 => RAM_byte (wolny bajt, podtrzymywany bateryjnie razem z zegarem)
 */
 
 /* Wskaźnik do uchwytu I2C */
 static I2C_HandleTypeDef *rtc_i2c = NULL;
 
+/* Licznik nieudanych transakcji I2C (telemetria) */
+static uint16_t rtc_errors = 0;
+
 /* Funkcje pomocnicze do konwersji BCD <-> DEC */
 static uint8_t bcd2dec(uint8_t bcd)
 {
@@ -55,11 +67,9 @@ void RTC_SetTime(const RTC_TimeTypeDef *time)
 {
     if (rtc_i2c == NULL) return;
 
-    if (time->seconds > 59 || time->minutes > 59 || time->hours > 23 ||
-           time->day < 1 || time->day > 31 || time->month < 1 || time->month > 12 ||
-           time->year > 99) {
-           return; // Nie ustawiaj, jeśli dane są nieprawidłowe
-       }
+    if (!Cal_IsValid(time)) {
+        return; // Nie ustawiaj, jeśli dane są nieprawidłowe (także 31.02)
+    }
 
     uint8_t buffer[7];
 
@@ -71,21 +81,27 @@ void RTC_SetTime(const RTC_TimeTypeDef *time)
     buffer[2] = dec2bcd(time->hours) & 0x3F;
     // dzień
     buffer[3] = dec2bcd(time->day) & 0x3F;
-    // dzień tygodnia (0..6) - tutaj nie jest BCD, wystarczy maskować ewentualnie do 0..7
-    buffer[4] = (time->weekday & 0x07);
+    // dzień tygodnia (0..6) - liczony z daty, wartość od wywołującego pomijamy
+    buffer[4] = Cal_Weekday(time->year, time->month, time->day);
     // miesiąc
     buffer[5] = dec2bcd(time->month) & 0x1F;
     // rok (0..99)
     buffer[6] = dec2bcd(time->year);
 
     // Zapis do rejestrów 0x04..0x0A (7 bajtów)
-    HAL_I2C_Mem_Write(rtc_i2c,
+    TRACE(TRACE_EVT_I2C_START, PCF85063A_ADDR7);
+    HAL_StatusTypeDef ret = HAL_I2C_Mem_Write(rtc_i2c,
                       PCF85063A_WRITE_ADDR, // 0xA2
                       0x04,
                       I2C_MEMADD_SIZE_8BIT,
                       buffer,
                       7,
-                      100);
+                      RTC_I2C_TIMEOUT_MS);
+    TRACE(TRACE_EVT_I2C_STOP, ret);
+    if (ret != HAL_OK)
+    {
+        rtc_errors++;
+    }
 }
 
 /* -------------------------------------------------------
@@ -101,19 +117,24 @@ void RTC_ReadTime(RTC_TimeTypeDef *time)
 {
     if (rtc_i2c == NULL) return;
 
+    PROF_BEGIN(rtc);
     HAL_StatusTypeDef ret;
     uint8_t regPointer[1] = {0x04};
     uint8_t buffer[7]     = {0};
 
     // Krok 1) i 2): START + Write(0xA2), wyślij '0x04' (adres rejestru sekundy)
+    TRACE(TRACE_EVT_I2C_START, PCF85063A_ADDR7);
     ret = HAL_I2C_Master_Transmit(rtc_i2c,
                                   PCF85063A_WRITE_ADDR,
                                   regPointer,
                                   1,
-                                  100);
+                                  RTC_I2C_TIMEOUT_MS);
     if (ret != HAL_OK)
     {
         // Błąd
+        rtc_errors++;
+        TRACE(TRACE_EVT_I2C_STOP, ret);
+        PROF_END(rtc, PROF_RTC_READ);
         return;
     }
 
@@ -122,10 +143,13 @@ void RTC_ReadTime(RTC_TimeTypeDef *time)
                                  PCF85063A_READ_ADDR,
                                  buffer,
                                  7,
-                                 100);
+                                 RTC_I2C_TIMEOUT_MS);
+    TRACE(TRACE_EVT_I2C_STOP, ret);
     if (ret != HAL_OK)
     {
         // Błąd
+        rtc_errors++;
+        PROF_END(rtc, PROF_RTC_READ);
         return;
     }
     // Krok 5): STOP generuje się automatycznie po zakończeniu transmisji.
@@ -138,4 +162,99 @@ void RTC_ReadTime(RTC_TimeTypeDef *time)
     time->weekday = (buffer[4] & 0x07);
     time->month   = bcd2dec(buffer[5] & 0x1F);
     time->year    = bcd2dec(buffer[6]);
+
+    // Rejestr dnia tygodnia PCF85063 tylko liczy modulo 7 – nie pilnuje zgodności z datą.
+    // Poprawna data ma pierwszeństwo.
+    if (Cal_IsValid(time))
+    {
+        time->weekday = Cal_Weekday(time->year, time->month, time->day);
+    }
+
+    PROF_END(rtc, PROF_RTC_READ);
+}
+
+/* -------------------------------------------------------
+ * RTC_ReadSeconds:
+ *   Odczyt samego rejestru 0x04 (1 bajt) – do wykrywania
+ *   zmiany sekundy bez czytania całej daty.
+ * ------------------------------------------------------- */
+bool RTC_ReadSeconds(uint8_t *seconds)
+{
+    if (rtc_i2c == NULL) return false;
+
+    uint8_t reg = 0;
+
+    TRACE(TRACE_EVT_I2C_START, PCF85063A_ADDR7);
+    HAL_StatusTypeDef ret = HAL_I2C_Mem_Read(rtc_i2c,
+                         PCF85063A_READ_ADDR,
+                         0x04,
+                         I2C_MEMADD_SIZE_8BIT,
+                         &reg,
+                         1,
+                         RTC_I2C_TIMEOUT_MS);
+    TRACE(TRACE_EVT_I2C_STOP, ret);
+    if (ret != HAL_OK)
+    {
+        rtc_errors++;
+        return false;
+    }
+
+    *seconds = bcd2dec(reg & 0x7F);
+    return true;
+}
+
+/* -------------------------------------------------------
+ * RTC_ReadRam / RTC_WriteRam:
+ *   Bajt RAM (rejestr 0x03) – przetrwa reset i zanik
+ *   zasilania MCU (stan do wznowienia pracy, resume.c).
+ * ------------------------------------------------------- */
+bool RTC_ReadRam(uint8_t *value)
+{
+    if (rtc_i2c == NULL) return false;
+
+    TRACE(TRACE_EVT_I2C_START, PCF85063A_ADDR7);
+    HAL_StatusTypeDef ret = HAL_I2C_Mem_Read(rtc_i2c,
+                         PCF85063A_READ_ADDR,
+                         0x03,
+                         I2C_MEMADD_SIZE_8BIT,
+                         value,
+                         1,
+                         RTC_I2C_TIMEOUT_MS);
+    TRACE(TRACE_EVT_I2C_STOP, ret);
+    if (ret != HAL_OK)
+    {
+        rtc_errors++;
+        return false;
+    }
+    return true;
+}
+
+bool RTC_WriteRam(uint8_t value)
+{
+    if (rtc_i2c == NULL) return false;
+
+    TRACE(TRACE_EVT_I2C_START, PCF85063A_ADDR7);
+    HAL_StatusTypeDef ret = HAL_I2C_Mem_Write(rtc_i2c,
+                          PCF85063A_WRITE_ADDR,
+                          0x03,
+                          I2C_MEMADD_SIZE_8BIT,
+                          &value,
+                          1,
+                          RTC_I2C_TIMEOUT_MS);
+    TRACE(TRACE_EVT_I2C_STOP, ret);
+    if (ret != HAL_OK)
+    {
+        rtc_errors++;
+        return false;
+    }
+    return true;
+}
+
+/* -------------------------------------------------------
+ * RTC_GetErrorCount:
+ *   Liczba nieudanych transakcji I2C od startu.
+ * ------------------------------------------------------- */
+uint16_t RTC_GetErrorCount(void)
+{
+    return rtc_errors;
 }
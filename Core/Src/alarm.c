@@ -7,8 +7,13 @@
 #include <stdbool.h>
 #include "light_sen.h"
 #include "fade.h"
+#include "envelope.h"
 #include "menu_state_handlers.h"
 #include "lcd.h"
+#include "clock.h"
+#include "settings.h"
+#include "calendar.h"
+#include "log.h"
 
 // Zewnętrzne deklaracje timerów, wyświetlacza, i2c
 extern TIM_HandleTypeDef htim3;
@@ -19,58 +24,158 @@ extern I2C_HandleTypeDef hi2c1;
 extern int l_BulbOnOff;         // 1 = ON, 2 = OFF
 extern int8_t currentSubMenuIndex;
 
+/**
+ * @brief Ile sekund przed alarmem startuje obwiednia świtu (ENV_DAWN).
+ */
+#define ALARM_DAWN_LEAD_S     (ENV_DAWN_RAMP_MS / 1000)
+
+/**
+ * @brief Ile sekund przed startem lampy mierzymy natężenie światła.
+ */
+#define ALARM_LSENSOR_LEAD_S  15
+
+/**
+ * @brief Drzemka: alarm ponownie za tyle sekund od wciśnięcia SNOOZE.
+ */
+#define ALARM_SNOOZE_S        300U
+
 bool alarmIsActive = false;
 bool skipLamp = false; // false = włączymy lampę, true = pominiemy ją (jest jasno)
 
+static uint32_t savedEpoch = 0;  // alarm zapisany we flashu – punkt odniesienia drzemki
+
+/* ----------------------------------------------------------------------------
+   Alarm <-> sekundy od 2000-01-01 (calendar.c). Porównania i przesunięcia
+   liczone na epoce – bez osobnych przypadków dla północy i końca miesiąca.
+   -----------------------------------------------------------------------------*/
+
+static void Alarm_ToTime(RTC_TimeTypeDef *t)
+{
+    t->year    = (uint8_t)alarmData.year;
+    t->month   = (uint8_t)alarmData.month;
+    t->day     = (uint8_t)alarmData.day;
+    t->hours   = (uint8_t)alarmData.hour;
+    t->minutes = (uint8_t)alarmData.minute;
+    t->seconds = (uint8_t)alarmData.second;
+    t->weekday = (uint8_t)alarmData.weekday;
+}
+
+static void Alarm_FromTime(const RTC_TimeTypeDef *t)
+{
+    alarmData.year    = (int8_t)t->year;
+    alarmData.month   = (int8_t)t->month;
+    alarmData.day     = (int8_t)t->day;
+    alarmData.hour    = (int8_t)t->hours;
+    alarmData.minute  = (int8_t)t->minutes;
+    alarmData.second  = (int8_t)t->seconds;
+    alarmData.weekday = (int8_t)t->weekday;
+}
+
+uint32_t Alarm_GetEpoch(void)
+{
+    RTC_TimeTypeDef t;
+    Alarm_ToTime(&t);
+    return Cal_ToEpoch(&t);
+}
+
+void Alarm_SetEpoch(uint32_t epoch)
+{
+    RTC_TimeTypeDef t;
+    Cal_FromEpoch(epoch, &t);
+    Alarm_FromTime(&t);
+}
+
+void Alarm_Normalize(void)
+{
+    RTC_TimeTypeDef t;
+    Alarm_ToTime(&t);
+    Cal_Clamp(&t);
+    Alarm_FromTime(&t);
+}
+
 /**
- * @brief Funkcja zakłada, że bieżący czas i struktura alarmData są w tym samym dniu.
- *        Zwraca dodatnią wartość, jeśli alarm w przyszłości,
- *        0 jeśli aktualna sekunda == alarm sekunda,
- *        ujemną jeśli alarm już minął.
+ * @brief Sekundy od teraz do alarmu: dodatnie – w przyszłości, 0 – teraz, ujemne – minął.
  */
-int TimeDiffSec(const RTC_TimeTypeDef *now, const AlarmData *a)
+static int32_t Alarm_DiffSec(const RTC_TimeTypeDef *now)
 {
-    // Zamiana HH:MM:SS na całkowitą liczbę sekund od północy
-    int nowSec   = now->hours   * 3600 + now->minutes   * 60 + now->seconds;
-    int alarmSec = a->hour      * 3600 + a->minute      * 60 + a->second;
-    return alarmSec - nowSec;
+    return (int32_t)(Alarm_GetEpoch() - Cal_ToEpoch(now));
 }
 
 /**
  * @brief Sprawdza, czy aktualny czas RTC zgadza się z ustawionym alarmem.
- *        Jeśli tak – ustawia stan ALARM_TRIGGERED.
+ *        Jeśli tak – zgłasza automatowi menu zdarzenie UI_EVT_ALARM.
  */
 void CheckAlarmTrigger(const RTC_TimeTypeDef *rtc_info)
 {
     extern bool alarmIsActive;
-    extern int  lightSensorMode; // 1=ON (czujnik używany), 2=OFF (ignoruj czujnik)
     extern bool skipLamp;
 
     // Jeśli alarm już aktywny, nic nie robimy
     if (alarmIsActive) return;
 
-    // Sprawdzamy, czy dzień/miesiąc/rok zgadza się z ustawieniami alarmu
-    if ((rtc_info->day   == alarmData.day) &&
-        (rtc_info->month == alarmData.month) &&
-        (rtc_info->year  == alarmData.year))
+    // Różnica (w sekundach) między aktualnym czasem a alarmem – także przez północ
+    // (świt alarmu o 00:10 startuje poprzedniego dnia)
+    int32_t diff = Alarm_DiffSec(rtc_info);
+
+    // Jeśli włączony czujnik światła, mierzymy natężenie 15 s przed startem świtu
+    // (lub 15 s przed alarmem, gdy świt nie wystartował – alarm ustawiony "na już")
+    if (lightSensorMode == 1 &&
+        (diff == ALARM_DAWN_LEAD_S + ALARM_LSENSOR_LEAD_S ||
+         (diff == ALARM_LSENSOR_LEAD_S && !Envelope_IsActive(g_fadeHandle.channel))))
+    {
+        uint16_t lux = LightSen_ReadLux(&hi2c1);
+        skipLamp = (lux > 100) ? true : false;
+    }
+
+    // 30 min przed alarmem: start świtu (o ile lampa zgaszona i nie jest jasno)
+    if (diff == ALARM_DAWN_LEAD_S && !skipLamp && l_BulbOnOff == 2)
     {
-        // Różnica (w sekundach) między aktualnym czasem a alarmem
-        int diff = TimeDiffSec(rtc_info, &alarmData);
-
-        // Jeśli włączony czujnik światła i do alarmu zostało 15 sek, mierzymy natężenie światła
-        if (lightSensorMode == 1 && diff == 15)
-        {
-            uint16_t lux = LightSen_ReadLux(&hi2c1);
-            skipLamp = (lux > 100) ? true : false;
-        }
-
-        // Jeśli diff == 0 -> czas alarmu
-        if (diff == 0)
-        {
-            gState = ALARM_TRIGGERED;
-            alarmIsActive = true;
-        }
+        l_BulbOnOff = 1;
+        LedFade_PlayEnvelope(&g_fadeHandle, &ENV_DAWN);
+        LOG("alarm: dawn started");
     }
+
+    // Jeśli diff == 0 -> czas alarmu
+    if (diff == 0)
+    {
+        // Alarm wywłaszcza bieżący ekran (wejście w ALARM_TRIGGERED w Menu_Dispatch)
+        Menu_Post(UI_EVT_ALARM);
+        alarmIsActive = true;
+        LOG("alarm: triggered (skip lamp %u)", skipLamp);
+    }
+}
+
+/**
+ * @brief Sekundy do alarmu (-1 = już minął).
+ */
+int32_t Alarm_SecondsToGo(const RTC_TimeTypeDef *now)
+{
+    int32_t diff = Alarm_DiffSec(now);
+    return (diff >= 0) ? diff : -1;
+}
+
+/**
+ * @brief Drzemka liczona od chwili wciśnięcia – z przeniesieniem na kolejny dzień,
+ *        miesiąc i rok. Tylko w RAM (zapis we flashu zostaje bez zmian).
+ */
+void Alarm_Snooze(const RTC_TimeTypeDef *now)
+{
+    Alarm_SetEpoch(Cal_ToEpoch(now) + ALARM_SNOOZE_S);
+}
+
+uint16_t Alarm_GetSnoozeS(void)
+{
+    uint32_t epoch = Alarm_GetEpoch();
+    if (epoch <= savedEpoch)
+    {
+        return 0U;
+    }
+    return (uint16_t)(((epoch - savedEpoch) > 0xFFFFU) ? 0xFFFFU : (epoch - savedEpoch));
+}
+
+void Alarm_RestoreSnooze(uint16_t seconds)
+{
+    Alarm_SetEpoch(savedEpoch + seconds);
 }
 
 /**
@@ -78,17 +183,48 @@ void CheckAlarmTrigger(const RTC_TimeTypeDef *rtc_info)
  */
 void AlarmPreSet(void)
 {
-    RTC_TimeTypeDef now;
-    RTC_ReadTime(&now);
+    const RTC_TimeTypeDef *now = Clock_Now();
+    uint32_t date;
+    uint32_t time;
+
+    // Alarm zapisany we flashu ma pierwszeństwo przed domyślnym
+    if (Settings_Get(SET_KEY_ALARM_DATE, &date) && Settings_Get(SET_KEY_ALARM_TIME, &time))
+    {
+        alarmData.year    = (int8_t)(date >> 16);
+        alarmData.month   = (int8_t)(date >> 8);
+        alarmData.day     = (int8_t)date;
+        alarmData.hour    = (int8_t)(time >> 16);
+        alarmData.minute  = (int8_t)(time >> 8);
+        alarmData.second  = (int8_t)time;
+
+        // Uszkodzony zapis (np. 31.02) – najbliższa poprawna data; dzień tygodnia z daty
+        Alarm_Normalize();
+        savedEpoch = Alarm_GetEpoch();
+        return;
+    }
 
     // Ustawiamy alarm na dzisiejszą datę, godzina 12:30:00
-    alarmData.day    = now.day;
-    alarmData.month  = now.month;
-    alarmData.year   = now.year;
+    alarmData.day    = now->day;
+    alarmData.month  = now->month;
+    alarmData.year   = now->year;
     alarmData.hour   = 12;
     alarmData.minute = 30;
     alarmData.second = 0;
 
-    // Można ustawić dzień tygodnia, jeśli RTC go przechowuje
-    alarmData.weekday = now.weekday;
+    Alarm_Normalize();
+    savedEpoch = Alarm_GetEpoch();
+}
+
+/**
+ * @brief Zapis alarmu we flashu (dwa rekordy; niezmienione pola nic nie kosztują).
+ */
+void Alarm_Save(void)
+{
+    Settings_Set(SET_KEY_ALARM_DATE, ((uint32_t)(uint8_t)alarmData.year << 16) |
+                                     ((uint32_t)(uint8_t)alarmData.month << 8) |
+                                     (uint8_t)alarmData.day);
+    Settings_Set(SET_KEY_ALARM_TIME, ((uint32_t)(uint8_t)alarmData.hour << 16) |
+                                     ((uint32_t)(uint8_t)alarmData.minute << 8) |
+                                     (uint8_t)alarmData.second);
+    savedEpoch = Alarm_GetEpoch();
 }
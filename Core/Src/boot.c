@@ -0,0 +1,62 @@
+// Created by: Marcin Dziedzic
+// boot.c
+
+#include "boot.h"
+#include "fade.h"
+#include "shell.h"
+
+static const char *const stageNames[BOOT_STAGE_COUNT] = {
+    "periph", "drivers", "lcd", "frame", "rtc", "ui", "sensor", "ready",
+};
+
+static uint32_t stageUs[BOOT_STAGE_COUNT];
+static uint16_t doneMask = 0;
+
+_Static_assert(BOOT_STAGE_COUNT <= 16, "doneMask ma 16 bitów");
+
+void Boot_Mark(BootStage_e stage)
+{
+    if (Boot_Done(stage))
+    {
+        return;
+    }
+
+    // Czas od HAL_Init (SysTick startuje w HAL_Init)
+    stageUs[stage] = LedFade_NowUs();
+    doneMask |= (uint16_t)(1U << stage);
+
+    if (stage == BOOT_READY)
+    {
+        Boot_Report();
+    }
+}
+
+bool Boot_Done(BootStage_e stage)
+{
+    return (doneMask & (1U << stage)) != 0U;
+}
+
+/**
+ * @brief Jedna linia: "boot: periph=1.2 drivers=3.4 ... ms", potem podsumowanie.
+ */
+void Boot_Report(void)
+{
+    Shell_Printf("boot:");
+    for (uint8_t i = 0; i < BOOT_STAGE_COUNT; i++)
+    {
+        if (Boot_Done((BootStage_e)i))
+        {
+            Shell_Printf(" %s=%lu.%lu", stageNames[i],
+                         (unsigned long)(stageUs[i] / 1000U),
+                         (unsigned long)((stageUs[i] % 1000U) / 100U));
+        }
+    }
+    Shell_Printf(" ms\r\n");
+
+    if (Boot_Done(BOOT_FIRST_FRAME) && Boot_Done(BOOT_READY))
+    {
+        Shell_Printf("boot: first frame %lu ms, ready %lu ms\r\n",
+                     (unsigned long)(stageUs[BOOT_FIRST_FRAME] / 1000U),
+                     (unsigned long)(stageUs[BOOT_READY] / 1000U));
+    }
+}
@@ -0,0 +1,137 @@
+// Created by: Marcin Dziedzic
+// button.c
+
+#include "button.h"
+
+/* ----------------------------------------------------------------------------
+   Debouncing przycisku enkodera (próbkowanie 1 kHz w przerwaniu SysTick):
+   - integrator 0..BUTTON_INTEGRATOR_MAX: każda próbka "wciśnięty" +1, inaczej -1,
+     stan zmienia się dopiero na końcach zakresu (histereza),
+   - zdarzenia trafiają do kolejki (jeden producent – przerwanie,
+     jeden konsument – pętla główna), razem ze znacznikiem czasu,
+   - wszystkie porównania czasu jako różnice (poprawne po przepełnieniu ticka).
+   -----------------------------------------------------------------------------*/
+
+static GPIO_TypeDef *btnPort = NULL;
+static uint16_t      btnPin;
+
+static uint8_t  btnIntegrator = 0;
+static bool     btnDown       = false;
+static bool     btnLongSent   = false;
+static uint32_t btnDownMs     = 0;   // chwila ostatniego wciśnięcia
+static uint32_t btnUpMs       = 0;   // chwila ostatniego puszczenia
+static uint32_t btnRepeatMs   = 0;   // chwila ostatniego LONG/REPEAT
+static bool     btnWasShort   = false; // poprzednie wciśnięcie było krótkie (kandydat na DOUBLE)
+
+static ButtonEvent_t     btnQueue[BUTTON_QUEUE_LEN];
+static volatile uint8_t  btnHead = 0;   // zapis (przerwanie)
+static volatile uint8_t  btnTail = 0;   // odczyt (pętla główna)
+static volatile uint32_t btnDropped = 0;
+
+/**
+ * @brief Wstawienie zdarzenia do kolejki (kontekst przerwania).
+ */
+static void Button_Push(ButtonEventType_e type, uint32_t now)
+{
+    uint8_t next = (uint8_t)((btnHead + 1U) & (BUTTON_QUEUE_LEN - 1U));
+    if (next == btnTail)
+    {
+        btnDropped++;
+        return;
+    }
+    btnQueue[btnHead].type   = (uint8_t)type;
+    btnQueue[btnHead].timeMs = now;
+    btnHead = next;
+}
+
+void Button_Init(GPIO_TypeDef *port, uint16_t pin)
+{
+    btnPort = port;
+    btnPin  = pin;
+
+    btnIntegrator = 0;
+    btnDown       = false;
+    btnLongSent   = false;
+    btnWasShort   = false;
+    btnTail       = btnHead;
+}
+
+void Button_Tick(void)
+{
+    if (btnPort == NULL)
+    {
+        return;
+    }
+
+    uint32_t now = HAL_GetTick();
+    bool raw = (HAL_GPIO_ReadPin(btnPort, btnPin) == GPIO_PIN_RESET);
+
+    // Integrator z nasyceniem
+    if (raw)
+    {
+        if (btnIntegrator < BUTTON_INTEGRATOR_MAX) btnIntegrator++;
+    }
+    else
+    {
+        if (btnIntegrator > 0U) btnIntegrator--;
+    }
+
+    if (!btnDown && (btnIntegrator == BUTTON_INTEGRATOR_MAX))
+    {
+        btnDown     = true;
+        btnLongSent = false;
+        btnDownMs   = now;
+        Button_Push(BTN_EVT_PRESS, now);
+
+        if (btnWasShort && ((now - btnUpMs) <= BUTTON_DOUBLE_MS))
+        {
+            Button_Push(BTN_EVT_DOUBLE, now);
+            btnWasShort = false;   // trzecie wciśnięcie nie jest kolejnym DOUBLE
+        }
+    }
+    else if (btnDown && (btnIntegrator == 0U))
+    {
+        btnDown     = false;
+        btnUpMs     = now;
+        btnWasShort = !btnLongSent;
+        Button_Push(BTN_EVT_RELEASE, now);
+    }
+    else if (btnDown)
+    {
+        if (!btnLongSent)
+        {
+            if ((now - btnDownMs) >= BUTTON_LONG_MS)
+            {
+                btnLongSent = true;
+                btnRepeatMs = now;
+                Button_Push(BTN_EVT_LONG, now);
+            }
+        }
+        else if ((now - btnRepeatMs) >= BUTTON_REPEAT_MS)
+        {
+            btnRepeatMs = now;
+            Button_Push(BTN_EVT_REPEAT, now);
+        }
+    }
+}
+
+bool Button_GetEvent(ButtonEvent_t *evt)
+{
+    if (btnTail == btnHead)
+    {
+        return false;
+    }
+    *evt = btnQueue[btnTail];
+    btnTail = (uint8_t)((btnTail + 1U) & (BUTTON_QUEUE_LEN - 1U));
+    return true;
+}
+
+bool Button_IsDown(void)
+{
+    return btnDown;
+}
+
+uint32_t Button_GetDropped(void)
+{
+    return btnDropped;
+}
@@ -0,0 +1,113 @@
+// Created by: Marcin Dziedzic
+// calendar.c
+
+#include "calendar.h"
+
+/* ----------------------------------------------------------------------------
+   Tablica dni skumulowanych (rok zwykły): dni przed początkiem miesiąca.
+   Rok przestępny dodaje jeden dzień od marca. 2000..2099 to 25 pełnych
+   cykli 4-letnich po 1461 dni, każdy zaczyna się rokiem przestępnym –
+   stąd przeliczenia w obie strony bez pętli po latach.
+   -----------------------------------------------------------------------------*/
+
+static const uint16_t cumDays[13] = {
+    0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334, 365
+};
+
+#define CAL_DAYS_PER_CYCLE   1461U   // 366 + 3 * 365
+#define CAL_EPOCH_WEEKDAY    6U      // 2000-01-01 = sobota
+
+/**
+ * @brief Dni przed początkiem miesiąca (0..11) w danym roku.
+ */
+static uint16_t Cal_DaysBeforeMonth(uint8_t year, uint8_t monthIdx)
+{
+    return (uint16_t)(cumDays[monthIdx] + (((monthIdx >= 2U) && Cal_IsLeap(year)) ? 1U : 0U));
+}
+
+bool Cal_IsLeap(uint8_t year)
+{
+    return (year & 0x03U) == 0U;
+}
+
+uint8_t Cal_DaysInMonth(uint8_t year, uint8_t month)
+{
+    if ((month < 1U) || (month > 12U))
+    {
+        return 0U;
+    }
+    return (uint8_t)(Cal_DaysBeforeMonth(year, month) - Cal_DaysBeforeMonth(year, month - 1U));
+}
+
+uint16_t Cal_DayNumber(uint8_t year, uint8_t month, uint8_t day)
+{
+    // Dni lat poprzednich: 365 na rok + jeden za każdy wcześniejszy rok przestępny (0, 4, 8, ...)
+    uint16_t days = (uint16_t)(year * 365U + (year + 3U) / 4U);
+    return (uint16_t)(days + Cal_DaysBeforeMonth(year, month - 1U) + (day - 1U));
+}
+
+uint8_t Cal_Weekday(uint8_t year, uint8_t month, uint8_t day)
+{
+    return (uint8_t)((Cal_DayNumber(year, month, day) + CAL_EPOCH_WEEKDAY) % 7U);
+}
+
+uint32_t Cal_ToEpoch(const RTC_TimeTypeDef *t)
+{
+    return (uint32_t)Cal_DayNumber(t->year, t->month, t->day) * CAL_SECONDS_PER_DAY +
+           (uint32_t)t->hours * 3600U + (uint32_t)t->minutes * 60U + t->seconds;
+}
+
+void Cal_FromEpoch(uint32_t epoch, RTC_TimeTypeDef *t)
+{
+    uint32_t days = epoch / CAL_SECONDS_PER_DAY;
+    uint32_t secs = epoch % CAL_SECONDS_PER_DAY;
+
+    t->hours   = (uint8_t)(secs / 3600U);
+    t->minutes = (uint8_t)((secs / 60U) % 60U);
+    t->seconds = (uint8_t)(secs % 60U);
+    t->weekday = (uint8_t)((days + CAL_EPOCH_WEEKDAY) % 7U);
+
+    // Cykl 4-letni: rok przestępny (366 dni) i trzy zwykłe
+    uint32_t cycle = days / CAL_DAYS_PER_CYCLE;
+    uint32_t doy   = days % CAL_DAYS_PER_CYCLE;
+    uint32_t yic   = 0;
+    if (doy >= 366U)
+    {
+        yic = (doy - 1U) / 365U;
+        doy = (doy - 1U) % 365U;
+    }
+    t->year = (uint8_t)(cycle * 4U + yic);
+
+    // Miesiąc: doy/32 jest równe numerowi miesiąca albo o jeden mniejsze – jedna poprawka
+    uint8_t m = (uint8_t)(doy >> 5);
+    if (doy >= Cal_DaysBeforeMonth(t->year, m + 1U))
+    {
+        m++;
+    }
+    t->month = (uint8_t)(m + 1U);
+    t->day   = (uint8_t)(doy - Cal_DaysBeforeMonth(t->year, m) + 1U);
+}
+
+bool Cal_IsValid(const RTC_TimeTypeDef *t)
+{
+    return (t->year <= CAL_YEAR_MAX) &&
+           (t->month >= 1U) && (t->month <= 12U) &&
+           (t->day >= 1U) && (t->day <= Cal_DaysInMonth(t->year, t->month)) &&
+           (t->hours <= 23U) && (t->minutes <= 59U) && (t->seconds <= 59U);
+}
+
+void Cal_Clamp(RTC_TimeTypeDef *t)
+{
+    if (t->year > CAL_YEAR_MAX) t->year = CAL_YEAR_MAX;
+    if (t->month < 1U)          t->month = 1U;
+    if (t->month > 12U)         t->month = 12U;
+    if (t->hours > 23U)         t->hours = 23U;
+    if (t->minutes > 59U)       t->minutes = 59U;
+    if (t->seconds > 59U)       t->seconds = 59U;
+
+    uint8_t dim = Cal_DaysInMonth(t->year, t->month);
+    if (t->day < 1U)  t->day = 1U;
+    if (t->day > dim) t->day = dim;
+
+    t->weekday = Cal_Weekday(t->year, t->month, t->day);
+}
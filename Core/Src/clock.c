@@ -0,0 +1,63 @@
+// Created by: Marcin Dziedzic
+// clock.c
+
+#include "clock.h"
+#include "trace.h"
+
+/* ----------------------------------------------------------------------------
+   PCF85063 nie ma podłączonego wyjścia CLKOUT, więc granicę sekundy wykrywamy
+   programowo: po zaobserwowaniu zmiany następna wypada ~1000 ms później.
+   Dopiero CLOCK_GUARD_MS przed nią zaczynamy czytać rejestr sekund.
+   -----------------------------------------------------------------------------*/
+
+static RTC_TimeTypeDef cache;
+static uint32_t edgeMs = 0;      // HAL_GetTick() w chwili wykrycia ostatniej zmiany sekundy
+static bool     synced = false;  // czy edgeMs jest znane
+
+/**
+ * @brief Pełny odczyt czasu na start.
+ */
+void Clock_Init(void)
+{
+    RTC_ReadTime(&cache);
+    synced = false;
+}
+
+/**
+ * @brief Śledzenie granicy sekundy RTC.
+ */
+bool Clock_Poll(uint32_t now)
+{
+    // Daleko od przewidywanej zmiany – bez ruchu na I2C
+    if (synced && ((now - edgeMs) < (1000U - CLOCK_GUARD_MS)))
+    {
+        return false;
+    }
+
+    uint8_t sec;
+    if (!RTC_ReadSeconds(&sec) || (sec == cache.seconds))
+    {
+        return false;
+    }
+
+    // Nowa sekunda – reszta pól mogła się zmienić razem z nią
+    RTC_ReadTime(&cache);
+    edgeMs = now;
+    synced = true;
+    TRACE(TRACE_EVT_SECOND, cache.seconds);
+    return true;
+}
+
+/**
+ * @brief Po zapisie czasu do RTC granica sekundy się przesuwa – szukamy jej od nowa.
+ */
+void Clock_Resync(void)
+{
+    RTC_ReadTime(&cache);
+    synced = false;
+}
+
+const RTC_TimeTypeDef *Clock_Now(void)
+{
+    return &cache;
+}
@@ -0,0 +1,165 @@
+// Created by: Marcin Dziedzic
+// dimmer.c
+
+#include "dimmer.h"
+#include "envelope.h"
+
+/* ----------------------------------------------------------------------------
+   Ściemniacz sterowany enkoderem:
+   - pozycja w skali jasności postrzeganej (CIE L*), więc każdy klik to podobna
+     zmiana "na oko" – także przy bardzo małej jasności,
+   - krok rośnie z prędkością obrotu (ząbki na sekundę),
+   - poziom liczony i wpisywany do CCR w przerwaniu: capture TIM1 łapie tylko
+     zbocza narastające A i B (2 z 4 zliczeń ząbka, BOTHEDGE nie działa w F1),
+     resztę ząbka domyka SysTick – najpóźniej po 1 ms od ostatniego zbocza.
+   -----------------------------------------------------------------------------*/
+
+static TIM_HandleTypeDef *dimEnc   = NULL;
+static TIM_HandleTypeDef *dimPwm   = NULL;
+static uint32_t           dimChannel;
+static uint8_t            dimCountsPerDetent = REENCODER_COUNTS_PER_DETENT;
+
+static volatile bool    dimActive  = false;
+static volatile uint8_t dimPos     = 0;
+static int16_t          dimLastCnt = 0;   // ostatnio odczytany licznik TIM1
+static int16_t          dimResidue = 0;   // zliczenia poniżej pełnego ząbka
+static REncoder_AccelTypeDef dimAccel;  // prędkość obrotu (tylko w przerwaniu)
+
+// Stan wyżej zmieniają tylko przerwania TIM1_CC i SysTick – oba mają priorytet 0,
+// więc nie wywłaszczają się nawzajem
+
+/**
+ * @brief Pozycja (L*, 0..100) -> luminancja względna Q16 (wzór CIE 1976).
+ */
+uint16_t Dimmer_PosToLevel(uint8_t pos)
+{
+    if (pos >= DIMMER_POS_MAX)
+    {
+        return ENV_LEVEL_MAX;
+    }
+    if (pos <= 8U)
+    {
+        // Odcinek liniowy: Y = L* / 903.3
+        return (uint16_t)(((uint32_t)pos * ENV_LEVEL_MAX * 10U) / 9033U);
+    }
+
+    // Y = ((L* + 16) / 116)^3
+    uint64_t t = (uint64_t)pos + 16U;
+    return (uint16_t)((t * t * t * ENV_LEVEL_MAX) / (116ULL * 116ULL * 116ULL));
+}
+
+/**
+ * @brief Najbliższa pozycja dla zadanego poziomu (wywoływane tylko przy wejściu).
+ */
+static uint8_t Dimmer_LevelToPos(uint16_t level)
+{
+    uint8_t pos = 0;
+    while ((pos < DIMMER_POS_MAX) && (Dimmer_PosToLevel(pos + 1U) <= level))
+    {
+        pos++;
+    }
+    if ((pos < DIMMER_POS_MAX) &&
+        ((Dimmer_PosToLevel(pos + 1U) - level) < (level - Dimmer_PosToLevel(pos))))
+    {
+        pos++;
+    }
+    return pos;
+}
+
+void Dimmer_Enter(REncoder_HandleTypeDef *henc, TIM_HandleTypeDef *htimPwm, uint32_t channel)
+{
+    TIM_HandleTypeDef *htimEnc = henc->htim;
+
+    dimEnc     = htimEnc;
+    dimCountsPerDetent = henc->counts_per_detent;
+    dimPwm     = htimPwm;
+    dimChannel = channel;
+
+    dimPos     = Dimmer_LevelToPos(
+                     Envelope_CompareToLevel(htimPwm, __HAL_TIM_GET_COMPARE(htimPwm, channel)));
+    dimLastCnt = (int16_t)__HAL_TIM_GET_COUNTER(htimEnc);
+    dimResidue = 0;
+    dimAccel.speed   = 0;
+    dimAccel.last_ms = HAL_GetTick();
+    dimActive  = true;
+
+    // Przerwanie na każde zbocze wejść enkodera (kanały 1 i 2 w trybie capture)
+    __HAL_TIM_CLEAR_IT(htimEnc, TIM_IT_CC1 | TIM_IT_CC2);
+    __HAL_TIM_ENABLE_IT(htimEnc, TIM_IT_CC1 | TIM_IT_CC2);
+}
+
+void Dimmer_Exit(void)
+{
+    if (dimEnc != NULL)
+    {
+        __HAL_TIM_DISABLE_IT(dimEnc, TIM_IT_CC1 | TIM_IT_CC2);
+    }
+    dimActive = false;
+}
+
+bool Dimmer_IsActive(void)
+{
+    return dimActive;
+}
+
+uint8_t Dimmer_GetPosition(void)
+{
+    return dimPos;
+}
+
+/**
+ * @brief Przyrost licznika TIM1 od ostatniego odczytu -> pełne ząbki -> CCR lampy.
+ */
+static void Dimmer_Update(void)
+{
+    int16_t cnt = (int16_t)__HAL_TIM_GET_COUNTER(dimEnc);
+    if (cnt == dimLastCnt)
+    {
+        return;
+    }
+    dimResidue += (int16_t)(cnt - dimLastCnt);
+    dimLastCnt  = cnt;
+
+    int16_t detents = dimResidue / dimCountsPerDetent;
+    if (detents == 0)
+    {
+        return;
+    }
+    dimResidue -= (int16_t)(detents * dimCountsPerDetent);
+
+    // Obwiednia (np. alarm) ma pierwszeństwo – pozycji nie ruszamy
+    if (Envelope_IsActive(dimChannel))
+    {
+        return;
+    }
+
+    // Krok rośnie z prędkością obrotu (ten sam estymator co w polach edycji menu)
+    int32_t pos = (int32_t)dimPos +
+                  REncoder_Accelerate(&dimAccel, detents, HAL_GetTick(), DIMMER_STEP_MAX);
+    if (pos < 0) pos = 0;
+    if (pos > (int32_t)DIMMER_POS_MAX) pos = DIMMER_POS_MAX;
+
+    if ((uint8_t)pos != dimPos)
+    {
+        dimPos = (uint8_t)pos;
+        // CCR ma preload – nowa wartość wchodzi od najbliższego okresu PWM
+        __HAL_TIM_SET_COMPARE(dimPwm, dimChannel,
+                              Envelope_LevelToCompare(dimPwm, Dimmer_PosToLevel(dimPos)));
+    }
+}
+
+void Dimmer_EncoderEdge(TIM_HandleTypeDef *htim)
+{
+    if (dimActive && (htim == dimEnc))
+    {
+        Dimmer_Update();
+    }
+}
+
+void Dimmer_Tick(void)
+{
+    if (dimActive)
+    {
+        Dimmer_Update();
+    }
+}
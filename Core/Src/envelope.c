@@ -0,0 +1,314 @@
+// Created by: Marcin Dziedzic
+// envelope.c
+
+#include "envelope.h"
+#include "trace.h"
+
+/* ----------------------------------------------------------------------------
+   Gotowe obwiednie (tabele we flashu).
+   -----------------------------------------------------------------------------*/
+
+// Świt: 30 min łagodnego rozjaśniania, 5 min pełnej jasności, potem błyski
+// (pętla od klatki 2: 400 ms pełnej jasności / 400 ms przygaszenia).
+static const EnvKeyframe_t dawnFrames[] = {
+    { 0,                  0,                 ENV_CURVE_LINEAR  },
+    { ENV_MIN(30),        ENV_LEVEL_MAX,     ENV_CURVE_EASE_IN },
+    { ENV_MIN(35),        ENV_LEVEL_MAX,     ENV_CURVE_LINEAR  },
+    { ENV_MIN(35) + 400,  ENV_LEVEL_PCT(10), ENV_CURVE_STEP    },
+    { ENV_MIN(35) + 800,  ENV_LEVEL_MAX,     ENV_CURVE_STEP    },
+};
+
+// Oddychanie: 1.5 s rozjaśniania, 1.5 s przygaszania, w kółko.
+static const EnvKeyframe_t breathFrames[] = {
+    { 0,     0,             ENV_CURVE_LINEAR },
+    { 1500,  ENV_LEVEL_MAX, ENV_CURVE_SMOOTH },
+    { 3000,  0,             ENV_CURVE_SMOOTH },
+};
+
+// Wygaszanie na noc: szybciej na początku, bardzo powoli przy końcu.
+static const EnvKeyframe_t nightFrames[] = {
+    { 0,           ENV_LEVEL_MAX, ENV_CURVE_LINEAR   },
+    { ENV_MIN(20), 0,             ENV_CURVE_EASE_OUT },
+};
+
+const Envelope_t ENV_DAWN   = { dawnFrames,   sizeof(dawnFrames)   / sizeof(dawnFrames[0]),   2 };
+const Envelope_t ENV_BREATH = { breathFrames, sizeof(breathFrames) / sizeof(breathFrames[0]), 0 };
+const Envelope_t ENV_NIGHT  = { nightFrames,  sizeof(nightFrames)  / sizeof(nightFrames[0]),  ENV_NO_LOOP };
+
+/* ----------------------------------------------------------------------------
+   Stan odtwarzaczy – po jednym na kanał (TIM_CHANNEL_x >> 2 = 0..3).
+   -----------------------------------------------------------------------------*/
+static EnvPlayer_t players[ENV_MAX_PLAYERS];
+
+static EnvPlayer_t *Envelope_Player(uint32_t channel)
+{
+    return &players[(channel >> 2) & (ENV_MAX_PLAYERS - 1U)];
+}
+
+/**
+ * @brief Przelicza odwrotność długości odcinka (stała Q32) dla bieżącego segmentu.
+ */
+static void Envelope_LoadSegment(EnvPlayer_t *p)
+{
+    const EnvKeyframe_t *f = p->env->frames;
+    uint32_t duration = f[p->segment].timeMs - f[p->segment - 1].timeMs;
+
+    // Dzielenie tylko raz na odcinek – w przerwaniu zostaje samo mnożenie
+    p->segRecip = (duration != 0U) ? (0xFFFFFFFFUL / duration) : 0U;
+}
+
+/**
+ * @brief Kształtowanie postępu t (Q16, 0..65535) wg krzywej.
+ */
+static uint32_t Envelope_Shape(uint8_t curve, uint32_t t)
+{
+    uint64_t t2;
+
+    switch (curve)
+    {
+    case ENV_CURVE_EASE_IN:
+        return (uint32_t)(((uint64_t)t * t) >> 16);
+
+    case ENV_CURVE_EASE_OUT:
+    {
+        uint64_t inv = 65536U - t;
+        return 65536U - (uint32_t)((inv * inv) >> 16);
+    }
+
+    case ENV_CURVE_SMOOTH:
+        t2 = ((uint64_t)t * t) >> 16;
+        return (uint32_t)((t2 * (3U * 65536U - 2U * t)) >> 16);
+
+    case ENV_CURVE_STEP:
+        return 0U;
+
+    case ENV_CURVE_LINEAR:
+    default:
+        return t;
+    }
+}
+
+/**
+ * @brief Wystawia poziom na wyjście PWM (tylko przy zmianie).
+ */
+static void Envelope_Output(EnvPlayer_t *p, uint16_t level)
+{
+    if (level != p->level)
+    {
+        p->level = level;
+        __HAL_TIM_SET_COMPARE(p->htim, p->channel, Envelope_LevelToCompare(p->htim, level));
+        TRACE(TRACE_EVT_FADE_STEP, level >> 5);
+    }
+}
+
+/**
+ * @brief Pojedynczy krok odtwarzacza (kontekst przerwania).
+ */
+static void Envelope_Step(EnvPlayer_t *p)
+{
+    const Envelope_t *env = p->env;
+    const EnvKeyframe_t *f = env->frames;
+
+    // Postęp czasu z dokładnością do µs (bez dryfu – okres timera jest stały)
+    p->fracUs += ENV_TICK_US;
+    while (p->fracUs >= 1000U)
+    {
+        p->fracUs -= 1000U;
+        p->elapsedMs++;
+    }
+
+    // Przejście do kolejnych odcinków (może przeskoczyć kilka krótkich klatek)
+    while (p->elapsedMs >= f[p->segment].timeMs)
+    {
+        p->segment++;
+        if (p->segment >= env->count)
+        {
+            if (env->loopFrom == ENV_NO_LOOP)
+            {
+                Envelope_Output(p, f[env->count - 1U].level);
+                p->isActive = false;
+                return;
+            }
+            p->elapsedMs -= f[env->count - 1U].timeMs - f[env->loopFrom].timeMs;
+            p->segment = env->loopFrom + 1U;
+            p->firstPass = false;
+        }
+        Envelope_LoadSegment(p);
+    }
+
+    // Interpolacja stałoprzecinkowa w obrębie odcinka
+    const EnvKeyframe_t *from = &f[p->segment - 1U];
+    const EnvKeyframe_t *to   = &f[p->segment];
+    uint32_t pos = p->elapsedMs - from->timeMs;
+    uint32_t t   = (uint32_t)(((uint64_t)pos * p->segRecip) >> 16);
+    uint32_t k   = Envelope_Shape(to->curve, t);
+
+    // Pierwszy odcinek zaczyna się od jasności zastanej w chwili startu
+    int32_t fromLevel = (p->firstPass && p->segment == 1U) ? p->originLevel : from->level;
+    int32_t delta = (int32_t)to->level - fromLevel;
+    int32_t level = fromLevel + (int32_t)(((int64_t)delta * k) >> 16);
+
+    Envelope_Output(p, (uint16_t)level);
+}
+
+/**
+ * @brief Inicjalizacja – przerwanie update TIM3 taktuje wszystkie odtwarzacze.
+ */
+void Envelope_Init(TIM_HandleTypeDef *htim)
+{
+    for (uint8_t i = 0; i < ENV_MAX_PLAYERS; i++)
+    {
+        players[i].isActive = false;
+    }
+
+    __HAL_TIM_CLEAR_IT(htim, TIM_IT_UPDATE);
+    __HAL_TIM_ENABLE_IT(htim, TIM_IT_UPDATE);
+}
+
+/**
+ * @brief Start obwiedni na kanale – od bieżącego poziomu wyjścia.
+ */
+void Envelope_Play(TIM_HandleTypeDef *htim, uint32_t channel, const Envelope_t *env)
+{
+    EnvPlayer_t *p = Envelope_Player(channel);
+
+    // Najpierw wyłączamy odtwarzacz, żeby przerwanie nie widziało połowicznego stanu
+    p->isActive = false;
+
+    p->htim      = htim;
+    p->channel   = channel;
+    p->env       = env;
+    p->segment   = 1;
+    p->elapsedMs = 0;
+    p->fracUs    = 0;
+    p->firstPass = true;
+    p->originLevel = Envelope_CompareToLevel(htim, __HAL_TIM_GET_COMPARE(htim, channel));
+    p->level     = p->originLevel;
+    Envelope_LoadSegment(p);
+
+    HAL_TIM_PWM_Start(htim, channel);
+
+    p->isActive = true;
+}
+
+/**
+ * @brief Przesunięcie trwającej obwiedni do chwili elapsedMs (wznowienie po resecie).
+ *        Czas poza końcem obwiedni zawija się w obrębie pętli.
+ */
+void Envelope_Seek(uint32_t channel, uint32_t elapsedMs)
+{
+    EnvPlayer_t *p = Envelope_Player(channel);
+    const Envelope_t *env = p->env;
+    const EnvKeyframe_t *f;
+    uint32_t last;
+
+    if (env == NULL)
+    {
+        return;
+    }
+    f    = env->frames;
+    last = f[env->count - 1U].timeMs;
+
+    p->isActive = false;
+
+    if (elapsedMs >= last)
+    {
+        if (env->loopFrom == ENV_NO_LOOP)
+        {
+            elapsedMs = last;   // najbliższy krok kończy obwiednię
+        }
+        else
+        {
+            uint32_t loopStart = f[env->loopFrom].timeMs;
+            elapsedMs = loopStart + ((elapsedMs - loopStart) % (last - loopStart));
+            p->firstPass = false;
+        }
+    }
+
+    p->segment = 1;
+    while ((p->segment < (env->count - 1U)) && (elapsedMs >= f[p->segment].timeMs))
+    {
+        p->segment++;
+    }
+    if (p->segment > 1U)
+    {
+        p->firstPass = false;
+    }
+
+    p->elapsedMs = elapsedMs;
+    p->fracUs    = 0;
+    Envelope_LoadSegment(p);
+
+    p->isActive = true;
+}
+
+/**
+ * @brief Odtwarzana obwiednia (NULL, jeśli kanał nie jest sterowany obwiednią).
+ */
+const Envelope_t *Envelope_Current(uint32_t channel)
+{
+    EnvPlayer_t *p = Envelope_Player(channel);
+    return p->isActive ? p->env : NULL;
+}
+
+/**
+ * @brief Czas od startu obwiedni (ms, po zawinięciu pętli).
+ */
+uint32_t Envelope_GetElapsedMs(uint32_t channel)
+{
+    return Envelope_Player(channel)->elapsedMs;
+}
+
+/**
+ * @brief Zatrzymanie obwiedni – poziom wyjścia pozostaje bez zmian.
+ */
+void Envelope_Stop(uint32_t channel)
+{
+    Envelope_Player(channel)->isActive = false;
+}
+
+/**
+ * @brief Czy kanał jest sterowany przez obwiednię?
+ */
+bool Envelope_IsActive(uint32_t channel)
+{
+    return Envelope_Player(channel)->isActive;
+}
+
+/**
+ * @brief Poziom jasności -> CCR (wyjście odwrócone: ARR = zgaszona, 0 = pełna jasność).
+ */
+uint32_t Envelope_LevelToCompare(TIM_HandleTypeDef *htim, uint16_t level)
+{
+    uint32_t arr = __HAL_TIM_GET_AUTORELOAD(htim);
+    return arr - (((uint32_t)level * (arr + 1U)) >> 16);
+}
+
+/**
+ * @brief CCR -> poziom jasności (zaokrąglenie w górę, żeby LevelToCompare było odwracalne).
+ */
+uint16_t Envelope_CompareToLevel(TIM_HandleTypeDef *htim, uint32_t compare)
+{
+    uint32_t arr = __HAL_TIM_GET_AUTORELOAD(htim);
+    if (compare >= arr)
+    {
+        return 0U;
+    }
+    uint32_t level = (((arr - compare) << 16) + arr) / (arr + 1U);
+    return (level > ENV_LEVEL_MAX) ? ENV_LEVEL_MAX : (uint16_t)level;
+}
+
+/**
+ * @brief Wywoływane z HAL_TIM_PeriodElapsedCallback dla TIM3.
+ */
+void Envelope_TimerTick(TIM_HandleTypeDef *htim)
+{
+    for (uint8_t i = 0; i < ENV_MAX_PLAYERS; i++)
+    {
+        EnvPlayer_t *p = &players[i];
+        if (p->isActive && (p->htim == htim))
+        {
+            Envelope_Step(p);
+        }
+    }
+}
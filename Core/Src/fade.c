@@ -2,10 +2,26 @@
 // fade.c
 
 #include "fade.h"
+#include "envelope.h"
+#include "trace.h"
 #include "stm32f1xx_hal.h"
 
+/**
+ * @brief Wystawienie poziomu jasności na wyjście PWM.
+ */
+static void LedFade_Output(LedFadeHandle_t *handle, uint16_t level)
+{
+    uint32_t ccr = Envelope_LevelToCompare(handle->htim, level);
+    if (ccr != __HAL_TIM_GET_COMPARE(handle->htim, handle->channel))
+    {
+        __HAL_TIM_SET_COMPARE(handle->htim, handle->channel, ccr);
+        TRACE(TRACE_EVT_FADE_STEP, level >> 5);
+    }
+}
+
 /**
  * @brief Funkcja wewnętrzna inicjalizująca wspólne parametry fade.
+ *        Nie zmienia wyjścia – kolejny krok startuje od bieżącej jasności.
  */
 static void LedFade_InternalInit(LedFadeHandle_t *handle,
                                  TIM_HandleTypeDef *htim,
@@ -15,39 +31,67 @@ static void LedFade_InternalInit(LedFadeHandle_t *handle,
                                  uint16_t steps,
                                  uint32_t totalTimeMs)
 {
+    // Kanał przejmuje fade – ewentualna obwiednia przestaje sterować wyjściem
+    // (przed zmianą pól, żeby przerwanie TIM3 nie pisało już do CCR)
+    Envelope_Stop(channel);
+
     handle->htim       = htim;
     handle->channel    = channel;
     handle->mode       = mode;
     handle->direction  = direction;
     handle->steps      = steps;
     handle->currentStep= 0;
-    handle->isActive   = true;
 
     // Odczyt wartości AutoReload (ARR)
     handle->arr = __HAL_TIM_GET_AUTORELOAD(htim);
 
-    // Czas pomiędzy kolejnymi krokami
-    handle->stepInterval = (totalTimeMs / steps);
-    handle->lastTime     = HAL_GetTick();
+    // Postęp liczony od chwili startu (µs), a nie od ostatniego kroku
+    if (totalTimeMs > LEDFADE_TIME_MAX_MS)
+    {
+        totalTimeMs = LEDFADE_TIME_MAX_MS;   // 2 * durationUs (okres PULSE) mieści się w 32 bitach
+    }
+    handle->durationUs = (totalTimeMs > 0U) ? (totalTimeMs * 1000U) : 1U;
+    handle->startUs    = LedFade_NowUs();
 
     // Uruchomienie PWM (o ile nie jest włączone)
     HAL_TIM_PWM_Start(htim, channel);
 
-    // Wartość początkowa CCR w zależności od kierunku
-    if (direction == FADE_IN)
-    {
-        // FADE_IN => start: CCR = ARR (wyłączona), dojdziemy do 0 (jasno)
-        __HAL_TIM_SET_COMPARE(htim, channel, handle->arr);
-    }
-    else
-    {
-        // FADE_OUT => start: CCR = 0, pójdziemy do ARR (zgaszenie)
-        __HAL_TIM_SET_COMPARE(htim, channel, 0);
-    }
+    handle->isActive   = true;
+}
+
+/**
+ * @brief Przypisanie kanału i zgaszenie lampy (CCR = ARR).
+ */
+void LedFade_Init(LedFadeHandle_t *handle,
+                  TIM_HandleTypeDef *htim,
+                  uint32_t channel)
+{
+    Envelope_Stop(channel);
+
+    handle->htim     = htim;
+    handle->channel  = channel;
+    handle->arr      = __HAL_TIM_GET_AUTORELOAD(htim);
+    handle->mode     = FADE_MODE_SINGLE;
+    handle->isActive = false;
+    handle->fromLevel = 0;
+    handle->toLevel   = 0;
+
+    LedFade_Output(handle, 0);
+    HAL_TIM_PWM_Start(htim, channel);
+}
+
+/**
+ * @brief Bieżąca jasność – odczyt z rejestru CCR (niezależnie od tego, kto go ustawił).
+ */
+uint16_t LedFade_GetLevel(const LedFadeHandle_t *handle)
+{
+    return Envelope_CompareToLevel(handle->htim,
+                                   __HAL_TIM_GET_COMPARE(handle->htim, handle->channel));
 }
 
 /**
  * @brief Rozpoczęcie pojedynczego rozjaśniania/przygaszania (FADE_MODE_SINGLE).
+ *        totalTimeMs to czas pełnej rampy 0% <-> 100%; z połowy drogi trwa połowę.
  */
 void LedFade_Start(LedFadeHandle_t *handle,
                    TIM_HandleTypeDef *htim,
@@ -56,17 +100,28 @@ void LedFade_Start(LedFadeHandle_t *handle,
                    uint16_t steps,
                    uint32_t totalTimeMs)
 {
+    handle->htim    = htim;
+    handle->channel = channel;
+
+    uint16_t from = LedFade_GetLevel(handle);
+    uint16_t to   = (direction == FADE_IN) ? LEDFADE_LEVEL_MAX : 0U;
+    uint32_t dist = (to > from) ? (uint32_t)(to - from) : (uint32_t)(from - to);
+
     LedFade_InternalInit(handle,
                          htim,
                          channel,
                          FADE_MODE_SINGLE,
                          direction,
                          steps,
-                         totalTimeMs);
+                         (uint32_t)(((uint64_t)totalTimeMs * dist) / LEDFADE_LEVEL_MAX));
+
+    handle->fromLevel = from;
+    handle->toLevel   = to;
 }
 
 /**
  * @brief Uruchamia tryb pulsowania: FADE_IN (ARR->0) i FADE_OUT (0->ARR) w kółko.
+ *        Start w fazie rozjaśniania odpowiadającej bieżącej jasności.
  */
 void LedFade_PulseStart(LedFadeHandle_t *handle,
                         TIM_HandleTypeDef *htim,
@@ -74,6 +129,11 @@ void LedFade_PulseStart(LedFadeHandle_t *handle,
                         uint16_t steps,
                         uint32_t totalTimeMs)
 {
+    handle->htim    = htim;
+    handle->channel = channel;
+
+    uint16_t from = LedFade_GetLevel(handle);
+
     LedFade_InternalInit(handle,
                          htim,
                          channel,
@@ -81,83 +141,156 @@ void LedFade_PulseStart(LedFadeHandle_t *handle,
                          FADE_IN,     // startujemy od rozjaśniania
                          steps,
                          totalTimeMs);
+
+    // Cofamy początek cyklu tak, by faza FADE_IN zaczynała się od bieżącej jasności
+    handle->startUs -= (uint32_t)(((uint64_t)handle->durationUs * from) / LEDFADE_LEVEL_MAX);
 }
 
 /**
- * @brief Funkcja wywoływana cyklicznie (np. w pętli). Realizuje kolejne kroki fade.
- * @return true, jeśli właśnie zakończono FADE_MODE_SINGLE, w przeciwnym razie false.
+ * @brief Płynne przejście od bieżącej jasności do zadanego poziomu.
  */
-bool LedFade_Process(LedFadeHandle_t *handle)
+void LedFade_RetargetTo(LedFadeHandle_t *handle, uint16_t level, uint32_t durationMs)
 {
-    if (!handle->isActive)
+    uint16_t from = LedFade_GetLevel(handle);
+
+    LedFade_InternalInit(handle,
+                         handle->htim,
+                         handle->channel,
+                         FADE_MODE_SINGLE,
+                         (level >= from) ? FADE_IN : FADE_OUT,
+                         0,           // pełna rozdzielczość
+                         durationMs);
+
+    handle->fromLevel = from;
+    handle->toLevel   = level;
+
+    if (durationMs == 0U)
     {
-        return false; // Nic nie robimy, fade nieaktywny
+        LedFade_Output(handle, level);
+        handle->isActive = false;
     }
+}
 
-    uint32_t now = HAL_GetTick();
+/**
+ * @brief Zwolnienie kanału – nic już nie zmienia CCR poza nowym wywołaniem.
+ */
+void LedFade_Stop(LedFadeHandle_t *handle)
+{
+    Envelope_Stop(handle->channel);
+    handle->isActive = false;
+}
+
+/**
+ * @brief Obwiednia na kanale lampy – LedFade_Process tylko śledzi jej koniec.
+ */
+void LedFade_PlayEnvelope(LedFadeHandle_t *handle, const Envelope_t *env)
+{
+    handle->mode     = FADE_MODE_ENVELOPE;
+    handle->isActive = true;
+    Envelope_Play(handle->htim, handle->channel, env);
+}
 
-    // Czy minął czas na kolejny krok?
-    if ((now - handle->lastTime) < handle->stepInterval)
+/**
+ * @brief Bieżący czas w µs: milisekundy z HAL_GetTick() uzupełnione o pozycję
+ *        licznika SysTick (zlicza w dół od LOAD do 0 w ciągu 1 ms).
+ */
+uint32_t LedFade_NowUs(void)
+{
+    uint32_t ms;
+    uint32_t val;
+
+    // Podwójny odczyt – jeśli w międzyczasie przyszedł tick, próbujemy jeszcze raz
+    do
     {
-        return false;
-    }
+        ms  = HAL_GetTick();
+        val = SysTick->VAL;
+    } while (ms != HAL_GetTick());
 
-    // Aktualizacja "ostatniego" czasu
-    handle->lastTime = now;
+    uint32_t load = SysTick->LOAD + 1U;
+    return (ms * 1000U) + (((load - 1U - val) * 1000U) / load);
+}
 
-    // Obliczamy nowy CCR
-    uint16_t newCompare = 0;
-    if (handle->direction == FADE_IN)
+/**
+ * @brief Funkcja wywoływana cyklicznie (np. w pętli). Wystawia krok wynikający
+ *        z czasu od startu cyklu – niezależnie od tego, jak często jest wołana.
+ * @return true, jeśli właśnie zakończono rampę lub obwiednię, w przeciwnym razie false.
+ */
+bool LedFade_Process(LedFadeHandle_t *handle)
+{
+    if (!handle->isActive)
     {
-        // FADE_IN: currentStep=0 => CCR=ARR; currentStep=steps => CCR=0
-        newCompare = handle->arr
-                     - (handle->currentStep * (handle->arr / handle->steps));
+        return false; // Nic nie robimy, fade nieaktywny
     }
-    else
+
+    if (handle->mode == FADE_MODE_ENVELOPE)
     {
-        // FADE_OUT: currentStep=0 => CCR=0; currentStep=steps => CCR=ARR
-        newCompare = (handle->currentStep * (handle->arr / handle->steps));
+        // Wyjściem steruje przerwanie TIM3 – sprawdzamy tylko, czy obwiednia się skończyła
+        if (!Envelope_IsActive(handle->channel))
+        {
+            handle->isActive = false;
+            return true;
+        }
+        return false;
     }
 
-    // Ustawiamy CCR
-    __HAL_TIM_SET_COMPARE(handle->htim, handle->channel, newCompare);
+    uint32_t elapsed = LedFade_NowUs() - handle->startUs;
 
-    // Następny krok
-    handle->currentStep++;
-
-    // Czy osiągnęliśmy koniec?
-    if (handle->currentStep > handle->steps)
+    if (handle->mode == FADE_MODE_SINGLE)
     {
-        // Ustaw wartość docelową (dla pewności)
-        if (handle->direction == FADE_IN)
+        // Koniec rampy – ustaw wartość docelową (dla pewności) i zakończ
+        if (elapsed >= handle->durationUs)
         {
-            __HAL_TIM_SET_COMPARE(handle->htim, handle->channel, 0);
+            LedFade_Output(handle, handle->toLevel);
+            handle->currentStep = handle->steps;
+            handle->isActive = false;
+            return true;
         }
-        else
+    }
+    else
+    {
+        // Tryb PULSE: okres = FADE_IN + FADE_OUT. Przesuwamy początek o pełne
+        // okresy, żeby różnica czasu nie przekroczyła zakresu licznika µs.
+        uint32_t period = 2U * handle->durationUs;
+        if (elapsed >= period)
         {
-            __HAL_TIM_SET_COMPARE(handle->htim, handle->channel, handle->arr);
+            uint32_t periods = elapsed / period;
+            handle->startUs += periods * period;
+            elapsed         -= periods * period;
         }
 
-        // Jeśli tryb pojedynczy -> kończymy
-        if (handle->mode == FADE_MODE_SINGLE)
+        if (elapsed < handle->durationUs)
         {
-            handle->isActive = false;
-            return true;
+            handle->direction = FADE_IN;
+            handle->fromLevel = 0;
+            handle->toLevel   = LEDFADE_LEVEL_MAX;
         }
         else
         {
-            // Tryb PULSE -> zmieniamy kierunek i zaczynamy od 0.
-            if (handle->direction == FADE_IN)
-            {
-                handle->direction = FADE_OUT;
-            }
-            else
-            {
-                handle->direction = FADE_IN;
-            }
-            handle->currentStep = 0;
+            handle->direction = FADE_OUT;
+            handle->fromLevel = LEDFADE_LEVEL_MAX;
+            handle->toLevel   = 0;
+            elapsed -= handle->durationUs;
         }
     }
 
+    // Postęp (Q16) wynikający z upływu czasu – zaległe kroki są po prostu pomijane.
+    // Przy steps > 0 postęp kwantowany jest do zadanej liczby kroków.
+    uint32_t progress;
+    if (handle->steps > 0U)
+    {
+        uint16_t step = (uint16_t)(((uint64_t)elapsed * handle->steps) / handle->durationUs);
+        handle->currentStep = step;
+        progress = ((uint32_t)step << 16) / handle->steps;
+    }
+    else
+    {
+        progress = (uint32_t)(((uint64_t)elapsed << 16) / handle->durationUs);
+    }
+
+    int32_t delta = (int32_t)handle->toLevel - (int32_t)handle->fromLevel;
+    int32_t level = (int32_t)handle->fromLevel + (int32_t)(((int64_t)delta * progress) >> 16);
+
+    LedFade_Output(handle, (uint16_t)level);
+
     return false;
 }
@@ -0,0 +1,99 @@
+// Created by: Marcin Dziedzic
+// lamp_reg.c
+
+#include "lamp_reg.h"
+#include "fade.h"
+#include "light_sen.h"
+
+/* ----------------------------------------------------------------------------
+   Regulator PI jasności lampy (stałoprzecinkowy):
+   - wejście:  przefiltrowany odczyt BH1750 (lx), co LIGHTSEN_SAMPLE_MS,
+   - wyjście:  poziom jasności 0..LEDFADE_LEVEL_MAX przez LedFade_RetargetTo,
+   - anti-windup: całkowanie warunkowe (brak całkowania "w głąb" nasycenia),
+   - ogranicznik prędkości: max LAMPREG_MAX_STEP na próbkę.
+   -----------------------------------------------------------------------------*/
+
+static bool     regEnabled  = false;
+static uint16_t regTarget   = LAMPREG_TARGET_DEFAULT;
+static int32_t  regIntegral = 0;   // część całkująca (w poziomach jasności)
+static int32_t  regOutput   = 0;   // ostatnio zadany poziom
+
+static int32_t LampReg_Clamp(int32_t v, int32_t lo, int32_t hi)
+{
+    if (v < lo) return lo;
+    if (v > hi) return hi;
+    return v;
+}
+
+void LampReg_Enable(uint16_t targetLux)
+{
+    LampReg_SetTarget(targetLux);
+
+    // Start bezuderzeniowy – całka = bieżąca jasność lampy
+    regOutput   = LedFade_GetLevel(&g_fadeHandle);
+    regIntegral = regOutput;
+    regEnabled  = true;
+}
+
+void LampReg_Disable(void)
+{
+    regEnabled = false;
+}
+
+bool LampReg_IsEnabled(void)
+{
+    return regEnabled;
+}
+
+void LampReg_SetTarget(uint16_t targetLux)
+{
+    regTarget = (uint16_t)LampReg_Clamp(targetLux, LAMPREG_TARGET_MIN, LAMPREG_TARGET_MAX);
+}
+
+uint16_t LampReg_GetTarget(void)
+{
+    return regTarget;
+}
+
+void LampReg_Update(uint16_t filteredLux)
+{
+    if (!regEnabled)
+    {
+        return;
+    }
+
+    // Obwiednia (świt / alarm) ma pierwszeństwo przed regulacją
+    if (g_fadeHandle.isActive && (g_fadeHandle.mode == FADE_MODE_ENVELOPE))
+    {
+        return;
+    }
+
+    int32_t error = (int32_t)regTarget - (int32_t)filteredLux;
+    int32_t prop  = (error * LAMPREG_KP_Q8) >> 8;
+    int32_t unsat = prop + regIntegral;
+
+    // Całkujemy tylko poza strefą nieczułości i gdy wyjście nie jest nasycone
+    // w kierunku, w którym pcha uchyb
+    if ((error > LAMPREG_DEADBAND_LX) || (error < -LAMPREG_DEADBAND_LX))
+    {
+        bool satHigh = (unsat >= (int32_t)LEDFADE_LEVEL_MAX) && (error > 0);
+        bool satLow  = (unsat <= 0) && (error < 0);
+        if (!satHigh && !satLow)
+        {
+            regIntegral += (error * LAMPREG_KI_Q8) >> 8;
+            regIntegral  = LampReg_Clamp(regIntegral, 0, LEDFADE_LEVEL_MAX);
+        }
+    }
+
+    int32_t out = LampReg_Clamp(prop + regIntegral, 0, LEDFADE_LEVEL_MAX);
+
+    // Ogranicznik prędkości zmian
+    out = LampReg_Clamp(out, regOutput - LAMPREG_MAX_STEP, regOutput + LAMPREG_MAX_STEP);
+
+    if (out != regOutput)
+    {
+        regOutput = out;
+        // Rampa na cały okres próbkowania – lampa zmienia się płynnie między próbkami
+        LedFade_RetargetTo(&g_fadeHandle, (uint16_t)out, LIGHTSEN_SAMPLE_MS);
+    }
+}
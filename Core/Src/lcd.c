@@ -2,6 +2,7 @@
 // lcd.c
 
 #include "lcd.h"
+#include "prof.h"
 
 /**
  * @brief Tabela adresów początkowych wierszy dla LCD 16-znakowego.
@@ -30,6 +31,11 @@ static void lcd_write_command(Lcd_HandleTypeDef * lcd, uint8_t command);
  */
 static void lcd_write(Lcd_HandleTypeDef * lcd, uint8_t data, uint8_t len);
 
+/**
+ * @brief Aktywne oczekiwanie w µs (licznik SysTick).
+ */
+static void lcd_delay_us(uint32_t us);
+
 
 /* ======================== Implementacje funkcji publicznych ======================== */
 
@@ -73,10 +79,21 @@ Lcd_HandleTypeDef Lcd_create(
  */
 void Lcd_init(Lcd_HandleTypeDef * lcd)
 {
+    // Sterownik LCD startuje dłużej niż MCU – czekamy tylko na resztę z 40 ms od startu
+    while (HAL_GetTick() < LCD_POWER_UP_MS)
+    {
+    }
+
     if (lcd->mode == LCD_4_BIT_MODE)
     {
-        lcd_write_command(lcd, 0x33);
-        lcd_write_command(lcd, 0x32);
+        // Reset programowy (3, 3, 3) i przejście w tryb 4-bit (2) z czasami z noty
+        HAL_GPIO_WritePin(lcd->rs_port, lcd->rs_pin, LCD_COMMAND_REG);
+        lcd_write(lcd, 0x03, LCD_NIB);
+        lcd_delay_us(LCD_RESET_US);
+        lcd_write(lcd, 0x03, LCD_NIB);
+        lcd_delay_us(LCD_RESET_US);
+        lcd_write(lcd, 0x03, LCD_NIB);
+        lcd_write(lcd, 0x02, LCD_NIB);
         lcd_write_command(lcd, FUNCTION_SET | OPT_N);  // Tryb 4-bit
     }
     else
@@ -143,10 +160,12 @@ void Lcd_printFloat(Lcd_HandleTypeDef* lcd, float value, uint8_t decimals)
  */
 void Lcd_string(Lcd_HandleTypeDef * lcd, char * string)
 {
+    PROF_BEGIN(lcd);
     for (uint8_t i = 0; i < strlen(string); i++)
     {
         lcd_write_data(lcd, string[i]);
     }
+    PROF_END(lcd, PROF_LCD_STRING);
 }
 
 /**
@@ -211,6 +230,12 @@ static void lcd_write_command(Lcd_HandleTypeDef * lcd, uint8_t command)
     {
         lcd_write(lcd, command, LCD_BYTE);
     }
+
+    // CLEAR_DISPLAY i RETURN_HOME wykonują się ~1.5 ms
+    if (command <= 0x03)
+    {
+        lcd_delay_us(LCD_CLEAR_US);
+    }
 }
 
 /**
@@ -247,6 +272,23 @@ static void lcd_write(Lcd_HandleTypeDef * lcd, uint8_t data, uint8_t len)
     }
 
     HAL_GPIO_WritePin(lcd->en_port, lcd->en_pin, 1);
-    DELAY(1);
+    lcd_delay_us(LCD_EN_PULSE_US);
     HAL_GPIO_WritePin(lcd->en_port, lcd->en_pin, 0); // Zapis danych przy opadającym zboczu
+    lcd_delay_us(LCD_EXEC_US);
+}
+
+static void lcd_delay_us(uint32_t us)
+{
+    uint32_t load    = SysTick->LOAD + 1U;               // takty na 1 ms
+    uint32_t ticks   = us * (load / 1000U);
+    uint32_t elapsed = 0;
+    uint32_t prev    = SysTick->VAL;
+
+    // SysTick liczy w dół i przeładowuje się co 1 ms
+    while (elapsed < ticks)
+    {
+        uint32_t val = SysTick->VAL;
+        elapsed += (prev >= val) ? (prev - val) : (prev + load - val);
+        prev = val;
+    }
 }
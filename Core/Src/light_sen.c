@@ -2,6 +2,18 @@
 // light_sen.c
 
 #include "light_sen.h"
+#include "prof.h"
+#include "trace.h"
+
+/**
+ * @brief Stan filtru (lx w formacie Q4) i czas ostatniej próbki.
+ */
+static uint32_t filteredLuxQ4  = 0;
+static bool     filterPrimed   = false;
+static uint32_t lastSampleTime = 0;
+static uint16_t i2cErrors      = 0;   // nieudane transakcje I2C (telemetria)
+static bool     started        = false;
+static uint32_t startTime      = 0;   // HAL_GetTick() w chwili startu pomiarów
 
 /**
  * @brief Inicjalizacja sensora BH1750.
@@ -10,7 +22,17 @@
 void LightSen_Init(I2C_HandleTypeDef *hi2c)
 {
     uint8_t cmd = 0x10; // Rozdzielczość 1 lx, czas 120 ms
-    HAL_I2C_Master_Transmit(hi2c, BH1750_ADDRESS << 1, &cmd, 1, HAL_MAX_DELAY);
+    TRACE(TRACE_EVT_I2C_START, BH1750_ADDRESS);
+    HAL_StatusTypeDef ret = HAL_I2C_Master_Transmit(hi2c, BH1750_ADDRESS << 1, &cmd, 1, LIGHTSEN_I2C_TIMEOUT_MS);
+    TRACE(TRACE_EVT_I2C_STOP, ret);
+    if (ret != HAL_OK)
+    {
+        i2cErrors++;
+    }
+
+    // Pierwszy wynik będzie gotowy po pełnym czasie pomiaru – do tego czasu Sample czeka
+    started   = true;
+    startTime = HAL_GetTick();
 }
 
 /**
@@ -23,46 +45,78 @@ uint16_t LightSen_ReadLux(I2C_HandleTypeDef *hi2c)
     uint8_t buff[2] = {0};
     uint16_t lux = 0;
 
-    // Odczyt danych z sensora
-    HAL_I2C_Master_Receive(hi2c, BH1750_ADDRESS << 1, buff, 2, HAL_MAX_DELAY);
+    PROF_BEGIN(lux);
+
+    // Odczyt danych z sensora; po błędzie zwracamy ostatnią przefiltrowaną wartość,
+    // żeby nieudany odczyt nie wyglądał jak ciemność
+    TRACE(TRACE_EVT_I2C_START, BH1750_ADDRESS);
+    HAL_StatusTypeDef ret = HAL_I2C_Master_Receive(hi2c, BH1750_ADDRESS << 1, buff, 2, LIGHTSEN_I2C_TIMEOUT_MS);
+    TRACE(TRACE_EVT_I2C_STOP, ret);
+    if (ret != HAL_OK)
+    {
+        i2cErrors++;
+        PROF_END(lux, PROF_LUX_READ);
+        return LightSen_GetFilteredLux();
+    }
 
     // Konwersja wartości do luksów
     lux = ((buff[0] << 8) | buff[1]) / 1.2;
+
+    PROF_END(lux, PROF_LUX_READ);
     return lux;
 }
 
 /**
- * @brief Wyświetlenie wartości natężenia światła na wyświetlaczu LCD.
- * @param lcd Wskaźnik do struktury obsługi LCD.
- * @param lux Wartość natężenia światła w luksach.
+ * @brief Próbkowanie co LIGHTSEN_SAMPLE_MS + filtr wykładniczy (stałoprzecinkowy).
  */
-void LightSen_DisplayLux(Lcd_HandleTypeDef *lcd, uint16_t lux)
+bool LightSen_Sample(I2C_HandleTypeDef *hi2c, uint32_t now)
 {
-    // 1) Wyczyść drugi wiersz (16 spacji)
-    Lcd_cursor(lcd, 1, 0);
-    Lcd_string(lcd, "               "); // 16 spacji = wyczyszczenie
-
-    // 2) Bufor na wartość lux (maks 5 cyfr + '\0')
-    char valStr[6];
-    sprintf(valStr, "%u", lux);
-
-    // 3) W kolumnie 0 wyświetl "Lux: "
-    Lcd_cursor(lcd, 0, 0);
-    Lcd_string(lcd, "Lux: ");
+    if (!started || ((now - startTime) < LIGHTSEN_SAMPLE_MS))
+    {
+        return false;
+    }
+    if (filterPrimed && ((now - lastSampleTime) < LIGHTSEN_SAMPLE_MS))
+    {
+        return false;
+    }
+    lastSampleTime = now;
 
-    // 4) W kolumnie 5 wyświetl zmierzoną wartość lux
-    Lcd_cursor(lcd, 0, 5);
-    Lcd_string(lcd, valStr);
+    uint32_t luxQ4 = (uint32_t)LightSen_ReadLux(hi2c) << 4;
 
-    // (Opcjonalnie) Nadpisanie spacjami, jeśli nowa liczba jest krótsza
-    int len = strlen(valStr);
-    for (int i = len; i < 5; i++)
+    if (!filterPrimed)
     {
-        Lcd_cursor(lcd, 0, 5 + i);
-        Lcd_string(lcd, " ");
+        // Pierwsza próbka inicjalizuje filtr
+        filteredLuxQ4 = luxQ4;
+        filterPrimed  = true;
     }
+    else
+    {
+        int32_t diff = (int32_t)luxQ4 - (int32_t)filteredLuxQ4;
+        filteredLuxQ4 = (uint32_t)((int32_t)filteredLuxQ4 + (diff >> LIGHTSEN_FILTER_SHIFT));
+    }
+    return true;
+}
+
+/**
+ * @brief Czy filtr ma już pierwszą próbkę?
+ */
+bool LightSen_IsReady(void)
+{
+    return filterPrimed;
+}
 
-    // 5) W kolumnie 10 zawsze wyświetl "lx"
-    Lcd_cursor(lcd, 0, 10);
-    Lcd_string(lcd, "lx");
+/**
+ * @brief Ostatnia przefiltrowana wartość (zaokrąglona do pełnych lx).
+ */
+uint16_t LightSen_GetFilteredLux(void)
+{
+    return (uint16_t)((filteredLuxQ4 + 8U) >> 4);
+}
+
+/**
+ * @brief Liczba nieudanych transakcji I2C z czujnikiem.
+ */
+uint16_t LightSen_GetErrorCount(void)
+{
+    return i2cErrors;
 }
@@ -0,0 +1,172 @@
+// Created by: Marcin Dziedzic
+// log.c
+
+#include "log.h"
+
+#ifndef LOG_DISABLE
+
+#include "uart_tx.h"
+#include "stm32f1xx_hal.h"
+#include <stdbool.h>
+
+/* ----------------------------------------------------------------------------
+   Bufor słów z wieloma producentami (pętla + przerwania) i jednym odbiorcą
+   (Log_Process w pętli). Producent rezerwuje miejsce przesuwając head przez
+   LDREX/STREX, wpisuje czas i argumenty, a nagłówek z LOG_HDR_VALID na końcu –
+   dopiero wtedy odbiorca uznaje rekord za kompletny. Przerwanie, które wejdzie
+   między rezerwację a nagłówek, dopisze się dalej; odbiorca poczeka na starszy.
+   Odbiorca zeruje przeczytane słowa, zanim przesunie tail.
+
+   Ramka na USART2: A5 4C | n (słowa) | n słów LE | CRC-32 (sprzętowy, po słowach).
+   -----------------------------------------------------------------------------*/
+
+_Static_assert((LOG_RING_WORDS & (LOG_RING_WORDS - 1U)) == 0U, "LOG_RING_WORDS: potęga dwójki");
+
+#define LOG_SYNC0            0xA5U
+#define LOG_SYNC1            0x4CU     // 'L' (telemetria: A5 5A)
+#define LOG_REC_MAX          (2U + LOG_ARGS_MAX)
+#define LOG_FRAME_MAX        (3U + LOG_REC_MAX * 4U + 4U)
+
+static volatile uint32_t ring[LOG_RING_WORDS];
+static volatile uint32_t head = 0;        // zarezerwowane słowa (narastająco)
+static volatile uint32_t tail = 0;        // przeczytane słowa (narastająco)
+static volatile uint32_t dropped = 0;
+static uint32_t          reported = 0;    // ostatnia zgłoszona wartość dropped
+
+/**
+ * @brief Rezerwacja words słów; false = brak miejsca.
+ */
+static bool Log_Reserve(uint32_t words, uint32_t *start)
+{
+    uint32_t h;
+    do
+    {
+        h = __LDREXW(&head);
+        if ((h + words - tail) > LOG_RING_WORDS)
+        {
+            __CLREX();
+            return false;
+        }
+    } while (__STREXW(h + words, &head) != 0U);
+
+    *start = h;
+    return true;
+}
+
+void Log_Emit(uint32_t header, const uint32_t *args)
+{
+    uint32_t nargs = (header >> LOG_HDR_NARGS_SHIFT) & 0x07U;
+    uint32_t start;
+
+    if (!Log_Reserve(2U + nargs, &start))
+    {
+        uint32_t d;
+        do
+        {
+            d = __LDREXW(&dropped);
+        } while (__STREXW(d + 1U, &dropped) != 0U);
+        return;
+    }
+
+    ring[(start + 1U) & (LOG_RING_WORDS - 1U)] = HAL_GetTick();
+    for (uint32_t i = 0; i < nargs; i++)
+    {
+        ring[(start + 2U + i) & (LOG_RING_WORDS - 1U)] = args[i];
+    }
+    ring[start & (LOG_RING_WORDS - 1U)] = header | LOG_HDR_VALID;
+}
+
+/**
+ * @brief Rekord przez SWO: słowa kolejno na port ITM (granice rekordów z nagłówka).
+ */
+static bool Log_SendItm(const uint32_t *rec, uint32_t words)
+{
+    for (uint32_t i = 0; i < words; i++)
+    {
+        while (ITM->PORT[LOG_ITM_PORT].u32 == 0U)
+        {
+            // FIFO ITM – słowo wychodzi w ~25 µs przy 2 MHz
+        }
+        ITM->PORT[LOG_ITM_PORT].u32 = rec[i];
+    }
+    return true;
+}
+
+/**
+ * @brief Rekord przez USART2: ramka w całości albo wcale (wtedy rekord czeka w buforze).
+ */
+static bool Log_SendUart(const uint32_t *rec, uint32_t words)
+{
+    uint8_t  frame[LOG_FRAME_MAX];
+    uint32_t len = 0;
+
+    if (UartTx_Free() < (3U + words * 4U + 4U))
+    {
+        return false;
+    }
+
+    frame[len++] = LOG_SYNC0;
+    frame[len++] = LOG_SYNC1;
+    frame[len++] = (uint8_t)words;
+
+    CRC->CR = CRC_CR_RESET;
+    for (uint32_t i = 0; i < words; i++)
+    {
+        CRC->DR = rec[i];
+        for (uint8_t b = 0; b < 4U; b++)
+        {
+            frame[len++] = (uint8_t)(rec[i] >> (8U * b));
+        }
+    }
+    uint32_t crc = CRC->DR;
+    for (uint8_t b = 0; b < 4U; b++)
+    {
+        frame[len++] = (uint8_t)(crc >> (8U * b));
+    }
+
+    return UartTx_Write(frame, (uint16_t)len) == len;
+}
+
+void Log_Process(void)
+{
+    bool itm = ((ITM->TCR & ITM_TCR_ITMENA_Msk) != 0U) &&
+               ((ITM->TER & (1UL << LOG_ITM_PORT)) != 0U);
+
+    // Utracone wpisy zgłaszamy wpisem w tym samym logu
+    uint32_t d = dropped;
+    if (d != reported)
+    {
+        reported = d;
+        LOG("log: %lu records dropped (buffer full)", (unsigned long)d);
+    }
+
+    while (tail != head)
+    {
+        uint32_t t   = tail;
+        uint32_t hdr = ring[t & (LOG_RING_WORDS - 1U)];
+        if ((hdr & LOG_HDR_VALID) == 0U)
+        {
+            break;   // zarezerwowany, jeszcze niezapisany (producent przerwany)
+        }
+
+        uint32_t rec[LOG_REC_MAX];
+        uint32_t words = 2U + ((hdr >> LOG_HDR_NARGS_SHIFT) & 0x07U);
+        for (uint32_t i = 0; i < words; i++)
+        {
+            rec[i] = ring[(t + i) & (LOG_RING_WORDS - 1U)];
+        }
+
+        if (!(itm ? Log_SendItm(rec, words) : Log_SendUart(rec, words)))
+        {
+            break;   // UART pełny – spróbujemy w kolejnym obiegu
+        }
+
+        for (uint32_t i = 0; i < words; i++)
+        {
+            ring[(t + i) & (LOG_RING_WORDS - 1U)] = 0U;
+        }
+        tail = t + words;
+    }
+}
+
+#endif // LOG_DISABLE
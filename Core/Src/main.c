@@ -34,6 +34,24 @@
 #include "fade.h"
 #include "menu_state_handlers.h"
 #include "alarm.h"
+#include "envelope.h"
+#include "lamp_reg.h"
+#include "dimmer.h"
+#include "button.h"
+#include "render.h"
+#include "clock.h"
+#include "prof.h"
+#include "telemetry.h"
+#include "uart_tx.h"
+#include "shell.h"
+#include "settings.h"
+#include "resume.h"
+#include "boot.h"
+#include "usb_port.h"
+#include "watchdog.h"
+#include "memstat.h"
+#include "trace.h"
+#include "log.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -53,19 +71,18 @@ I2C_HandleTypeDef hi2c1;
 TIM_HandleTypeDef htim1;
 TIM_HandleTypeDef htim3;
 UART_HandleTypeDef huart2;
+DMA_HandleTypeDef hdma_usart2_rx;
+DMA_HandleTypeDef hdma_usart2_tx;
 LedFadeHandle_t g_fadeHandle;
 
 /* USER CODE BEGIN PV */
-uint32_t lastEncMove    = 0;
-uint32_t lastBtnPress   = 0;
-uint32_t lastTimeUpdate = 0;
 REncoder_HandleTypeDef henc;
-extern int menuCount;
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
 void SystemClock_Config(void);
 static void MX_GPIO_Init(void);
+static void MX_DMA_Init(void);
 static void MX_USART2_UART_Init(void);
 static void MX_TIM1_Init(void);
 static void MX_I2C1_Init(void);
@@ -76,6 +93,40 @@ static void MX_TIM3_Init(void);
 
 /* Private user code ---------------------------------------------------------*/
 /* USER CODE BEGIN 0 */
+/**
+  * @brief Inicjalizacja odroczona: jeden krok na obieg pętli, już po pierwszej ramce.
+  *        Transakcje I2C (RTC, czujnik) nie opóźniają ekranu startowego.
+  */
+static void Boot_Deferred(Lcd_HandleTypeDef *lcd)
+{
+  if (!Boot_Done(BOOT_RTC))
+  {
+    // Pierwszy odczyt RTC (data dla AlarmPreSet i widoku TIME)
+    Clock_Init();
+    Boot_Mark(BOOT_RTC);
+  }
+  else if (!Boot_Done(BOOT_UI))
+  {
+    // Przełączniki i alarm z flasha, potem ekran/lampa/alarm sprzed resetu (albo menu główne)
+    Menu_LoadSettings();
+    AlarmPreSet();
+    Resume_Start(lcd);
+    Boot_Mark(BOOT_UI);
+    Wdg_Register(WDG_TASK_CLOCK, WDG_DEADLINE_CLOCK_MS);
+    Wdg_Register(WDG_TASK_INPUT, WDG_DEADLINE_INPUT_MS);
+  }
+  else if (!Boot_Done(BOOT_SENSOR))
+  {
+    // Start pomiarów; pierwsza próbka po LIGHTSEN_SAMPLE_MS (LightSen_Sample w pętli)
+    LightSen_Init(&hi2c1);
+    Boot_Mark(BOOT_SENSOR);
+    Wdg_Register(WDG_TASK_SENSOR, WDG_DEADLINE_SENSOR_MS);
+  }
+  else if (LightSen_IsReady())
+  {
+    Boot_Mark(BOOT_READY);
+  }
+}
 /* USER CODE END 0 */
 
 /**
@@ -94,23 +145,62 @@ int main(void)
   SystemClock_Config();
 
   /* USER CODE BEGIN Init */
-  RTC_Init(&hi2c1);
   /* USER CODE END Init */
 
   /* Inicjalizacja wygenerowanych peryferiów */
   MX_GPIO_Init();
+  MX_DMA_Init();
   MX_USART2_UART_Init();
   MX_TIM1_Init();
   MX_I2C1_Init();
   MX_TIM3_Init();
 
   /* USER CODE BEGIN 2 */
-  HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_4);
-  __HAL_TIM_SET_COMPARE(&htim3, TIM_CHANNEL_4, htim3.Init.Period);
+  Boot_Mark(BOOT_PERIPH);
+
+  // Sprzętowy CRC (settings.c, resume.c, log.c – rejestry wprost, bez sterownika HAL).
+  // Obliczenie to kilka zapisów bez blokady, więc CRC wolno używać wyłącznie
+  // z main() (inicjalizacja i pętla główna), nigdy z przerwań.
+  __HAL_RCC_CRC_CLK_ENABLE();
+
+  // Porty USB wyłączone do czasu odczytu ustawień; przeciążenie zgłasza EXTI linii FLT
+  UsbPort_Init();
+
+  // RTC: tylko uchwyt I2C (po MX_I2C1_Init); pierwszy odczyt – w pętli (Boot_Deferred)
+  RTC_Init(&hi2c1);
+
+  // Lampa (TIM3_CH4) – od tej chwili wyjściem steruje wyłącznie silnik fade
+  LedFade_Init(&g_fadeHandle, &htim3, TIM_CHANNEL_4);
   l_BulbOnOff = 2; // 2 = OFF
 
+  // Przerwanie update TIM3 taktuje odtwarzacze obwiedni (~1 kHz)
+  Envelope_Init(&htim3);
+
   REncoder_Init(&henc, &htim1, GPIOC, GPIO_PIN_7);
-  LightSen_Init(&hi2c1);
+  // Przycisk enkodera próbkowany w SysTick (1 kHz) – zdarzenia w kolejce
+  Button_Init(ENCODER_BTN_GPIO_Port, ENCODER_BTN_Pin);
+
+  // Licznik cykli DWT dla profilera (w Release nic nie robi)
+  Prof_Init();
+  // Zdarzenia przez ITM/SWO (PB3) i bufor w RAM (w Release nic nie robi)
+  Trace_Init();
+
+  // USART2: nadawanie przez bufor i DMA1 Channel7, odbiór konsoli przez DMA1 Channel6
+  UartTx_Init(&huart2);
+  Shell_Init(&huart2);
+
+  // IWDG (~1 s) odświeżany z SysTick tylko przy zdrowych zadaniach; raport po resecie z watchdoga
+  Wdg_Init();
+
+  // Ustawienia z flasha (jedno przejście po dzienniku, bez kasowania)
+  Settings_Init();
+
+  // Budżet RAM: podział statyczny i pierwszy pomiar stosu/sterty (wzorzec z kodu startowego)
+  MemStat_Init();
+
+  // Binarna telemetria (przez bufor nadawczy USART2)
+  Telemetry_Init();
+  Boot_Mark(BOOT_DRIVERS);
 
   // Inicjalizacja LCD
   Lcd_PortType ports[] = { GPIOC, GPIOC, GPIOB, GPIOA };
@@ -122,60 +212,92 @@ int main(void)
       GPIOC, GPIO_PIN_3,  // EN
       LCD_4_BIT_MODE
   );
-
-  // Wyświetlenie menu głównego
-  Menu_Display(&lcd, menuIndex, true);
-  AlarmPreSet();
+  Boot_Mark(BOOT_LCD);
+
+  // Ekran startowy od razu; menu zastąpi go po pierwszym odczycie RTC
+  Render_Init();
+  Render_PutRow(0, "LIGHT ALARM");
+  Render_PutRow(1, "START...");
+  Render_Frame(&lcd, HAL_GetTick());
+  Boot_Mark(BOOT_FIRST_FRAME);
+
+  // Nadzór watchdoga: zadania pętli; zegar, menu i czujnik – gdy ruszą (Boot_Deferred)
+  Wdg_Register(WDG_TASK_FADE, WDG_DEADLINE_FADE_MS);
+  Wdg_Register(WDG_TASK_RENDER, WDG_DEADLINE_RENDER_MS);
   /* USER CODE END 2 */
 
   /* USER CODE BEGIN WHILE */
   while (1)
   {
+    PROF_BEGIN(loop);
+    Telemetry_LoopMark();
+
+    Wdg_Begin(WDG_TASK_FADE);
     LedFade_Process(&g_fadeHandle);
+    Wdg_Checkin(WDG_TASK_FADE);
 
     int val = REncoder_Update(&henc);
     uint32_t now = HAL_GetTick();
 
-    // Odczyt RTC
-    RTC_TimeTypeDef rtc_info;
-    RTC_ReadTime(&rtc_info);
+    // Czujnik światła w rytmie jego pomiarów; każda nowa próbka = krok regulatora lampy
+    Wdg_Begin(WDG_TASK_SENSOR);
+    if (LightSen_Sample(&hi2c1, now))
+    {
+      LampReg_Update(LightSen_GetFilteredLux());
+    }
+    Wdg_Checkin(WDG_TASK_SENSOR);
+
+    // Ponowienia portów USB po przeciążeniu (samo odcięcie zasilania – w przerwaniu EXTI)
+    UsbPort_Process(now);
 
-    CheckAlarmTrigger(&rtc_info);
+    if (!Boot_Done(BOOT_READY))
+    {
+      Boot_Deferred(&lcd);
+    }
 
-    // Główny automat stanów menu
-    switch (gState)
+    if (Boot_Done(BOOT_UI))
     {
-      case MENU_STATE:
-        HandleMenuState(val, now, &lcd);
-        break;
-      case OPTION_STATE:
-        HandleOptionState(val, now, &lcd);
-        break;
-      case SUBMENU_2:
-        HandleSubMenu2State(val, now, &lcd);
-        break;
-      case SUBMENU_2B:
-        HandleSubMenu2BState(val, now, &lcd);
-        break;
-      case SUBMENU_L_BULB:
-        HandleSubMenuLBState(val, now, &lcd);
-        break;
-      case SUBMENU_ALARM:
-        HandleSubMenuAlarmState(val, now, &lcd);
-        break;
-      case SUBMENU_ALARM_SET:
-        HandleSubMenuAlarmSetState(val, now, &lcd);
-        break;
-      case ALARM_TRIGGERED:
-        HandleAlarmTriggered(val, now, &lcd);
-        break;
-      case SUBMENU_ALARM_LSENSOR:
-        HandleSubMenuAlarmLSensorState(val, now, &lcd);
-        break;
-      default:
-        break;
+      // Zegar: RTC czytany tylko w pobliżu przewidywanej zmiany sekundy; alarm i widok
+      // czasu dostają każdą sekundę dokładnie raz, zsynchronizowaną z RTC
+      Wdg_Begin(WDG_TASK_CLOCK);
+      if (Clock_Poll(now))
+      {
+        CheckAlarmTrigger(Clock_Now());
+        Menu_Post(UI_EVT_SECOND);
+      }
+      Wdg_Checkin(WDG_TASK_CLOCK);
+
+      // Automat hierarchiczny menu (tablica stanów w menu_state_handlers.c)
+      Wdg_Begin(WDG_TASK_INPUT);
+      Menu_Dispatch(val, now, &lcd);
+      Wdg_Checkin(WDG_TASK_INPUT);
+
+      // Migawka stanu do rejestrów BKP (wznowienie po resecie watchdoga/zaniku napięcia)
+      Resume_Process(now);
     }
 
+    // Ekrany piszą do bufora ramki; na LCD trafiają tylko zmiany, najwyżej RENDER_FPS razy/s
+    Wdg_Begin(WDG_TASK_RENDER);
+    Render_Frame(&lcd, now);
+    Wdg_Checkin(WDG_TASK_RENDER);
+
+    // Konsola: linie z bufora odbiorczego DMA (tylko po przerwaniu IDLE/połowy bufora)
+    Shell_Process();
+
+    // Log binarny: rekordy z bufora do USART2 (albo SWO, jeśli debugger włączył port ITM)
+    Log_Process();
+
+    // Ramka telemetrii co TELEMETRY_PERIOD_MS – wysyła DMA, CPU tylko ją składa
+    Telemetry_Process(now);
+
+    // Zapas stosu i sterty co sekundę; ostrzeżenie na konsoli przy nowym minimum
+    MemStat_Process(now);
+
+    PROF_END(loop, PROF_LOOP);
+
+    // Zrzut statystyk profilera przez USART2 (po naciśnięciu B1, tylko Debug)
+    Prof_DumpIfRequested();
+
     // Opóźnienie w pętli (odciążenie CPU)
     HAL_Delay(10);
   }
@@ -248,19 +370,22 @@ static void MX_TIM1_Init(void)
   htim1.Init.Prescaler         = 0;
   htim1.Init.CounterMode       = TIM_COUNTERMODE_UP;
   htim1.Init.Period            = 65535;
-  htim1.Init.ClockDivision     = TIM_CLOCKDIVISION_DIV1;
+  htim1.Init.ClockDivision     = TIM_CLOCKDIVISION_DIV4;
   htim1.Init.RepetitionCounter = 0;
   htim1.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
 
-  sConfig.EncoderMode          = TIM_ENCODERMODE_TI1;
+  /* Pełna kwadratura (4 zliczenia na okres) + filtr cyfrowy wejść:
+     fDTS = 64 MHz / 4, filtr 0xF = fDTS/32, N=8 -> impuls krótszy niż 16 µs jest odrzucany.
+     Dłuższe drgania styku na jednym kanale w TI12 dają +1/-1 i znoszą się. */
+  sConfig.EncoderMode          = TIM_ENCODERMODE_TI12;
   sConfig.IC1Polarity          = TIM_ICPOLARITY_RISING;
   sConfig.IC1Selection         = TIM_ICSELECTION_DIRECTTI;
   sConfig.IC1Prescaler         = TIM_ICPSC_DIV1;
-  sConfig.IC1Filter            = 0;
+  sConfig.IC1Filter            = 15;
   sConfig.IC2Polarity          = TIM_ICPOLARITY_RISING;
   sConfig.IC2Selection         = TIM_ICSELECTION_DIRECTTI;
   sConfig.IC2Prescaler         = TIM_ICPSC_DIV1;
-  sConfig.IC2Filter            = 0;
+  sConfig.IC2Filter            = 15;
 
   if (HAL_TIM_Encoder_Init(&htim1, &sConfig) != HAL_OK)
   {
@@ -334,6 +459,21 @@ static void MX_USART2_UART_Init(void)
   }
 }
 
+/**
+  * @brief Enable DMA controller clock (DMA1 Channel6 = USART2_RX, Channel7 = USART2_TX)
+  */
+static void MX_DMA_Init(void)
+{
+  /* DMA controller clock enable */
+  __HAL_RCC_DMA1_CLK_ENABLE();
+
+  /* DMA interrupt init */
+  HAL_NVIC_SetPriority(DMA1_Channel6_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Channel6_IRQn);
+  HAL_NVIC_SetPriority(DMA1_Channel7_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Channel7_IRQn);
+}
+
 /**
   * @brief GPIO Initialization Function
   */
@@ -394,21 +534,95 @@ static void MX_GPIO_Init(void)
 
   /*Configure GPIO pin : ENCODER_BTN_Pin */
   GPIO_InitStruct.Pin   = ENCODER_BTN_Pin;
-  GPIO_InitStruct.Mode  = GPIO_MODE_IT_FALLING;
+  GPIO_InitStruct.Mode  = GPIO_MODE_INPUT;
   GPIO_InitStruct.Pull  = GPIO_PULLUP;
   HAL_GPIO_Init(ENCODER_BTN_GPIO_Port, &GPIO_InitStruct);
 
   /*Configure GPIO pins : USB2_FLT_Pin USB1_FLT_Pin */
   GPIO_InitStruct.Pin   = USB2_FLT_Pin|USB1_FLT_Pin;
-  GPIO_InitStruct.Mode  = GPIO_MODE_INPUT;
-  GPIO_InitStruct.Pull  = GPIO_NOPULL;
+  GPIO_InitStruct.Mode  = GPIO_MODE_IT_FALLING;
+  GPIO_InitStruct.Pull  = GPIO_PULLUP;
   HAL_GPIO_Init(GPIOC, &GPIO_InitStruct);
 
   /* EXTI interrupt init */
+  HAL_NVIC_SetPriority(EXTI9_5_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(EXTI9_5_IRQn);
+
   HAL_NVIC_SetPriority(EXTI15_10_IRQn, 0, 0);
   HAL_NVIC_EnableIRQ(EXTI15_10_IRQn);
 }
 
+/* USER CODE BEGIN 4 */
+
+/**
+  * @brief Przerwanie update timerów (HAL). TIM3 taktuje silnik obwiedni.
+  */
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
+{
+  if (htim->Instance == TIM3)
+  {
+    Envelope_TimerTick(htim);
+  }
+}
+
+/**
+  * @brief Przerwanie capture TIM1 – zbocze na wejściu enkodera (tylko w trybie ściemniacza).
+  */
+void HAL_TIM_IC_CaptureCallback(TIM_HandleTypeDef *htim)
+{
+  if (htim->Instance == TIM1)
+  {
+    Dimmer_EncoderEdge(htim);
+  }
+}
+
+/**
+  * @brief Przerwanie EXTI – przeciążenie portu USB (linie FLT) odcina zasilanie
+  *        od razu; przycisk B1 zgłasza zrzut profilera.
+  */
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
+{
+  if ((GPIO_Pin == USB1_FLT_Pin) || (GPIO_Pin == USB2_FLT_Pin))
+  {
+    UsbPort_FaultIrq(GPIO_Pin);
+  }
+  else if (GPIO_Pin == B1_Pin)
+  {
+    Prof_RequestDump();
+  }
+}
+
+/**
+  * @brief Koniec nadawania DMA – kolejny fragment bufora nadawczego.
+  */
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+  UartTx_TxComplete(huart);
+}
+
+/**
+  * @brief Połowa / koniec kołowego bufora odbiorczego – konsola ma dane do odczytu.
+  */
+void HAL_UART_RxHalfCpltCallback(UART_HandleTypeDef *huart)
+{
+  Shell_RxEvent();
+}
+
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
+{
+  Shell_RxEvent();
+}
+
+/**
+  * @brief Błąd UART (overrun, szum) – HAL zatrzymuje odbiór, konsola startuje go od nowa.
+  */
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+  Shell_RxRestart(huart);
+}
+
+/* USER CODE END 4 */
+
 /**
   * @brief Funkcja wywoływana w przypadku błędu.
   */
@@ -0,0 +1,106 @@
+// Created by: Marcin Dziedzic
+// memstat.c
+
+#include "memstat.h"
+#include "shell.h"
+#include "stm32f1xx_hal.h"
+#include <stddef.h>
+
+/* ----------------------------------------------------------------------------
+   Układ RAM (STM32F103RBTX_FLASH.ld):
+     .data | .bss | .noinit | sterta (_end ->)   ...   (<- stos) _estack
+   Kod startowy zamalowuje wszystko od _end do SP wzorcem MEMSTAT_PAINT.
+   Stos: najniższe nadpisane słowo ponad szczytem sterty = najgłębsze użycie,
+   także wtedy, gdy stos wyszedł poza rezerwację _Min_Stack_Size.
+   Sterta: szczyt z _sbrk(0) – w tej implementacji nigdy nie maleje.
+   -----------------------------------------------------------------------------*/
+
+extern uint32_t _sdata;
+extern uint32_t _edata;
+extern uint32_t _sbss;
+extern uint32_t _ebss;
+extern uint32_t _end;
+extern uint32_t _estack;
+extern uint32_t _Min_Stack_Size;
+extern uint32_t _Min_Heap_Size;
+
+extern void *_sbrk(ptrdiff_t incr);
+
+static MemStat_t stat;
+static uint32_t  lastCheck = 0;
+static int16_t   warnedMargin = MEMSTAT_WARN_MARGIN;   // najniższy zapas już zgłoszony
+
+static uint16_t Span(const void *from, const void *to)
+{
+    return (uint16_t)((uintptr_t)to - (uintptr_t)from);
+}
+
+/**
+ * @brief Skan od szczytu sterty w górę do pierwszego słowa bez wzorca.
+ */
+static void MemStat_Measure(void)
+{
+    const uint32_t *heapTop = (const uint32_t *)(((uintptr_t)_sbrk(0) + 3U) & ~(uintptr_t)3U);
+    const uint32_t *top     = &_estack;
+    const uint32_t *p       = heapTop;
+
+    while ((p < top) && (*p == MEMSTAT_PAINT))
+    {
+        p++;
+    }
+
+    stat.stackUsed   = Span(p, top);
+    stat.heapUsed    = Span(&_end, heapTop);
+    stat.freeGap     = Span(heapTop, p);
+    stat.stackMargin = (int16_t)((int32_t)stat.stackReserved - (int32_t)stat.stackUsed);
+    stat.heapMargin  = (int16_t)((int32_t)stat.heapReserved - (int32_t)stat.heapUsed);
+}
+
+void MemStat_Init(void)
+{
+    stat.dataSize      = Span(&_sdata, &_edata);
+    stat.bssSize       = Span(&_sbss, &_ebss);
+    stat.stackReserved = (uint16_t)(uintptr_t)&_Min_Stack_Size;
+    stat.heapReserved  = (uint16_t)(uintptr_t)&_Min_Heap_Size;
+    lastCheck = HAL_GetTick();
+    MemStat_Measure();
+}
+
+void MemStat_Process(uint32_t now)
+{
+    if ((now - lastCheck) < MEMSTAT_PERIOD_MS)
+    {
+        return;
+    }
+    lastCheck = now;
+    MemStat_Measure();
+
+    int16_t margin = (stat.stackMargin < stat.heapMargin) ? stat.stackMargin : stat.heapMargin;
+    if (margin < MEMSTAT_WARN_MARGIN)
+    {
+        stat.warning = true;
+    }
+
+    // Ostrzeżenie tylko przy nowym minimum – log nie zalewa konsoli co sekundę
+    if (margin < warnedMargin)
+    {
+        warnedMargin = margin;
+        Shell_Printf("mem: WARN margin stack=%d heap=%d B (limit %d)\r\n",
+                     stat.stackMargin, stat.heapMargin, MEMSTAT_WARN_MARGIN);
+    }
+}
+
+const MemStat_t *MemStat_Get(void)
+{
+    return &stat;
+}
+
+void MemStat_Report(void)
+{
+    MemStat_Measure();
+    Shell_Printf("mem: data=%u bss=%u stack=%u/%u heap=%u/%u free=%u B%s\r\n",
+                 stat.dataSize, stat.bssSize,
+                 stat.stackUsed, stat.stackReserved,
+                 stat.heapUsed, stat.heapReserved,
+                 stat.freeGap, stat.warning ? " WARN" : "");
+}
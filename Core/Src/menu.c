@@ -7,17 +7,22 @@
 #include <stdbool.h>
 #include "light_sen.h"
 #include "fade.h"
+#include "lamp_reg.h"
+#include "menu_state_handlers.h"
+#include "render.h"
+#include "clock.h"
+#include "settings.h"
+#include "usb_port.h"
 
 // Uchwyt timera do fade, zadeklarowany gdzie indziej
 extern TIM_HandleTypeDef htim3;
 
 // Definicja globalnych zmiennych (bez extern)
 MenuState gState = MENU_STATE;    // start w głównym menu
-int8_t menuIndex = 0;
 int8_t currentSubMenuIndex = 0;
 int8_t alarmSetIndex = 0;         // 0=day,1=month,2=year,3=hour,4=min,5=sec
 int8_t lightSensorMode = 2;       // 1=ON, 2=OFF
-int8_t sensorSubIndex;
+uint16_t lampRegEditLux = LAMPREG_TARGET_DEFAULT;
 
 int usb_OnOff   = 1;  // 1=ON, 2=OFF
 int usb2_OnOff  = 1;  // 1=ON, 2=OFF
@@ -26,190 +31,267 @@ int l_BulbOnOff = 2;  // 1=ON, 2=OFF
 // Globalna zmienna dla alarmu
 AlarmData alarmData = {0, 0, 0, 0, 0, 0, 0}; // Inicjalizacja na zero
 
-// Przykładowa tablica nazw pozycji w menu
-static const char *menuItems[] = {
-    "TIME ",
-    "ALARM",
-    "USB1 ",
-    "USB2 ",
-    "LIGHT_BULB",
-    "LIGHT_SENSOR"
-};
-// Liczba pozycji
-int menuCount = sizeof(menuItems) / sizeof(menuItems[0]);
+/* ----------------------------------------------------------------------------
+   Przełączniki ON/OFF (get/set) – efekty uboczne w jednym miejscu.
+   -----------------------------------------------------------------------------*/
+
+static bool Usb1_Get(void) { return usb_OnOff == 1; }
+static bool Usb2_Get(void) { return usb2_OnOff == 1; }
+static bool Bulb_Get(void) { return l_BulbOnOff == 1; }
+static bool LSensor_Get(void) { return lightSensorMode == 1; }
+
+void Usb1_Set(bool on)
+{
+    usb_OnOff = on ? 1 : 2;
+    Settings_Set(SET_KEY_USB1, (uint32_t)usb_OnOff);
+    UsbPort_Set(USB_PORT_1, on);
+}
+
+void Usb2_Set(bool on)
+{
+    usb2_OnOff = on ? 1 : 2;
+    Settings_Set(SET_KEY_USB2, (uint32_t)usb2_OnOff);
+    UsbPort_Set(USB_PORT_2, on);
+}
+
+void Bulb_Set(bool on)
+{
+    // Ręczne sterowanie wyłącza regulację wg czujnika
+    LampReg_Disable();
+    Settings_Set(SET_KEY_LAMPREG, 0);
+    if (Bulb_Get() != on)
+    {
+        l_BulbOnOff = on ? 1 : 2;
+        LedFade_Start(&g_fadeHandle, &htim3, TIM_CHANNEL_4,
+                      on ? FADE_IN : FADE_OUT,
+                      100,      // steps
+                      1000);
+    }
+    Settings_Set(SET_KEY_LAMP, (uint32_t)l_BulbOnOff);
+}
+
+void LSensor_Set(bool on)
+{
+    lightSensorMode = on ? 1 : 2;
+    Settings_Set(SET_KEY_LSENSOR, (uint32_t)lightSensorMode);
+}
+
+static void LampReg_Set(bool on)
+{
+    if (on)
+    {
+        LampReg_Enable(lampRegEditLux);
+        l_BulbOnOff = 1;
+    }
+    else
+    {
+        // Lampa zostaje na bieżącej jasności
+        LampReg_Disable();
+    }
+    Settings_Set(SET_KEY_LAMPREG, on ? 1U : 0U);
+}
+
+static void LampRegTarget_Commit(uint16_t targetLux)
+{
+    LampReg_SetTarget(targetLux);
+    Settings_Set(SET_KEY_LAMPREG_TARGET, targetLux);
+}
 
 /**
- * @brief Wyświetla główne menu w trybie scrollowalnym (po 2 pozycje).
+ * @brief Przywrócenie przełączników zapisanych we flashu (po Settings_Init).
+ *        Brak zapisu = wartości domyślne z definicji zmiennych.
  */
-void Menu_Display(Lcd_HandleTypeDef *lcd, uint8_t index, bool forceRefresh)
+void Menu_LoadSettings(void)
 {
-    // Zmienne statyczne do zapamiętania poprzednich wartości
-    static uint8_t oldIndex = 255;
-    static uint8_t oldPage  = 255;
+    uint32_t v;
 
-    // Bufory na wiersze LCD (16 znaków + 1 terminator)
-    static char row0[17];
-    static char row1[17];
+    if (Settings_Get(SET_KEY_USB1, &v))            usb_OnOff  = (v == 1U) ? 1 : 2;
+    if (Settings_Get(SET_KEY_USB2, &v))            usb2_OnOff = (v == 1U) ? 1 : 2;
+    if (Settings_Get(SET_KEY_LSENSOR, &v))         lightSensorMode = (v == 1U) ? 1 : 2;
+    if (Settings_Get(SET_KEY_LAMPREG_TARGET, &v))  lampRegEditLux = (uint16_t)v;
 
-    // Obliczenie numeru „strony” (po 2 elementy na stronę)
-    uint8_t page = index / 2;
-    uint8_t firstItem  = page * 2;
-    uint8_t secondItem = firstItem + 1;
+    // Porty USB startują wyłączone (UsbPort_Init) – także domyślne ON trzeba wystawić
+    UsbPort_Set(USB_PORT_1, usb_OnOff == 1);
+    UsbPort_Set(USB_PORT_2, usb2_OnOff == 1);
 
-    // Funkcja pomocnicza do pełnego odświeżenia
-    void RefreshWholePage(void)
+    // Regulator sam steruje lampą; bez niego – zapamiętany stan ON/OFF
+    if (Settings_Get(SET_KEY_LAMPREG, &v) && (v == 1U))
+    {
+        LampReg_Set(true);
+    }
+    else if (Settings_Get(SET_KEY_LAMP, &v) && (v == 1U))
     {
-        Lcd_clear(lcd);
+        Bulb_Set(true);
+    }
+}
 
-        // Wypełniamy oba wiersze spacjami
-        memset(row0, ' ', 16);
-        memset(row1, ' ', 16);
-        row0[16] = '\0';
-        row1[16] = '\0';
+/* ----------------------------------------------------------------------------
+   Akcje otwierające ekrany nietypowe.
+   -----------------------------------------------------------------------------*/
 
-        // Uzupełniamy row0
-        if (firstItem < menuCount)
-        {
-            bool selected = ((index % 2) == 0);
-            if (selected)
-                snprintf(row0, sizeof(row0), ">%s", menuItems[firstItem]);
-            else
-                snprintf(row0, sizeof(row0), " %s", menuItems[firstItem]);
-        }
+static void Action_Time(Lcd_HandleTypeDef *lcd)   { Menu_OpenView(lcd, Menu_ViewTime); }
+static void Action_Sensor(Lcd_HandleTypeDef *lcd) { Menu_OpenView(lcd, Menu_ViewSensor); }
+static void Action_Usb1(Lcd_HandleTypeDef *lcd)   { Menu_OpenView(lcd, Menu_ViewUsb1); }
+static void Action_Usb2(Lcd_HandleTypeDef *lcd)   { Menu_OpenView(lcd, Menu_ViewUsb2); }
 
-        // Uzupełniamy row1
-        if (secondItem < menuCount)
-        {
-            bool selected = ((index % 2) == 1);
-            if (selected)
-                snprintf(row1, sizeof(row1), ">%s", menuItems[secondItem]);
-            else
-                snprintf(row1, sizeof(row1), " %s", menuItems[secondItem]);
-        }
+/* ----------------------------------------------------------------------------
+   Drzewo menu – stałe tabele we flashu. Nowe menu = nowa pozycja w tabeli.
+   Każda tabela ma najwyżej MENU_ITEMS_MAX pozycji (sprawdzane przy kompilacji).
+   -----------------------------------------------------------------------------*/
 
-        // Wyświetlamy
-        Lcd_cursor(lcd, 0, 0);
-        Lcd_string(lcd, row0);
-        Lcd_cursor(lcd, 1, 0);
-        Lcd_string(lcd, row1);
-    }
+#define MENU_COUNT(items)  (sizeof(items) / sizeof((items)[0]))
+#define MENU_CHECK(items)  _Static_assert(MENU_COUNT(items) <= MENU_ITEMS_MAX, \
+                                          #items ": więcej pozycji niż MENU_ITEMS_MAX")
+
+static const MenuItem_t alarmItems[] = {
+    { "SET",     MENU_ITEM_ACTION, .u.action = Menu_OpenAlarmSet },
+    { "LSENSOR", MENU_ITEM_TOGGLE, .u.toggle = { LSensor_Get, LSensor_Set } },
+    { "BACK",    MENU_ITEM_BACK,   .u.action = NULL },
+};
+static const Menu_t alarmMenu = { alarmItems, MENU_COUNT(alarmItems) };
+MENU_CHECK(alarmItems);
+
+static const MenuItem_t usb1Items[] = {
+    { "ENABLE",  MENU_ITEM_TOGGLE, .u.toggle = { Usb1_Get, Usb1_Set } },
+    { "STATUS",  MENU_ITEM_ACTION, .u.action = Action_Usb1 },
+    { "BACK",    MENU_ITEM_BACK,   .u.action = NULL },
+};
+static const Menu_t usb1Menu = { usb1Items, MENU_COUNT(usb1Items) };
+MENU_CHECK(usb1Items);
+
+static const MenuItem_t usb2Items[] = {
+    { "ENABLE",  MENU_ITEM_TOGGLE, .u.toggle = { Usb2_Get, Usb2_Set } },
+    { "STATUS",  MENU_ITEM_ACTION, .u.action = Action_Usb2 },
+    { "BACK",    MENU_ITEM_BACK,   .u.action = NULL },
+};
+static const Menu_t usb2Menu = { usb2Items, MENU_COUNT(usb2Items) };
+MENU_CHECK(usb2Items);
+
+static const MenuItem_t lampRegItems[] = {
+    { "ENABLE",  MENU_ITEM_TOGGLE, .u.toggle = { LampReg_IsEnabled, LampReg_Set } },
+    { "TARGET",  MENU_ITEM_VALUE,  .u.value  = { &lampRegEditLux,
+                                                 LAMPREG_TARGET_MIN, LAMPREG_TARGET_MAX,
+                                                 LAMPREG_TARGET_STEP, "lx",
+                                                 LampRegTarget_Commit, LightSen_GetFilteredLux } },
+    { "BACK",    MENU_ITEM_BACK,   .u.action = NULL },
+};
+static const Menu_t lampRegMenu = { lampRegItems, MENU_COUNT(lampRegItems) };
+MENU_CHECK(lampRegItems);
+
+static const MenuItem_t mainItems[] = {
+    { "TIME",         MENU_ITEM_ACTION,  .u.action  = Action_Time },
+    { "ALARM",        MENU_ITEM_SUBMENU, .u.submenu = &alarmMenu },
+    { "USB1",         MENU_ITEM_SUBMENU, .u.submenu = &usb1Menu },
+    { "USB2",         MENU_ITEM_SUBMENU, .u.submenu = &usb2Menu },
+    { "LIGHT_BULB",   MENU_ITEM_TOGGLE,  .u.toggle  = { Bulb_Get, Bulb_Set } },
+    { "LIGHT_SENSOR", MENU_ITEM_ACTION,  .u.action  = Action_Sensor },
+    { "LAMP_REG",     MENU_ITEM_SUBMENU, .u.submenu = &lampRegMenu },
+    { "DIMMER",       MENU_ITEM_ACTION,  .u.action  = Menu_OpenDimmer },
+};
+const Menu_t mainMenu = { mainItems, MENU_COUNT(mainItems) };
+MENU_CHECK(mainItems);
+
+/* ----------------------------------------------------------------------------
+   Ekrany tylko składają wiersze w buforze ramki (render.c); na LCD trafiają
+   same zmiany, raz na ramkę (Render_Frame w pętli głównej).
+   -----------------------------------------------------------------------------*/
+
+void Menu_InvalidateRows(void)
+{
+    Render_Invalidate();
+}
+
+/**
+ * @brief Wyświetla listę menu w trybie scrollowalnym (po 2 pozycje).
+ */
+void Menu_Display(Lcd_HandleTypeDef *lcd, const Menu_t *menu, uint8_t index, bool forceRefresh)
+{
+    // Obliczenie numeru „strony” (po 2 elementy na stronę)
+    uint8_t firstItem = (uint8_t)((index / 2) * 2);
 
-    // 1. forceRefresh => pełne odświeżenie ekranu
     if (forceRefresh)
     {
-        oldPage  = 255;
-        oldIndex = 255;
+        Menu_InvalidateRows();
     }
 
-    // 2. Sprawdzamy, czy zmieniła się strona
-    if (page != oldPage)
-    {
-        RefreshWholePage();
-        oldPage  = page;
-        oldIndex = index;
-    }
-    else
+    for (uint8_t row = 0; row < 2; row++)
     {
-        // Ta sama strona, ale inny element?
-        if (index != oldIndex)
+        char line[17] = "";
+        uint8_t item = firstItem + row;
+        if (item < menu->count)
         {
-            uint8_t oldRow = (oldIndex % 2);
-            uint8_t newRow = (index % 2);
-
-            if (oldRow != newRow)
-            {
-                memset(row0, ' ', 16);
-                row0[16] = '\0';
-                if (firstItem < menuCount)
-                {
-                    bool selected = (newRow == 0);
-                    if (selected)
-                        snprintf(row0, sizeof(row0), ">%s", menuItems[firstItem]);
-                    else
-                        snprintf(row0, sizeof(row0), " %s", menuItems[firstItem]);
-                }
-                Lcd_cursor(lcd, 0, 0);
-                Lcd_string(lcd, row0);
-
-                memset(row1, ' ', 16);
-                row1[16] = '\0';
-                if (secondItem < menuCount)
-                {
-                    bool selected = (newRow == 1);
-                    if (selected)
-                        snprintf(row1, sizeof(row1), ">%s", menuItems[secondItem]);
-                    else
-                        snprintf(row1, sizeof(row1), " %s", menuItems[secondItem]);
-                }
-                Lcd_cursor(lcd, 1, 0);
-                Lcd_string(lcd, row1);
-            }
-            oldIndex = index;
+            snprintf(line, sizeof(line), "%c%s", (item == index) ? '>' : ' ',
+                     menu->items[item].label);
         }
+        Render_PutRow(row, line);
     }
 }
 
 /**
- * @brief Wyświetla zawartość wybranej opcji menu (TIME, ALARM, USB1, USB2, L_BULB, SENSOR).
+ * @brief Widok TIME – data i czas z pamięci podręcznej zegara (bez odczytu RTC).
+ *        Bufor ramki porównuje wiersze, więc na LCD trafiają tylko zmienione cyfry.
  */
-void Menu_ShowOption(Lcd_HandleTypeDef *lcd, uint8_t index, I2C_HandleTypeDef *hi2c)
+void Menu_ViewTime(Lcd_HandleTypeDef *lcd)
 {
-    switch (index)
-    {
-    case 0: // TIME
-    {
-        RTC_TimeTypeDef now;
-        RTC_ReadTime(&now);
+    const RTC_TimeTypeDef *now = Clock_Now();
 
-        char buf[17];
-        snprintf(buf, sizeof(buf), "%02d/%02d/%04d", now.day, now.month, (now.year + 2000));
-        Lcd_cursor(lcd, 0, 0);
-        Lcd_string(lcd, buf);
+    char buf[17];
+    snprintf(buf, sizeof(buf), "%02d/%02d/%04d", now->day, now->month, (now->year + 2000));
+    Render_PutRow(0, buf);
 
-        snprintf(buf, sizeof(buf), "%02d:%02d:%02d", now.hours, now.minutes, now.seconds);
-        Lcd_cursor(lcd, 1, 0);
-        Lcd_string(lcd, buf);
-        break;
-    }
-    case 1: // ALARM
-    {
-        currentSubMenuIndex = 0;
-        gState = SUBMENU_ALARM;
-        DisplayAlarmMenu(lcd, currentSubMenuIndex);
-        break;
-    }
-    case 2: // USB1 => sub-menu
-    {
-        currentSubMenuIndex = 0;
-        gState = SUBMENU_2;
-        DisplaySubMenuON_OFF(lcd, currentSubMenuIndex, usb_OnOff);
-        break;
-    }
-    case 3: // USB2 => sub-menu
-    {
-        currentSubMenuIndex = 0;
-        gState = SUBMENU_2B;
-        DisplaySubMenuON_OFF(lcd, currentSubMenuIndex, usb2_OnOff);
-        break;
-    }
-    case 4: // L_BULB
+    snprintf(buf, sizeof(buf), "%02d:%02d:%02d", now->hours, now->minutes, now->seconds);
+    Render_PutRow(1, buf);
+}
+
+/**
+ * @brief Widok SENSOR – przefiltrowany odczyt czujnika (bez blokującego pomiaru).
+ */
+void Menu_ViewSensor(Lcd_HandleTypeDef *lcd)
+{
+    char buf[17];
+    snprintf(buf, sizeof(buf), "Lux: %u", LightSen_GetFilteredLux());
+    Render_PutRow(0, buf);
+    Render_PutRow(1, "");
+}
+
+/**
+ * @brief Widok STATUS portu USB – stan klucza (z odliczaniem do ponowienia) i licznik przeciążeń.
+ */
+static void Menu_ViewUsb(UsbPort_e port)
+{
+    char buf[17];
+    uint8_t n = (uint8_t)(port + 1);
+
+    switch (UsbPort_GetState(port))
     {
-        currentSubMenuIndex = 0;
-        gState = SUBMENU_L_BULB;
-        DisplaySubMenuON_OFF(lcd, currentSubMenuIndex, l_BulbOnOff);
+    case USB_STATE_ON:
+        snprintf(buf, sizeof(buf), "USB%u ON", n);
         break;
-    }
-    case 5: // SENSOR
+    case USB_STATE_FAULT:
     {
-        uint16_t lux = LightSen_ReadLux(hi2c);
-        LightSen_DisplayLux(lcd, lux);
+        // Odstęp ponowienia nie przekracza USB_RETRY_MAX_MS – najwyżej 2 cyfry,
+        // więc wiersz zawsze mieści się w 16 znakach
+        uint32_t secs = (UsbPort_GetRetryInMs(port, HAL_GetTick()) + 999U) / 1000U;
+        if (secs > (USB_RETRY_MAX_MS / 1000U))
+        {
+            secs = USB_RETRY_MAX_MS / 1000U;
+        }
+        snprintf(buf, sizeof(buf), "USB%u FAULT %lus", n, (unsigned long)secs);
         break;
     }
     default:
+        snprintf(buf, sizeof(buf), "USB%u OFF", n);
         break;
     }
+    Render_PutRow(0, buf);
+
+    snprintf(buf, sizeof(buf), "Faults: %u", UsbPort_GetFaultCount(port));
+    Render_PutRow(1, buf);
 }
 
+void Menu_ViewUsb1(Lcd_HandleTypeDef *lcd) { Menu_ViewUsb(USB_PORT_1); }
+void Menu_ViewUsb2(Lcd_HandleTypeDef *lcd) { Menu_ViewUsb(USB_PORT_2); }
+
 /**
  * @brief Wyświetla sub-menu typu ON/OFF/BACK z wyróżnieniem opcji.
  */
@@ -265,55 +347,73 @@ void DisplaySubMenuON_OFF(Lcd_HandleTypeDef *lcd, int8_t subIndex, int device_On
 
     strncpy(&row1[0], backLabel, strlen(backLabel));
 
-    Lcd_cursor(lcd, 0, 0);
-    Lcd_string(lcd, row0);
-    Lcd_cursor(lcd, 1, 0);
-    Lcd_string(lcd, row1);
+    Render_PutRow(0, row0);
+    Render_PutRow(1, row1);
 }
 
 /**
- * @brief Wyświetla menu alarmu (SET / L_Sensor / BACK).
+ * @brief Ekran edycji wartości: "ETYKIETA: wartość jednostka" + opcjonalny odczyt bieżący.
  */
-void DisplayAlarmMenu(Lcd_HandleTypeDef *lcd, int8_t subIndex)
+void DisplayValueEdit(Lcd_HandleTypeDef *lcd, const MenuItem_t *item, uint16_t value)
 {
+    const MenuValue_t *v = &item->u.value;
     char row0[17];
-    char row1[17];
-    memset(row0, ' ', 16);
-    memset(row1, ' ', 16);
-    row0[16] = '\0';
-    row1[16] = '\0';
-
-    // subIndex = 0 => >SET    LSensor
-    // subIndex = 1 =>  SET   >LSensor
-    // subIndex = 2 =>  SET    LSensor, dolny wiersz => >BACK
+    char row1[17] = "";
 
-    if (subIndex == 0)
-    {
-        snprintf(row0, sizeof(row0), ">SET    LSensor");
-    }
-    else if (subIndex == 1)
-    {
-        snprintf(row0, sizeof(row0), " SET   >LSensor");
-    }
-    else
+    snprintf(row0, sizeof(row0), "%s: %u %s", item->label, value, v->unit);
+    if (v->readback != NULL)
     {
-        snprintf(row0, sizeof(row0), " SET    LSensor");
+        snprintf(row1, sizeof(row1), "Now: %u %s", v->readback(), v->unit);
     }
 
-    // Dolny wiersz
-    if (subIndex == 2)
+    Render_PutRow(0, row0);
+    Render_PutRow(1, row1);
+}
+
+/**
+ * @brief Wyświetla ekran ściemniacza. Pasek ma 16 pól po 5 kolumn (80 kroków);
+ *        częściowo wypełnione pole to własny znak CGRAM 1..4, pełne – 0xFF z ROM.
+ *        (Kod 0 pomijamy – w łańcuchu byłby terminatorem.)
+ */
+void DisplayDimmer(Lcd_HandleTypeDef *lcd, uint8_t percent, bool forceRefresh)
+{
+    char row0[17];
+    char row1[17];
+
+    if (forceRefresh)
     {
-        snprintf(row1, sizeof(row1), ">BACK   ");
+        for (uint8_t cols = 1; cols <= 4; cols++)
+        {
+            uint8_t line = (uint8_t)(0x1F << (5 - cols)) & 0x1F;
+            uint8_t bitmap[8] = { line, line, line, line, line, line, line, 0x00 };
+            Lcd_define_char(lcd, cols, bitmap);
+        }
     }
-    else
+
+    snprintf(row0, sizeof(row0), "DIMMER      %3u%%", percent);
+
+    uint8_t fill = (uint8_t)(((uint16_t)percent * 80U) / 100U);
+    for (uint8_t i = 0; i < 16; i++)
     {
-        snprintf(row1, sizeof(row1), " BACK   ");
+        if (fill >= 5)
+        {
+            row1[i] = (char)0xFF;
+            fill -= 5;
+        }
+        else if (fill > 0)
+        {
+            row1[i] = (char)fill;
+            fill = 0;
+        }
+        else
+        {
+            row1[i] = ' ';
+        }
     }
+    row1[16] = '\0';
 
-    Lcd_cursor(lcd, 0, 0);
-    Lcd_string(lcd, row0);
-    Lcd_cursor(lcd, 1, 0);
-    Lcd_string(lcd, row1);
+    Render_PutRow(0, row0);
+    Render_PutRow(1, row1);
 }
 
 /**
@@ -363,10 +463,8 @@ void DisplayAlarmSet(Lcd_HandleTypeDef *lcd, int8_t setIndex, bool blinkOn)
         }
     }
 
-    Lcd_cursor(lcd, 0, 0);
-    Lcd_string(lcd, row0);
-    Lcd_cursor(lcd, 1, 0);
-    Lcd_string(lcd, row1);
+    Render_PutRow(0, row0);
+    Render_PutRow(1, row1);
 }
 
 /**
@@ -392,8 +490,6 @@ void DisplayAlarmTriggered(Lcd_HandleTypeDef *lcd, int8_t subIndex)
         snprintf(row1, sizeof(row1), " STOP  >SNOOZE");
     }
 
-    Lcd_cursor(lcd, 0, 0);
-    Lcd_string(lcd, row0);
-    Lcd_cursor(lcd, 1, 0);
-    Lcd_string(lcd, row1);
+    Render_PutRow(0, row0);
+    Render_PutRow(1, row1);
 }
@@ -3,672 +3,821 @@
 
 #include "menu_state_handlers.h"
 #include "fade.h"
+#include "envelope.h"
 #include "light_sen.h"
+#include "lamp_reg.h"
+#include "dimmer.h"
 #include "r_encoder.h"
-
-// Uchwyty do I2C i TIM – zdefiniowane w main.c, tutaj tylko extern
-extern I2C_HandleTypeDef hi2c1;
+#include "button.h"
+#include "prof.h"
+#include "trace.h"
+#include "alarm.h"
+#include "calendar.h"
+#include "clock.h"
+
+// Uchwyty do TIM i enkodera – zdefiniowane w main.c, tutaj tylko extern
 extern TIM_HandleTypeDef htim3;
+extern REncoder_HandleTypeDef henc;
+
+/* ----------------------------------------------------------------------------
+   Enkoder: handlery dostają sumę ząbków od poprzedniego obiegu pętli i stosują
+   ją w całości (bez blokad czasowych). Pola edycyjne mają przyspieszenie.
+   -----------------------------------------------------------------------------*/
+
+// Maksymalny krok (w jednostkach pola) przy szybkim obrocie
+#define EDIT_ACCEL_MAX_STEP  10U
 
-extern int8_t menuIndex;
+static REncoder_AccelTypeDef editAccel = {0};
+
+/**
+ * @brief Przesunięcie wartości o delta z zawinięciem w zakresie lo..hi.
+ */
+static int8_t WrapRange(int value, int delta, int lo, int hi)
+{
+    int span = hi - lo + 1;
+    int v = (value - lo + delta) % span;
+    if (v < 0) v += span;
+    return (int8_t)(lo + v);
+}
 
 /* ----------------------------------------------------------------------------
-   Zaawansowany debouncing przycisku:
-   - 3 próbki w krótkich odstępach (np. co 20 ms)
-   - jeśli >=2 z 3 próbek to stan wciśnięty (0), uznajemy przycisk za wciśnięty
-   - lockout 50 ms (przez ten czas zwracamy stale "true")
+   Przycisk enkodera: debouncing i rozpoznawanie zdarzeń robi button.c
+   (przerwanie SysTick, 1 kHz). Menu_Dispatch zamienia kolejkę na UI_EVT_BUTTON.
    -----------------------------------------------------------------------------*/
-static bool CheckDebouncedButton(void)
+
+/**
+ * @brief Czy zdarzenie to wciśnięcie przycisku enkodera?
+ */
+static bool IsPress(const UiEvent_t *evt)
 {
-    // Statyczne zmienne do zapamiętywania próbek
-    static uint8_t  samples[3] = {1,1,1};  // 1=nie wciśnięty, 0=wciśnięty
-    static uint8_t  idx            = 0;
-    static uint32_t lastSampleTime = 0;
-    static uint32_t lockoutUntil   = 0;
+    return (evt->type == UI_EVT_BUTTON) && (evt->arg == BTN_EVT_PRESS);
+}
+
+/* ----------------------------------------------------------------------------
+   Automat hierarchiczny. Każdy stan ma rodzica, akcje wejścia/wyjścia i handler
+   zdarzeń; zdarzenie nieobsłużone przez stan trafia do jego rodzica.
+
+       MENU_UI_STATE (historia)          ALARM_TRIGGERED
+         ├─ MENU_STATE
+         ├─ OPTION_STATE
+         ├─ MENU_TOGGLE_STATE
+         ├─ MENU_VALUE_STATE
+         ├─ SUBMENU_ALARM_SET
+         └─ SUBMENU_DIMMER
+
+   Alarm wywłaszcza dowolny ekran (UI_EVT_ALARM obsługuje MENU_UI_STATE), a po
+   STOP/SNOOZE wracamy przez historię dokładnie do ekranu, który był otwarty.
+   -----------------------------------------------------------------------------*/
 
-    // Parametry
-    const uint32_t SAMPLE_INTERVAL   = 20;  // co ile ms bierzemy nową próbkę
-    const uint32_t LOCKOUT_MS        = 50;  // przez ile ms „trzymamy” wciśnięcie
-    const int      DEBOUNCE_THRESHOLD= 2;   // min. liczba 0 w 3 próbkach
+#define MENU_HSM_DEPTH  3U   // maksymalne zagnieżdżenie stanów (z zapasem)
 
-    uint32_t now = HAL_GetTick();
+typedef struct
+{
+    MenuState parent;                                      // MENU_STATE_NONE = stan najwyższego poziomu
+    void (*entry)(Lcd_HandleTypeDef *lcd);                 // akcja wejścia (rysuje ekran)
+    void (*exit)(Lcd_HandleTypeDef *lcd);                  // akcja wyjścia
+    bool (*handle)(const UiEvent_t *evt, Lcd_HandleTypeDef *lcd);  // true = zdarzenie obsłużone
+    MenuState *history;                                    // stan złożony: gdzie zapamiętać liść przy wyjściu
+} MenuStateDesc_t;
 
-    // 1. Jeśli trwa lockout, zawsze zwracamy true (przycisk wciąż "wciśnięty")
-    if (now < lockoutUntil)
-    {
-        return true;
-    }
+static const MenuStateDesc_t stateTable[MENU_STATE_COUNT];
 
-    // 2. Czy czas na kolejną próbkę?
-    if ((now - lastSampleTime) < SAMPLE_INTERVAL)
+_Static_assert(MENU_STATE_COUNT <= PROF_HANDLE_SLOTS, "za mało miejsc profilera na handlery stanów");
+
+static MenuState uiHistory = MENU_STATE;                  // ostatni ekran przed wywłaszczeniem
+static uint8_t   pendingEvents = 0;                       // zdarzenia zgłoszone przez Menu_Post (maska bitowa)
+
+/**
+ * @brief Ścieżka od stanu do korzenia: path[0] = s, path[n-1] = stan najwyższego poziomu.
+ * @return Długość ścieżki (0 dla MENU_STATE_NONE).
+ */
+static uint8_t Menu_Path(MenuState s, MenuState path[MENU_HSM_DEPTH])
+{
+    uint8_t n = 0;
+    while ((s < MENU_STATE_COUNT) && (n < MENU_HSM_DEPTH))
     {
-        int countPressed = 0;
-        for (int i = 0; i < 3; i++)
-        {
-            if (samples[i] == 0) countPressed++;
-        }
-        return (countPressed >= DEBOUNCE_THRESHOLD);
+        path[n++] = s;
+        s = stateTable[s].parent;
     }
+    return n;
+}
 
-    // Czas na pobranie nowej próbki
-    lastSampleTime = now;
-
-    // Odczyt stanu pinu (0 = wciśnięty, 1 = niewciśnięty)
-    samples[idx] = HAL_GPIO_ReadPin(ENCODER_BTN_GPIO_Port, ENCODER_BTN_Pin);
-    idx = (idx + 1) % 3; // przesuwamy indeks w kółko
+/**
+ * @brief Przejście do stanu target: wyjście ze stanów do wspólnego przodka,
+ *        potem wejście w dół do target. Przejście do samego siebie odświeża ekran
+ *        (wyjście i ponowne wejście w liść).
+ */
+static void Menu_Transition(Lcd_HandleTypeDef *lcd, MenuState target)
+{
+    MenuState src[MENU_HSM_DEPTH];
+    MenuState dst[MENU_HSM_DEPTH];
+    uint8_t ns = Menu_Path(gState, src);
+    uint8_t nd = Menu_Path(target, dst);
 
-    // Liczymy, ile z 3 próbek to 0
-    int pressedCount = 0;
-    for (int i = 0; i < 3; i++)
+    // Wspólna część obu ścieżek (od korzenia) zostaje nietknięta
+    while ((ns > 1U) && (nd > 1U) && (src[ns - 1U] == dst[nd - 1U]))
     {
-        if (samples[i] == 0) pressedCount++;
+        ns--;
+        nd--;
     }
 
-    // Jeśli co najmniej 2 z 3 to "0", przycisk wciśnięty:
-    if (pressedCount >= DEBOUNCE_THRESHOLD)
+    for (uint8_t i = 0; i < ns; i++)
     {
-        lockoutUntil = now + LOCKOUT_MS;
-        return true;
+        const MenuStateDesc_t *d = &stateTable[src[i]];
+        if (d->history != NULL)
+        {
+            *d->history = gState;
+        }
+        if (d->exit != NULL)
+        {
+            d->exit(lcd);
+        }
     }
 
-    // W przeciwnym razie nie wciśnięty
-    return false;
+    gState = target;
+    TRACE(TRACE_EVT_STATE, target);
+
+    for (uint8_t i = nd; i > 0U; i--)
+    {
+        const MenuStateDesc_t *d = &stateTable[dst[i - 1U]];
+        if (d->entry != NULL)
+        {
+            d->entry(lcd);
+        }
+    }
 }
 
 /**
- * @brief Obsługa stanu MENU_STATE.
- * @param val Odczyt z enkodera (0=lewo,1=prawo, -1=brak)
- * @param now Aktualny czas (HAL_GetTick())
+ * @brief Przekazanie zdarzenia bieżącemu stanowi, a w razie braku obsługi – w górę hierarchii.
  */
-void HandleMenuState(int val, uint32_t now, Lcd_HandleTypeDef *lcd)
+static void Menu_DispatchEvent(const UiEvent_t *evt, Lcd_HandleTypeDef *lcd)
 {
-    extern uint32_t lastEncMove;
-    extern uint32_t lastBtnPress;
+    MenuState s = gState;
 
-    // 1. Obrót enkodera (lewo/prawo)
-    switch (val)
+    while (s < MENU_STATE_COUNT)
     {
-    case 0:
-    case 1:
-        if ((now - lastEncMove) >= 500)
+        const MenuStateDesc_t *d = &stateTable[s];
+        if (d->handle != NULL)
         {
-            lastEncMove = now;
-            if (val == 0)
-            {
-                menuIndex--;
-                if (menuIndex < 0) menuIndex = menuCount - 1;
-            }
-            else
+            PROF_BEGIN(handle);
+            bool handled = d->handle(evt, lcd);
+            PROF_END(handle, PROF_HANDLE + s);
+            if (handled)
             {
-                menuIndex++;
-                if (menuIndex >= menuCount) menuIndex = 0;
+                return;
             }
-            Menu_Display(lcd, menuIndex, false);
         }
-        break;
+        s = d->parent;
+    }
+}
 
-    default:
-        // -1 => brak obrotu
-        break;
+/* ----------------------------------------------------------------------------
+   Silnik menu: stos otwartych list (menu + pozycja kursora). Pozycje opisują
+   stałe tabele z menu.c; tutaj jest jedna obsługa dla każdego rodzaju pozycji.
+   -----------------------------------------------------------------------------*/
+
+#define MENU_DEPTH_MAX  4U
+
+typedef struct
+{
+    const Menu_t *menu;   // otwarta lista
+    int8_t cursor;        // zaznaczona pozycja
+} MenuFrame_t;
+
+static MenuFrame_t menuStack[MENU_DEPTH_MAX];
+static uint8_t     menuDepth = 0;                     // indeks listy na szczycie stosu
+
+static const MenuItem_t *activeItem = NULL;           // pozycja TOGGLE/VALUE w edycji
+static uint16_t          editValue  = 0;              // niezatwierdzona wartość VALUE
+static uint16_t          shownReadback = 0;           // odczyt pokazany przy edycji VALUE
+static void (*activeView)(Lcd_HandleTypeDef *lcd) = NULL;  // widok OPTION_STATE
+static bool              blinkOn   = true;            // mruganie pola w SUBMENU_ALARM_SET
+static uint32_t          lastBlink = 0;
+static uint8_t           shownPos  = 0;               // pozycja ściemniacza na ekranie
+static int8_t            alarmChoice = 0;             // 0 = STOP, 1 = SNOOZE
+
+/**
+ * @brief Start silnika: menu główne, pierwsza pozycja.
+ */
+void Menu_Start(Lcd_HandleTypeDef *lcd)
+{
+    menuDepth = 0;
+    menuStack[0].menu   = &mainMenu;
+    menuStack[0].cursor = 0;
+    uiHistory = MENU_STATE;
+
+    // Start "znikąd" – wykonują się wszystkie akcje wejścia aż do MENU_STATE
+    gState = MENU_STATE_NONE;
+    Menu_Transition(lcd, MENU_STATE);
+}
+
+/* ----------------------------------------------------------------------------
+   Kontekst ekranu do wznowienia po resecie (resume.c): liść automatu i kursory
+   otwartych list, razem 14 bitów. Ekrany edycji wracają do listy
+   (niezatwierdzona wartość przepada).
+   -----------------------------------------------------------------------------*/
+
+#define CTX_DEPTH_SHIFT   3U
+#define CTX_CURSOR_SHIFT  5U
+#define CTX_CURSOR_BITS   3U
+#define CTX_CURSOR_MASK   ((1U << CTX_CURSOR_BITS) - 1U)
+#define CTX_FRAMES        3U
+
+_Static_assert(MENU_STATE_COUNT <= 8, "stan zapisywany na 3 bitach");
+_Static_assert(MENU_ITEMS_MAX <= (1U << CTX_CURSOR_BITS), "kursor zapisywany na CTX_CURSOR_BITS bitach");
+
+uint16_t Menu_SaveContext(void)
+{
+    uint8_t  depth = (menuDepth < CTX_FRAMES) ? menuDepth : (CTX_FRAMES - 1U);
+    uint16_t ctx   = (uint16_t)((uint16_t)gState & 0x07U) | (uint16_t)(depth << CTX_DEPTH_SHIFT);
+
+    for (uint8_t i = 0; i <= depth; i++)
+    {
+        ctx |= (uint16_t)(((uint16_t)menuStack[i].cursor & CTX_CURSOR_MASK) << (CTX_CURSOR_SHIFT + CTX_CURSOR_BITS * i));
     }
+    return ctx;
+}
 
-    // 2. Wciśnięcie przycisku (zaawansowany debouncing)
-    bool pressed = CheckDebouncedButton();
-    if (pressed && ((now - lastBtnPress) >= 500))
+bool Menu_RestoreContext(Lcd_HandleTypeDef *lcd, uint16_t ctx)
+{
+    MenuState     leaf  = (MenuState)(ctx & 0x07U);
+    uint8_t       depth = (uint8_t)((ctx >> CTX_DEPTH_SHIFT) & 0x03U);
+    const Menu_t *menu  = &mainMenu;
+    MenuFrame_t   frames[CTX_FRAMES];
+
+    if (depth >= CTX_FRAMES)
     {
-        lastBtnPress = now;
+        return false;
+    }
 
-        // Reagujemy w zależności od menuIndex
-        if (menuIndex == 1)
-        {
-            currentSubMenuIndex = 0;
-            gState = SUBMENU_ALARM;
-            DisplayAlarmMenu(lcd, currentSubMenuIndex);
-        }
-        else if (menuIndex == 2)
+    // Odbudowa stosu list: kursor listy nadrzędnej wskazuje otwarte podmenu
+    for (uint8_t i = 0; ; i++)
+    {
+        uint8_t cursor = (uint8_t)((ctx >> (CTX_CURSOR_SHIFT + CTX_CURSOR_BITS * i)) & CTX_CURSOR_MASK);
+        if (cursor >= menu->count)
         {
-            currentSubMenuIndex = 0;
-            gState = SUBMENU_2;
-            DisplaySubMenuON_OFF(lcd, currentSubMenuIndex, usb_OnOff);
+            return false;
         }
-        else if (menuIndex == 3)
+        frames[i].menu   = menu;
+        frames[i].cursor = (int8_t)cursor;
+
+        if (i == depth)
         {
-            currentSubMenuIndex = 0;
-            gState = SUBMENU_2B;
-            DisplaySubMenuON_OFF(lcd, currentSubMenuIndex, usb2_OnOff);
+            break;
         }
-        else if (menuIndex == 4)
+        if (menu->items[cursor].type != MENU_ITEM_SUBMENU)
         {
-            currentSubMenuIndex = 0;
-            gState = SUBMENU_L_BULB;
-            DisplaySubMenuON_OFF(lcd, currentSubMenuIndex, l_BulbOnOff);
+            return false;
         }
-        else
+        menu = menu->items[cursor].u.submenu;
+    }
+
+    for (uint8_t i = 0; i <= depth; i++)
+    {
+        menuStack[i] = frames[i];
+    }
+    menuDepth = depth;
+    uiHistory = MENU_STATE;
+    gState    = MENU_STATE_NONE;
+    Menu_Transition(lcd, MENU_STATE);
+
+    // Ekrany otwierane akcją pozycji – ta sama akcja co przy wciśnięciu
+    const MenuItem_t *item = &menu->items[menuStack[depth].cursor];
+    switch (leaf)
+    {
+    case OPTION_STATE:
+    case SUBMENU_DIMMER:
+        if (item->type == MENU_ITEM_ACTION)
         {
-            // Pozostałe przypadki => OPTION_STATE
-            Menu_ShowOption(lcd, menuIndex, &hi2c1);
-            gState = OPTION_STATE;
+            item->u.action(lcd);
         }
+        break;
+
+    case ALARM_TRIGGERED:
+        Menu_Transition(lcd, ALARM_TRIGGERED);
+        break;
+
+    default:
+        break;
     }
+    return true;
+}
+
+/**
+ * @brief Powrót z ekranu do listy na szczycie stosu (z zachowanym kursorem).
+ */
+void Menu_Back(Lcd_HandleTypeDef *lcd)
+{
+    Menu_Transition(lcd, MENU_STATE);
+}
+
+/**
+ * @brief Otwarcie widoku informacyjnego (odświeżany co sekundę RTC, wyjście przyciskiem).
+ */
+void Menu_OpenView(Lcd_HandleTypeDef *lcd, void (*view)(Lcd_HandleTypeDef *lcd))
+{
+    activeView = view;
+    Menu_Transition(lcd, OPTION_STATE);
 }
 
 /**
- * @brief Obsługa stanu OPTION_STATE (np. TIME lub SENSOR).
+ * @brief Akcja pozycji ALARM/SET – ekran ustawiania alarmu.
  */
-void HandleOptionState(int val, uint32_t now, Lcd_HandleTypeDef *lcd)
+void Menu_OpenAlarmSet(Lcd_HandleTypeDef *lcd)
 {
-    extern uint32_t lastTimeUpdate;
-    extern uint32_t lastBtnPress;
+    alarmSetIndex = 0;
+    Menu_Transition(lcd, SUBMENU_ALARM_SET);
+}
+
+/**
+ * @brief Akcja pozycji DIMMER – ekran ściemniacza.
+ */
+void Menu_OpenDimmer(Lcd_HandleTypeDef *lcd)
+{
+    Menu_Transition(lcd, SUBMENU_DIMMER);
+}
+
+/**
+ * @brief Zgłoszenie zdarzenia spoza automatu (np. z CheckAlarmTrigger).
+ *        Zostanie obsłużone na początku najbliższego Menu_Dispatch.
+ */
+void Menu_Post(UiEventType_e type)
+{
+    pendingEvents |= (uint8_t)(1U << type);
+}
 
-    // Wciśnięcie przycisku = powrót do MENU
-    bool pressed = CheckDebouncedButton();
-    if (pressed && ((now - lastBtnPress) >= 500))
+/* ----------------------------------------------------------------------------
+   Akcje wejścia/wyjścia. Wejście tylko rysuje stan zastany w zmiennych
+   (kursor, edytowana wartość, pole alarmu), dzięki czemu powrót przez historię
+   odtwarza ekran dokładnie takim, jaki był.
+   -----------------------------------------------------------------------------*/
+
+static void EnterMenuState(Lcd_HandleTypeDef *lcd)
+{
+    MenuFrame_t *top = &menuStack[menuDepth];
+    Menu_Display(lcd, top->menu, top->cursor, true);
+}
+
+static void EnterOptionState(Lcd_HandleTypeDef *lcd)
+{
+    activeView(lcd);
+}
+
+static void EnterToggleState(Lcd_HandleTypeDef *lcd)
+{
+    DisplaySubMenuON_OFF(lcd, currentSubMenuIndex, activeItem->u.toggle.get() ? 1 : 2);
+}
+
+static void EnterValueState(Lcd_HandleTypeDef *lcd)
+{
+    const MenuValue_t *v = &activeItem->u.value;
+    shownReadback = (v->readback != NULL) ? v->readback() : 0U;
+    DisplayValueEdit(lcd, activeItem, editValue);
+}
+
+static void EnterAlarmSetState(Lcd_HandleTypeDef *lcd)
+{
+    blinkOn   = true;
+    lastBlink = HAL_GetTick();
+    DisplayAlarmSet(lcd, alarmSetIndex, blinkOn);
+}
+
+/**
+ * @brief Ściemniacz przejmuje lampę od fade i regulatora. Rozpoczęta rampa
+ *        (np. STOP alarmu przed powrotem przez historię) kończy się od razu.
+ */
+static void EnterDimmerState(Lcd_HandleTypeDef *lcd)
+{
+    LampReg_Disable();
+    if (g_fadeHandle.isActive && (g_fadeHandle.mode == FADE_MODE_SINGLE))
     {
-        lastBtnPress = now;
-        Menu_Display(lcd, menuIndex, true);
-        gState = MENU_STATE;
+        LedFade_RetargetTo(&g_fadeHandle, g_fadeHandle.toLevel, 0);
     }
-    else
+    LedFade_Stop(&g_fadeHandle);
+    Dimmer_Enter(&henc, &htim3, TIM_CHANNEL_4);
+
+    shownPos = Dimmer_GetPosition();
+    DisplayDimmer(lcd, shownPos, true);
+}
+
+/**
+ * @brief Wyjście ze ściemniacza – ustawiona jasność zostaje na lampie.
+ */
+static void ExitDimmerState(Lcd_HandleTypeDef *lcd)
+{
+    Dimmer_Exit();
+    l_BulbOnOff = (Dimmer_GetPosition() > 0) ? 1 : 2;
+}
+
+/**
+ * @brief Wejście w alarm – alarm przejmuje lampę od regulatora.
+ *        Jeśli lampka jest wyłączona, uruchamiamy "oddychanie" (chyba że skipLamp = true).
+ *        Gdy wcześniej wystartował świt, jego obwiednia sama przechodzi w błyski.
+ */
+static void EnterAlarmTriggered(Lcd_HandleTypeDef *lcd)
+{
+    extern bool skipLamp;
+
+    LampReg_Disable();
+
+    if ((l_BulbOnOff == 2) && !skipLamp)
     {
-        // Odświeżanie widoku co 1s (pomiar czujnika, wyświetlanie czasu)
-        if ((now - lastTimeUpdate) >= 1000)
-        {
-            Menu_ShowOption(lcd, menuIndex, &hi2c1);
-            lastTimeUpdate = now;
-        }
+        l_BulbOnOff = 1;
+        LedFade_PlayEnvelope(&g_fadeHandle, &ENV_BREATH);
     }
+
+    alarmChoice = 0;
+    DisplayAlarmTriggered(lcd, alarmChoice);
+}
+
+static void ExitAlarmTriggered(Lcd_HandleTypeDef *lcd)
+{
+    extern bool alarmIsActive;
+    alarmIsActive = false;
 }
 
+/* ----------------------------------------------------------------------------
+   Handlery zdarzeń.
+   -----------------------------------------------------------------------------*/
+
 /**
- * @brief Obsługa stanu SUBMENU_2 – sterowanie USB1 (ON/OFF/BACK).
+ * @brief Stan złożony MENU_UI_STATE – alarm wywłaszcza dowolny ekran.
  */
-void HandleSubMenu2State(int val, uint32_t now, Lcd_HandleTypeDef *lcd)
+static bool HandleUiState(const UiEvent_t *evt, Lcd_HandleTypeDef *lcd)
 {
-    extern uint32_t lastEncMove;
-    extern uint32_t lastBtnPress;
+    if (evt->type == UI_EVT_ALARM)
+    {
+        Menu_Transition(lcd, ALARM_TRIGGERED);
+        return true;
+    }
+    return false;
+}
 
-    // Obrót enkodera
-    if (val == 0 || val == 1)
+/**
+ * @brief Obsługa stanu MENU_STATE – przeglądanie dowolnej listy menu.
+ */
+static bool HandleMenuState(const UiEvent_t *evt, Lcd_HandleTypeDef *lcd)
+{
+    MenuFrame_t *top = &menuStack[menuDepth];
+
+    // 1. Obrót enkodera – wszystkie ząbki od poprzedniego obiegu naraz
+    if (evt->type == UI_EVT_ROTATE)
     {
-        if ((now - lastEncMove) >= 500)
-        {
-            lastEncMove = now;
-            if (val == 0)
-            {
-                currentSubMenuIndex--;
-                if (currentSubMenuIndex < 0) currentSubMenuIndex = 2;
-            }
-            else
-            {
-                currentSubMenuIndex++;
-                if (currentSubMenuIndex > 2) currentSubMenuIndex = 0;
-            }
-            DisplaySubMenuON_OFF(lcd, currentSubMenuIndex, usb_OnOff);
-        }
+        top->cursor = WrapRange(top->cursor, evt->arg, 0, top->menu->count - 1);
+        Menu_Display(lcd, top->menu, top->cursor, false);
+        return true;
     }
 
-    // Wciśnięcie przycisku
-    bool pressed = CheckDebouncedButton();
-    if (pressed && ((now - lastBtnPress) >= 500))
+    // 2. Wciśnięcie przycisku – akcja zależna od rodzaju pozycji
+    if (IsPress(evt))
     {
-        lastBtnPress = now;
-        switch (currentSubMenuIndex)
+        const MenuItem_t *item = &top->menu->items[top->cursor];
+
+        switch (item->type)
         {
-        case 0: // ON
-            if (usb_OnOff != 1)
+        case MENU_ITEM_SUBMENU:
+            if ((menuDepth + 1U) < MENU_DEPTH_MAX)
             {
-                usb_OnOff = 1;
-                HAL_GPIO_WritePin(USB1_EN_GPIO_Port, USB1_EN_Pin, GPIO_PIN_SET);
-                DisplaySubMenuON_OFF(lcd, currentSubMenuIndex, usb_OnOff);
+                menuDepth++;
+                menuStack[menuDepth].menu   = item->u.submenu;
+                menuStack[menuDepth].cursor = 0;
+                Menu_Display(lcd, item->u.submenu, 0, true);
             }
             break;
-        case 1: // OFF
-            if (usb_OnOff != 2)
+
+        case MENU_ITEM_TOGGLE:
+            activeItem = item;
+            currentSubMenuIndex = 0;
+            Menu_Transition(lcd, MENU_TOGGLE_STATE);
+            break;
+
+        case MENU_ITEM_VALUE:
+            activeItem = item;
+            editValue  = *item->u.value.var;
+            Menu_Transition(lcd, MENU_VALUE_STATE);
+            break;
+
+        case MENU_ITEM_ACTION:
+            item->u.action(lcd);
+            break;
+
+        case MENU_ITEM_BACK:
+            if (menuDepth > 0U)
             {
-                usb_OnOff = 2;
-                HAL_GPIO_WritePin(USB1_EN_GPIO_Port, USB1_EN_Pin, GPIO_PIN_RESET);
-                DisplaySubMenuON_OFF(lcd, currentSubMenuIndex, usb_OnOff);
+                menuDepth--;
             }
+            Menu_Back(lcd);
             break;
-        case 2: // BACK
-            gState = MENU_STATE;
-            Menu_Display(lcd, menuIndex, true);
+
+        default:
             break;
         }
+        return true;
     }
+    return false;
 }
 
 /**
- * @brief Obsługa stanu SUBMENU_2B – sterowanie USB2 (ON/OFF/BACK).
+ * @brief Obsługa stanu OPTION_STATE (widok TIME lub SENSOR).
  */
-void HandleSubMenu2BState(int val, uint32_t now, Lcd_HandleTypeDef *lcd)
+static bool HandleOptionState(const UiEvent_t *evt, Lcd_HandleTypeDef *lcd)
 {
-    extern uint32_t lastEncMove;
-    extern uint32_t lastBtnPress;
-
-    // Obrót enkodera
-    if (val == 0 || val == 1)
+    // Wciśnięcie przycisku = powrót do listy
+    if (IsPress(evt))
     {
-        if ((now - lastEncMove) >= 500)
-        {
-            lastEncMove = now;
-            if (val == 0)
-            {
-                currentSubMenuIndex--;
-                if (currentSubMenuIndex < 0) currentSubMenuIndex = 2;
-            }
-            else
-            {
-                currentSubMenuIndex++;
-                if (currentSubMenuIndex > 2) currentSubMenuIndex = 0;
-            }
-            DisplaySubMenuON_OFF(lcd, currentSubMenuIndex, usb2_OnOff);
-        }
+        Menu_Back(lcd);
+        return true;
     }
 
-    // Wciśnięcie przycisku
-    bool pressed = CheckDebouncedButton();
-    if (pressed && ((now - lastBtnPress) >= 500))
+    // Odświeżanie widoku na granicy sekundy RTC (wyświetlanie czasu, pomiar czujnika)
+    if (evt->type == UI_EVT_SECOND)
     {
-        lastBtnPress = now;
-        switch (currentSubMenuIndex)
-        {
-        case 0: // ON
-            if (usb2_OnOff != 1)
-            {
-                usb2_OnOff = 1;
-                HAL_GPIO_WritePin(USB2_EN_GPIO_Port, USB2_EN_Pin, GPIO_PIN_SET);
-                DisplaySubMenuON_OFF(lcd, currentSubMenuIndex, usb2_OnOff);
-            }
-            break;
-        case 1: // OFF
-            if (usb2_OnOff != 2)
-            {
-                usb2_OnOff = 2;
-                HAL_GPIO_WritePin(USB2_EN_GPIO_Port, USB2_EN_Pin, GPIO_PIN_RESET);
-                DisplaySubMenuON_OFF(lcd, currentSubMenuIndex, usb2_OnOff);
-            }
-            break;
-        case 2: // BACK
-            gState = MENU_STATE;
-            Menu_Display(lcd, menuIndex, true);
-            break;
-        }
+        activeView(lcd);
+        return true;
     }
+    return false;
 }
 
 /**
- * @brief Obsługa stanu SUBMENU_L_BULB – sterowanie żarówką (ON/OFF/BACK).
+ * @brief Obsługa stanu MENU_TOGGLE_STATE – wspólny ekran ON/OFF/BACK.
  */
-void HandleSubMenuLBState(int val, uint32_t now, Lcd_HandleTypeDef *lcd)
+static bool HandleToggleState(const UiEvent_t *evt, Lcd_HandleTypeDef *lcd)
 {
-    extern uint32_t lastEncMove;
-    extern uint32_t lastBtnPress;
-    extern LedFadeHandle_t g_fadeHandle;
+    const MenuToggle_t *t = &activeItem->u.toggle;
 
     // Obrót enkodera
-    if (val == 0 || val == 1)
+    if (evt->type == UI_EVT_ROTATE)
     {
-        if ((now - lastEncMove) >= 500)
-        {
-            lastEncMove = now;
-            if (val == 0)
-            {
-                currentSubMenuIndex--;
-                if (currentSubMenuIndex < 0) currentSubMenuIndex = 2;
-            }
-            else
-            {
-                currentSubMenuIndex++;
-                if (currentSubMenuIndex > 2) currentSubMenuIndex = 0;
-            }
-            DisplaySubMenuON_OFF(lcd, currentSubMenuIndex, l_BulbOnOff);
-        }
+        currentSubMenuIndex = WrapRange(currentSubMenuIndex, evt->arg, 0, 2);
+        DisplaySubMenuON_OFF(lcd, currentSubMenuIndex, t->get() ? 1 : 2);
+        return true;
     }
 
     // Wciśnięcie przycisku
-    bool pressed = CheckDebouncedButton();
-    if (pressed && ((now - lastBtnPress) >= 500))
+    if (IsPress(evt))
     {
-        lastBtnPress = now;
         switch (currentSubMenuIndex)
         {
         case 0: // ON
-            if (l_BulbOnOff != 1)
-            {
-                l_BulbOnOff = 1;
-                LedFade_Start(&g_fadeHandle, &htim3, TIM_CHANNEL_4,
-                              FADE_IN,  // kierunek
-                              100,      // steps
-                              1000);
-                DisplaySubMenuON_OFF(lcd, currentSubMenuIndex, l_BulbOnOff);
-            }
+            t->set(true);
+            DisplaySubMenuON_OFF(lcd, currentSubMenuIndex, t->get() ? 1 : 2);
             break;
         case 1: // OFF
-            if (l_BulbOnOff != 2)
-            {
-                l_BulbOnOff = 2;
-                LedFade_Start(&g_fadeHandle, &htim3, TIM_CHANNEL_4,
-                              FADE_OUT, // kierunek
-                              100,
-                              1000);
-                DisplaySubMenuON_OFF(lcd, currentSubMenuIndex, l_BulbOnOff);
-            }
+            t->set(false);
+            DisplaySubMenuON_OFF(lcd, currentSubMenuIndex, t->get() ? 1 : 2);
             break;
         case 2: // BACK
-            gState = MENU_STATE;
-            Menu_Display(lcd, menuIndex, true);
+            Menu_Back(lcd);
             break;
         }
+        return true;
     }
+    return false;
 }
 
 /**
- * @brief Obsługa stanu SUBMENU_ALARM (SET / L_Sensor / BACK).
+ * @brief Obsługa stanu MENU_VALUE_STATE – edycja wartości (z przyspieszeniem).
  */
-void HandleSubMenuAlarmState(int val, uint32_t now, Lcd_HandleTypeDef *lcd)
+static bool HandleValueState(const UiEvent_t *evt, Lcd_HandleTypeDef *lcd)
 {
-    extern uint32_t lastEncMove;
-    extern uint32_t lastBtnPress;
-    extern int8_t lightSensorMode; // 1=ON, 2=OFF
-    extern int8_t sensorSubIndex;
+    const MenuValue_t *v = &activeItem->u.value;
 
-    if (val == 0 || val == 1)
+    if (evt->type == UI_EVT_ROTATE)
     {
-        if ((now - lastEncMove) >= 500)
-        {
-            lastEncMove = now;
-            if (val == 0)
-            {
-                currentSubMenuIndex--;
-                if (currentSubMenuIndex < 0) currentSubMenuIndex = 2;
-            }
-            else
-            {
-                currentSubMenuIndex++;
-                if (currentSubMenuIndex > 2) currentSubMenuIndex = 0;
-            }
-            DisplayAlarmMenu(lcd, currentSubMenuIndex);
-        }
+        int32_t x = (int32_t)editValue +
+                    (int32_t)REncoder_Accelerate(&editAccel, evt->arg, evt->now, EDIT_ACCEL_MAX_STEP) *
+                    (int32_t)v->step;
+        if (x < (int32_t)v->min) x = v->min;
+        if (x > (int32_t)v->max) x = v->max;
+        editValue = (uint16_t)x;
+        DisplayValueEdit(lcd, activeItem, editValue);
+        return true;
     }
 
-    bool pressed = CheckDebouncedButton();
-    if (pressed && ((now - lastBtnPress) >= 500))
+    if ((evt->type == UI_EVT_TICK) && (v->readback != NULL) && (v->readback() != shownReadback))
     {
-        lastBtnPress = now;
-        switch (currentSubMenuIndex)
-        {
-        case 0: // SET
-            alarmSetIndex = 0;
-            gState = SUBMENU_ALARM_SET;
-            DisplayAlarmSet(lcd, alarmSetIndex, true);
-            break;
-
-        case 1: // L_Sensor
-            gState = SUBMENU_ALARM_LSENSOR;
-            sensorSubIndex = 0;
-            DisplaySubMenuON_OFF(lcd, sensorSubIndex, lightSensorMode);
-            break;
+        // Nowy odczyt (np. kolejna próbka czujnika)
+        shownReadback = v->readback();
+        DisplayValueEdit(lcd, activeItem, editValue);
+        return true;
+    }
 
-        case 2: // BACK
-            gState = MENU_STATE;
-            Menu_Display(lcd, menuIndex, true);
-            break;
+    // Wciśnięcie przycisku – zatwierdzenie
+    if (IsPress(evt))
+    {
+        *v->var = editValue;
+        if (v->commit != NULL)
+        {
+            v->commit(editValue);
         }
+        Menu_Back(lcd);
+        return true;
     }
+    return false;
 }
 
 /**
  * @brief Obsługa stanu SUBMENU_ALARM_SET – edycja (day, month, year, hour, min, sec).
  */
-void HandleSubMenuAlarmSetState(int val, uint32_t now, Lcd_HandleTypeDef *lcd)
+static bool HandleSubMenuAlarmSetState(const UiEvent_t *evt, Lcd_HandleTypeDef *lcd)
 {
-    extern uint32_t lastEncMove;
-    extern uint32_t lastBtnPress;
-
-    static bool blinkOn      = true;
-    static uint32_t lastBlink= 0;
-
     // Mruganie kursora co 500 ms
-    if ((now - lastBlink) >= 500)
+    if (evt->type == UI_EVT_TICK)
     {
-        blinkOn = !blinkOn;
-        lastBlink = now;
-        DisplayAlarmSet(lcd, alarmSetIndex, blinkOn);
+        if ((evt->now - lastBlink) >= 500)
+        {
+            blinkOn = !blinkOn;
+            lastBlink = evt->now;
+            DisplayAlarmSet(lcd, alarmSetIndex, blinkOn);
+        }
+        return true;
     }
 
     // Obrót enkodera
-    if (val == 0 || val == 1)
+    if (evt->type == UI_EVT_ROTATE)
     {
-        if ((now - lastEncMove) >= 350)
-        {
-            lastEncMove = now;
-            int dir = (val == 0) ? -1 : +1;
+        // Szybki obrót = większy krok (0 -> 59 minut jednym ruchem)
+        int delta = REncoder_Accelerate(&editAccel, evt->arg, evt->now, EDIT_ACCEL_MAX_STEP);
 
-            switch (alarmSetIndex)
-            {
-            case 0: // day
-                alarmData.day += dir;
-                if (alarmData.day < 1)  alarmData.day = 31;
-                if (alarmData.day > 31) alarmData.day = 1;
-                break;
-            case 1: // month
-                alarmData.month += dir;
-                if (alarmData.month < 1)  alarmData.month = 12;
-                if (alarmData.month > 12) alarmData.month = 1;
-                break;
-            case 2: // year
-                alarmData.year += dir;
-                if (alarmData.year > 99) alarmData.year = 0;
-                if (alarmData.year < 0)  alarmData.year = 99;
-                break;
-            case 3: // hour
-                alarmData.hour += dir;
-                if (alarmData.hour < 0)   alarmData.hour = 23;
-                if (alarmData.hour > 23)  alarmData.hour = 0;
-                break;
-            case 4: // minute
-                alarmData.minute += dir;
-                if (alarmData.minute < 0)  alarmData.minute = 59;
-                if (alarmData.minute > 59) alarmData.minute = 0;
-                break;
-            case 5: // second
-                alarmData.second += dir;
-                if (alarmData.second < 0)  alarmData.second = 59;
-                if (alarmData.second > 59) alarmData.second = 0;
-                break;
-            }
-            DisplayAlarmSet(lcd, alarmSetIndex, blinkOn);
+        switch (alarmSetIndex)
+        {
+        case 0: // day – zakres wg długości miesiąca (bez 31.02)
+            alarmData.day = WrapRange(alarmData.day, delta, 1,
+                                      Cal_DaysInMonth((uint8_t)alarmData.year, (uint8_t)alarmData.month));
+            break;
+        case 1: // month
+            alarmData.month = WrapRange(alarmData.month, delta, 1, 12);
+            break;
+        case 2: // year
+            alarmData.year = WrapRange(alarmData.year, delta, 0, 99);
+            break;
+        case 3: // hour
+            alarmData.hour = WrapRange(alarmData.hour, delta, 0, 23);
+            break;
+        case 4: // minute
+            alarmData.minute = WrapRange(alarmData.minute, delta, 0, 59);
+            break;
+        case 5: // second
+            alarmData.second = WrapRange(alarmData.second, delta, 0, 59);
+            break;
         }
+        // Zmiana miesiąca/roku może skrócić miesiąc (31.01 -> 28.02)
+        Alarm_Normalize();
+        DisplayAlarmSet(lcd, alarmSetIndex, blinkOn);
+        return true;
     }
 
     // Wciśnięcie przycisku – przejście do kolejnego pola lub wyjście
-    bool pressed = CheckDebouncedButton();
-    if (pressed && ((now - lastBtnPress) >= 500))
+    if (IsPress(evt))
     {
-        lastBtnPress = now;
         alarmSetIndex++;
         if (alarmSetIndex > 5)
         {
-            gState = SUBMENU_ALARM;
-            DisplayAlarmMenu(lcd, 0);
+            Alarm_Save();
+            Menu_Back(lcd);
         }
         else
         {
             blinkOn = true;
             DisplayAlarmSet(lcd, alarmSetIndex, blinkOn);
         }
+        return true;
     }
-}
-
-static void UpdateAlarmRow1(Lcd_HandleTypeDef *lcd, int8_t subIndex)
-{
-    char row1[17];
-    memset(row1, ' ', 16);
-    row1[16] = '\0';
-
-    if (subIndex == 0)
-        snprintf(row1, sizeof(row1), ">STOP   SNOOZE");
-    else
-        snprintf(row1, sizeof(row1), " STOP  >SNOOZE");
-
-    // Nadpisujemy TYLKO drugi wiersz
-    Lcd_cursor(lcd, 1, 0);
-    Lcd_string(lcd, row1);
+    return false;
 }
 
 /**
- * @brief Obsługa stanu ALARM_TRIGGERED.
+ * @brief Obsługa stanu ALARM_TRIGGERED – wybór STOP / SNOOZE,
+ *        potem powrót przez historię do przerwanego ekranu.
  */
-void HandleAlarmTriggered(int val, uint32_t now, Lcd_HandleTypeDef *lcd)
+static bool HandleAlarmTriggered(const UiEvent_t *evt, Lcd_HandleTypeDef *lcd)
 {
-    extern bool alarmIsActive;
     extern bool skipLamp;
-    extern uint32_t lastEncMove;
-    extern uint32_t lastBtnPress;
-    extern LedFadeHandle_t g_fadeHandle;
 
-    static int8_t oldSubMenuIndex = -1;
-    static bool firstCall         = true;
-
-    // Jeśli lampka jest wyłączona, uruchamiamy pulsowanie (chyba że skipLamp = true)
-    if (l_BulbOnOff == 2)
-    {
-        if (!skipLamp)
-        {
-            l_BulbOnOff = 1;
-            LedFade_PulseStart(&g_fadeHandle,
-                               &htim3, TIM_CHANNEL_4,
-                               150,    // steps
-                               1500);  // czas FADE_IN (FADE_OUT taki sam)
-        }
-    }
-
-    // Pierwsze wejście w stan ALARM_TRIGGERED
-    if (firstCall)
+    // Alarm już trwa – kolejne zgłoszenie ignorujemy
+    if (evt->type == UI_EVT_ALARM)
     {
-        currentSubMenuIndex = 0;
-        DisplayAlarmTriggered(lcd, currentSubMenuIndex);
-        firstCall = false;
-        oldSubMenuIndex = currentSubMenuIndex;
+        return true;
     }
 
     // Obsługa enkodera
-    if ((val == 0 || val == 1) && ((now - lastEncMove) >= 350))
+    if (evt->type == UI_EVT_ROTATE)
     {
-        lastEncMove = now;
-        int dir = (val == 0) ? -1 : +1;
-        currentSubMenuIndex += dir;
-        if (currentSubMenuIndex < 0) currentSubMenuIndex = 1;
-        if (currentSubMenuIndex > 1) currentSubMenuIndex = 0;
-
-        if (currentSubMenuIndex != oldSubMenuIndex)
-        {
-            UpdateAlarmRow1(lcd, currentSubMenuIndex);
-            oldSubMenuIndex = currentSubMenuIndex;
-        }
+        alarmChoice = WrapRange(alarmChoice, evt->arg, 0, 1);
+        DisplayAlarmTriggered(lcd, alarmChoice);
+        return true;
     }
 
     // Obsługa przycisku STOP / SNOOZE
-    bool pressed = CheckDebouncedButton();
-    if (pressed && ((now - lastBtnPress) >= 500))
+    if (IsPress(evt))
     {
-        lastBtnPress = now;
-
-        if (currentSubMenuIndex == 0)
+        if (alarmChoice == 0)
         {
-            // STOP
-            g_fadeHandle.isActive = false;
+            // STOP – lampa płynnie (od bieżącej jasności) do pełnej jasności
             if (!skipLamp)
             {
-                __HAL_TIM_SET_COMPARE(&htim3, TIM_CHANNEL_4, 0);
+                LedFade_RetargetTo(&g_fadeHandle, LEDFADE_LEVEL_MAX, 500);
                 l_BulbOnOff = 1;
             }
-            alarmIsActive = false;
-            firstCall     = true;
-
-            gState = MENU_STATE;
-            Menu_Display(lcd, menuIndex, true);
         }
         else
         {
-            // SNOOZE (+5 min)
-            alarmData.minute += 5;
-            if (alarmData.minute >= 60)
-            {
-                alarmData.minute -= 60;
-                alarmData.hour++;
-                if (alarmData.hour > 23)
-                {
-                    alarmData.hour = 0;
-                    alarmData.day += 1;
-                }
-            }
+            // SNOOZE (+5 min od teraz, z przeniesieniem daty)
+            Alarm_Snooze(Clock_Now());
 
+            // Trwa pulsowanie/świt – gasimy lampę od bieżącej jasności, bez skoku
             if (g_fadeHandle.isActive)
             {
-                g_fadeHandle.isActive = false;
-                __HAL_TIM_SET_COMPARE(&htim3, TIM_CHANNEL_4, g_fadeHandle.arr);
+                LedFade_RetargetTo(&g_fadeHandle, 0, 500);
                 l_BulbOnOff = 2;
             }
-            alarmIsActive = false;
-            firstCall     = true;
+        }
+
+        Menu_Transition(lcd, uiHistory);
+        return true;
+    }
+    return false;
+}
 
-            gState = MENU_STATE;
-            Menu_Display(lcd, menuIndex, true);
+/**
+ * @brief Obsługa stanu SUBMENU_DIMMER – ściemniacz.
+ *        Obrót obsługują przerwania (Dimmer_EncoderEdge, Dimmer_Tick), tutaj tylko
+ *        odświeżamy ekran i czekamy na wciśnięcie (powrót do menu).
+ */
+static bool HandleSubMenuDimmerState(const UiEvent_t *evt, Lcd_HandleTypeDef *lcd)
+{
+    if (evt->type == UI_EVT_TICK)
+    {
+        uint8_t pos = Dimmer_GetPosition();
+        if (pos != shownPos)
+        {
+            shownPos = pos;
+            DisplayDimmer(lcd, pos, false);
         }
-        return;
+        return true;
+    }
+
+    // Wciśnięcie przycisku – zostawiamy ustawioną jasność i wracamy do menu
+    if (IsPress(evt))
+    {
+        Menu_Back(lcd);
+        return true;
     }
+    return false;
 }
 
+/* ----------------------------------------------------------------------------
+   Tablica stanów – rodzic, akcje wejścia/wyjścia, handler zdarzeń.
+   -----------------------------------------------------------------------------*/
+static const MenuStateDesc_t stateTable[MENU_STATE_COUNT] = {
+    [MENU_UI_STATE]     = { MENU_STATE_NONE, NULL,               NULL,               HandleUiState,              &uiHistory },
+    [MENU_STATE]        = { MENU_UI_STATE,   EnterMenuState,     NULL,               HandleMenuState,            NULL },
+    [OPTION_STATE]      = { MENU_UI_STATE,   EnterOptionState,   NULL,               HandleOptionState,          NULL },
+    [MENU_TOGGLE_STATE] = { MENU_UI_STATE,   EnterToggleState,   NULL,               HandleToggleState,          NULL },
+    [MENU_VALUE_STATE]  = { MENU_UI_STATE,   EnterValueState,    NULL,               HandleValueState,           NULL },
+    [SUBMENU_ALARM_SET] = { MENU_UI_STATE,   EnterAlarmSetState, NULL,               HandleSubMenuAlarmSetState, NULL },
+    [SUBMENU_DIMMER]    = { MENU_UI_STATE,   EnterDimmerState,   ExitDimmerState,    HandleSubMenuDimmerState,   NULL },
+    [ALARM_TRIGGERED]   = { MENU_STATE_NONE, EnterAlarmTriggered, ExitAlarmTriggered, HandleAlarmTriggered,      NULL },
+};
+
 /**
- * @brief Obsługa stanu SUBMENU_ALARM_LSENSOR (ON/OFF/BACK).
+ * @brief Zamiana wejść z bieżącego obiegu pętli na zdarzenia automatu:
+ *        zgłoszone (alarm), przycisk (cała kolejka), obrót, na końcu TICK.
  */
-void HandleSubMenuAlarmLSensorState(int val, uint32_t now, Lcd_HandleTypeDef *lcd)
+void Menu_Dispatch(int val, uint32_t now, Lcd_HandleTypeDef *lcd)
 {
-    extern uint32_t lastEncMove;
-    extern uint32_t lastBtnPress;
+    UiEvent_t evt;
+    ButtonEvent_t btn;
 
-    extern int8_t lightSensorMode;
-    extern int8_t sensorSubIndex;  // 0=ON, 1=OFF, 2=BACK
+    evt.now = now;
 
-    if (val == 0 || val == 1)
+    uint8_t pending = pendingEvents;
+    pendingEvents = 0;
+    for (uint8_t type = 0; pending != 0U; type++, pending >>= 1)
     {
-        if ((now - lastEncMove) >= 350)
+        if (pending & 1U)
         {
-            lastEncMove = now;
-            if (val == 0)
-            {
-                sensorSubIndex--;
-                if (sensorSubIndex < 0) sensorSubIndex = 2;
-            }
-            else
-            {
-                sensorSubIndex++;
-                if (sensorSubIndex > 2) sensorSubIndex = 0;
-            }
-            DisplaySubMenuON_OFF(lcd, sensorSubIndex, lightSensorMode);
+            evt.type = type;
+            evt.arg  = 0;
+            Menu_DispatchEvent(&evt, lcd);
         }
     }
 
-    bool pressed = CheckDebouncedButton();
-    if (pressed && ((now - lastBtnPress) >= 500))
+    while (Button_GetEvent(&btn))
     {
-        lastBtnPress = now;
-        switch (sensorSubIndex)
-        {
-        case 0: // ON
-            lightSensorMode = 1;
-            DisplaySubMenuON_OFF(lcd, sensorSubIndex, lightSensorMode);
-            break;
-        case 1: // OFF
-            lightSensorMode = 2;
-            DisplaySubMenuON_OFF(lcd, sensorSubIndex, lightSensorMode);
-            break;
-        case 2: // BACK
-            gState = SUBMENU_ALARM;
-            DisplayAlarmMenu(lcd, currentSubMenuIndex);
-            break;
-        }
+        evt.type = UI_EVT_BUTTON;
+        evt.arg  = (int16_t)btn.type;
+        Menu_DispatchEvent(&evt, lcd);
     }
+
+    if (val != 0)
+    {
+        evt.type = UI_EVT_ROTATE;
+        evt.arg  = (int16_t)val;
+        Menu_DispatchEvent(&evt, lcd);
+    }
+
+    evt.type = UI_EVT_TICK;
+    evt.arg  = 0;
+    Menu_DispatchEvent(&evt, lcd);
 }
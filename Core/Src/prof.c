@@ -0,0 +1,151 @@
+// Created by: Marcin Dziedzic
+// prof.c
+
+#include "prof.h"
+
+#if PROF_ENABLED
+
+#include "uart_tx.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char *const profNames[PROF_HANDLE] = {
+    [PROF_LOOP]       = "loop",
+    [PROF_RTC_READ]   = "rtc_read",
+    [PROF_LUX_READ]   = "lux_read",
+    [PROF_LCD_STRING] = "lcd_string",
+    [PROF_RENDER]     = "render",
+};
+
+static ProfStat_t profStats[PROF_ID_COUNT];
+static uint32_t   profOverhead = 0;      // koszt samej pary BEGIN/END (cykle)
+static volatile bool dumpRequested = false;
+
+/**
+ * @brief Włączenie DWT CYCCNT i pomiar narzutu pustego obszaru.
+ */
+void Prof_Init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL  |= DWT_CTRL_CYCCNTENA_Msk;
+
+    // Najmniejszy z kilku pomiarów pustego obszaru = narzut odejmowany od wyników
+    profOverhead = 0xFFFFFFFFU;
+    for (uint8_t i = 0; i < 8U; i++)
+    {
+        uint32_t t0 = DWT->CYCCNT;
+        uint32_t dt = DWT->CYCCNT - t0;
+        if (dt < profOverhead)
+        {
+            profOverhead = dt;
+        }
+    }
+
+    Prof_Reset();
+}
+
+void Prof_Reset(void)
+{
+    memset(profStats, 0, sizeof(profStats));
+    for (uint32_t i = 0; i < PROF_ID_COUNT; i++)
+    {
+        profStats[i].min = 0xFFFFFFFFU;
+    }
+}
+
+/**
+ * @brief Dopisanie pomiaru. Przedział histogramu z CLZ – bez pętli i dzielenia.
+ */
+void Prof_Record(uint32_t id, uint32_t cycles)
+{
+    if (id >= PROF_ID_COUNT)
+    {
+        return;
+    }
+
+    ProfStat_t *s = &profStats[id];
+    cycles = (cycles > profOverhead) ? (cycles - profOverhead) : 0U;
+
+    s->count++;
+    s->sum += cycles;
+    if (cycles < s->min) s->min = cycles;
+    if (cycles > s->max) s->max = cycles;
+
+    uint32_t bin = 31U - __CLZ(cycles | 1U);
+    if (bin >= PROF_HIST_BINS)
+    {
+        bin = PROF_HIST_BINS - 1U;
+    }
+    s->hist[bin]++;
+}
+
+const ProfStat_t *Prof_Get(uint32_t id)
+{
+    return (id < PROF_ID_COUNT) ? &profStats[id] : NULL;
+}
+
+void Prof_RequestDump(void)
+{
+    dumpRequested = true;
+}
+
+/**
+ * @brief Zrzut: jedna linia na obszar (count/min/mean/max w cyklach),
+ *        potem niezerowe przedziały histogramu jako "k:n".
+ */
+void Prof_DumpIfRequested(void)
+{
+    if (!dumpRequested)
+    {
+        return;
+    }
+    dumpRequested = false;
+
+    char line[128];
+    int  len = snprintf(line, sizeof(line), "\r\n# prof: cycles @ %lu Hz\r\n",
+                        (unsigned long)SystemCoreClock);
+    UartTx_WriteWait(line, (uint16_t)len, UARTTX_DUMP_WAIT_MS);
+
+    for (uint32_t id = 0; id < PROF_ID_COUNT; id++)
+    {
+        const ProfStat_t *s = &profStats[id];
+        if (s->count == 0U)
+        {
+            continue;
+        }
+
+        char name[16];
+        if (id < PROF_HANDLE)
+        {
+            snprintf(name, sizeof(name), "%s", profNames[id]);
+        }
+        else
+        {
+            snprintf(name, sizeof(name), "handle[%lu]", (unsigned long)(id - PROF_HANDLE));
+        }
+
+        len = snprintf(line, sizeof(line), "%-12s n=%lu min=%lu mean=%lu max=%lu\r\n",
+                       name,
+                       (unsigned long)s->count,
+                       (unsigned long)s->min,
+                       (unsigned long)(s->sum / s->count),
+                       (unsigned long)s->max);
+        UartTx_WriteWait(line, (uint16_t)len, UARTTX_DUMP_WAIT_MS);
+
+        len = snprintf(line, sizeof(line), "  hist");
+        for (uint32_t b = 0; b < PROF_HIST_BINS; b++)
+        {
+            if ((s->hist[b] != 0U) && (len < (int)sizeof(line) - 24))
+            {
+                len += snprintf(line + len, sizeof(line) - (size_t)len, " %lu:%lu",
+                                (unsigned long)b, (unsigned long)s->hist[b]);
+            }
+        }
+        len += snprintf(line + len, sizeof(line) - (size_t)len, "\r\n");
+        UartTx_WriteWait(line, (uint16_t)len, UARTTX_DUMP_WAIT_MS);
+    }
+}
+
+#endif // PROF_ENABLED
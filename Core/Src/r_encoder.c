@@ -17,41 +17,85 @@ void REncoder_Init(REncoder_HandleTypeDef *henc,
 
     // Czyścimy poprzedni stan licznika
     henc->last_count = __HAL_TIM_GET_COUNTER(htim);
+    henc->residue = 0;
+    henc->counts_per_detent = REENCODER_COUNTS_PER_DETENT;
 
     // Start timera w trybie enkodera (dla obu kanałów)
     HAL_TIM_Encoder_Start(henc->htim, TIM_CHANNEL_ALL);
 }
 
 /**
- * @brief Sprawdza, czy nastąpił obrót w prawo/lewo lub wciśnięcie przycisku.
+ * @brief Ustawienie liczby zliczeń na ząbek; niepełny ząbek jest kasowany.
+ */
+void REncoder_SetCountsPerDetent(REncoder_HandleTypeDef *henc, uint8_t counts_per_detent)
+{
+    henc->counts_per_detent = (counts_per_detent > 0) ? counts_per_detent : 1;
+    henc->residue = 0;
+}
+
+/**
+ * @brief Zwraca przyrost w ząbkach (ze znakiem) od poprzedniego odczytu.
  */
 int REncoder_Update(REncoder_HandleTypeDef *henc)
 {
     // Pobieramy obecną wartość licznika
     int16_t current_count = __HAL_TIM_GET_COUNTER(henc->htim);
 
-    // Wyliczamy różnicę od poprzedniego odczytu
+    // Różnica w arytmetyce 16-bit – poprawna także przy przepełnieniu licznika
     int16_t diff = current_count - henc->last_count;
 
     // Aktualizujemy last_count
     henc->last_count = current_count;
 
-    // Jeśli różnica > 0, obrót w prawo
-    if (diff > 0) {
-        return 1;
-    }
-    // Jeśli różnica < 0, obrót w lewo
-    else if (diff < 0) {
+    // Doliczamy do reszty i oddajemy pełne ząbki (dzielenie obcina do zera,
+    // więc reszta zachowuje znak i ruch w obie strony jest symetryczny)
+    henc->residue += diff;
+    int detents = henc->residue / henc->counts_per_detent;
+    henc->residue -= (int16_t)(detents * henc->counts_per_detent);
+
+    return detents;
+}
+
+/**
+ * @brief Przyspieszenie: krok rośnie liniowo z uśrednioną prędkością obrotu.
+ */
+int REncoder_Accelerate(REncoder_AccelTypeDef *acc, int detents, uint32_t now, uint8_t max_step)
+{
+    if (detents == 0)
+    {
         return 0;
     }
-    // Jeśli nie ma ruchu na enkoderze, to sprawdzamy stan przycisku
-    else {
-        // Założenie: aktywny stan niski na przycisku
-        if (HAL_GPIO_ReadPin(henc->btn_port, henc->btn_pin) == GPIO_PIN_RESET) {
-            return 2;
-        }
+
+    // Prędkość = ząbki / czas od poprzedniego ruchu, uśredniona (1/2 nowej próbki)
+    uint32_t dt = now - acc->last_ms;
+    uint32_t n  = (detents < 0) ? (uint32_t)(-detents) : (uint32_t)detents;
+    acc->last_ms = now;
+
+    if (dt >= REENCODER_ACCEL_IDLE_MS)
+    {
+        acc->speed = 0;
+    }
+    else
+    {
+        uint32_t inst = (1000U * n) / ((dt > 0U) ? dt : 1U);
+        if (inst > 0xFFFFU) inst = 0xFFFFU;
+        acc->speed = (uint16_t)((acc->speed + inst) / 2U);
+    }
+
+    int step;
+    if ((acc->speed <= REENCODER_ACCEL_MIN_DPS) || (max_step <= 1))
+    {
+        step = 1;
+    }
+    else if (acc->speed >= REENCODER_ACCEL_MAX_DPS)
+    {
+        step = max_step;
+    }
+    else
+    {
+        step = 1 + (int)(((uint32_t)(acc->speed - REENCODER_ACCEL_MIN_DPS) * (max_step - 1U))
+                         / (REENCODER_ACCEL_MAX_DPS - REENCODER_ACCEL_MIN_DPS));
     }
 
-    // Brak zdarzenia
-    return -1;
+    return detents * step;
 }
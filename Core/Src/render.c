@@ -0,0 +1,185 @@
+// Created by: Marcin Dziedzic
+// render.c
+
+#include "render.h"
+#include "fade.h"
+#include "prof.h"
+#include "trace.h"
+#include <string.h>
+
+/* ----------------------------------------------------------------------------
+   Bufor ramki: fb – to, co chcą pokazać ekrany, shown – kopia zawartości LCD.
+   Handlery tylko piszą do fb; do LCD trafiają same różnice, raz na ramkę.
+   -----------------------------------------------------------------------------*/
+
+static char fb[RENDER_ROWS][RENDER_COLS];
+static char shown[RENDER_ROWS][RENDER_COLS];
+static bool shownValid = false;
+static bool rowDirty[RENDER_ROWS];
+
+static uint32_t lastFrame = 0;
+static RenderStats_t stats;
+
+/**
+ * @brief Pusty ekran w buforze; pierwsza ramka wyśle oba wiersze w całości,
+ *        bez czekania na okres ramki (ekran startowy).
+ */
+void Render_Init(void)
+{
+    memset(fb, ' ', sizeof(fb));
+    memset(&stats, 0, sizeof(stats));
+    Render_Invalidate();
+    lastFrame = HAL_GetTick() - RENDER_FRAME_MS;
+}
+
+/**
+ * @brief Zapis wiersza do bufora ramki.
+ */
+void Render_PutRow(uint8_t row, const char *text)
+{
+    char line[RENDER_COLS];
+    size_t len = strlen(text);
+
+    if (row >= RENDER_ROWS)
+    {
+        return;
+    }
+
+    if (len > RENDER_COLS) len = RENDER_COLS;
+    memcpy(line, text, len);
+    memset(line + len, ' ', RENDER_COLS - len);
+
+    if (memcmp(fb[row], line, RENDER_COLS) == 0)
+    {
+        return;
+    }
+
+    // Poprzednia zmiana tego wiersza nie zdążyła trafić na LCD – zostanie zastąpiona
+    if (rowDirty[row])
+    {
+        stats.coalesced++;
+    }
+
+    memcpy(fb[row], line, RENDER_COLS);
+    rowDirty[row] = true;
+}
+
+/**
+ * @brief Cały ekran do ponownego wysłania (np. po zmianie znaków CGRAM).
+ */
+void Render_Invalidate(void)
+{
+    shownValid = false;
+    for (uint8_t row = 0; row < RENDER_ROWS; row++)
+    {
+        rowDirty[row] = true;
+    }
+}
+
+/**
+ * @brief Wysłanie zmienionego fragmentu wiersza: od pierwszej do ostatniej różnej kolumny.
+ * @return Liczba wysłanych znaków.
+ */
+static uint8_t Render_EmitRow(Lcd_HandleTypeDef *lcd, uint8_t row)
+{
+    uint8_t lo = 0;
+    uint8_t hi = RENDER_COLS;
+
+    if (shownValid)
+    {
+        while ((lo < RENDER_COLS) && (fb[row][lo] == shown[row][lo])) lo++;
+        if (lo == RENDER_COLS)
+        {
+            return 0;   // wiersz wrócił do stanu z LCD – nic do wysłania
+        }
+        while (fb[row][hi - 1U] == shown[row][hi - 1U]) hi--;
+    }
+
+    char span[RENDER_COLS + 1U];
+    uint8_t n = (uint8_t)(hi - lo);
+    memcpy(span, &fb[row][lo], n);
+    span[n] = '\0';
+
+    Lcd_cursor(lcd, row, lo);
+    Lcd_string(lcd, span);
+    memcpy(&shown[row][lo], span, n);
+    return n;
+}
+
+/**
+ * @brief Przebieg renderowania z ograniczeniem do RENDER_FPS.
+ */
+bool Render_Frame(Lcd_HandleTypeDef *lcd, uint32_t now)
+{
+    uint32_t elapsed = now - lastFrame;
+    if (elapsed < RENDER_FRAME_MS)
+    {
+        return false;
+    }
+
+    // Trzymamy rytm ramek; spóźnienie o pełne okresy liczymy jako pominięte ramki
+    uint32_t slots = elapsed / RENDER_FRAME_MS;
+    if (slots > 1U)
+    {
+        stats.skipped += slots - 1U;
+        if (slots > 8U)
+        {
+            lastFrame = now;   // długa przerwa (np. start) – bez nadrabiania
+        }
+        else
+        {
+            lastFrame += slots * RENDER_FRAME_MS;
+        }
+    }
+    else
+    {
+        lastFrame += RENDER_FRAME_MS;
+    }
+
+    if (!rowDirty[0] && !rowDirty[1])
+    {
+        return false;
+    }
+
+    PROF_BEGIN(render);
+    TRACE(TRACE_EVT_LCD_START, 0);
+    uint32_t t0 = LedFade_NowUs();
+    uint32_t chars = 0;
+
+    for (uint8_t row = 0; row < RENDER_ROWS; row++)
+    {
+        if (rowDirty[row])
+        {
+            chars += Render_EmitRow(lcd, row);
+            rowDirty[row] = false;
+        }
+    }
+    shownValid = true;
+    PROF_END(render, PROF_RENDER);
+    TRACE(TRACE_EVT_LCD_STOP, chars);
+
+    if (chars == 0U)
+    {
+        return false;
+    }
+
+    uint32_t dt = LedFade_NowUs() - t0;
+    stats.frames++;
+    stats.chars += chars;
+    stats.lastUs = dt;
+    if (dt > stats.maxUs)
+    {
+        stats.maxUs = dt;
+    }
+    return true;
+}
+
+const RenderStats_t *Render_GetStats(void)
+{
+    return &stats;
+}
+
+void Render_ResetStats(void)
+{
+    memset(&stats, 0, sizeof(stats));
+}
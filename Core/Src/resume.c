@@ -0,0 +1,291 @@
+// Created by: Marcin Dziedzic
+// resume.c
+
+#include "resume.h"
+#include "menu.h"
+#include "menu_state_handlers.h"
+#include "clock.h"
+#include "alarm.h"
+#include "fade.h"
+#include "envelope.h"
+#include "lamp_reg.h"
+#include "stm32f1xx_hal.h"
+
+extern bool alarmIsActive;
+extern bool skipLamp;
+
+/* ----------------------------------------------------------------------------
+   Migawka w rejestrach BKP_DR1..DR10 (16 bitów każdy). Przetrwa reset
+   watchdoga/programowy/z pinu; bez baterii VBAT ginie razem z zasilaniem.
+   Wtedy zostaje bajt RAM w PCF85063 (zegar ma własną baterię): lampa i alarm.
+   -----------------------------------------------------------------------------*/
+
+enum
+{
+    BK_MAGIC,       // RESUME_MAGIC
+    BK_SEQ,         // numer migawki
+    BK_MENU,        // Menu_SaveContext()
+    BK_FLAGS,       // RF_* + tryb lampy + obwiednia
+    BK_LEVEL,       // jasność lampy
+    BK_PARAM_LO,    // obwiednia: czas od startu (ms); rampa: poziom docelowy
+    BK_PARAM_HI,    // obwiednia: starsze 16 bitów;    rampa: pozostały czas (ms)
+    BK_ALARM,       // przesunięcie drzemki względem alarmu we flashu (s)
+    BK_STAMP,       // sekunda doby / 2 (RTC) – wiek migawki
+    BK_CRC,         // CRC z BK_MAGIC..BK_STAMP
+    BK_COUNT
+};
+
+#define RESUME_MAGIC       0xB008U
+
+#define RF_ALARM_ACTIVE    0x0001U
+#define RF_LAMP_ON         0x0002U
+#define RF_SKIP_LAMP       0x0004U
+#define RF_LAMP_REG        0x0008U
+#define RF_MODE_SHIFT      8U        // LampMode_e
+#define RF_ENV_SHIFT       10U       // indeks w resumeEnvelopes
+
+// Bajt RAM RTC: lampa | alarm | minuta zapisu (0x00 po wymianie baterii = nic do odtworzenia)
+#define RAM_LAMP_ON        0x80U
+#define RAM_ALARM_ACTIVE   0x40U
+#define RAM_MINUTE_MASK    0x3FU
+
+typedef enum
+{
+    LAMP_MODE_STATIC,      // poziom stały
+    LAMP_MODE_RAMP,        // FADE_MODE_SINGLE w toku
+    LAMP_MODE_ENVELOPE     // obwiednia w toku
+} LampMode_e;
+
+static const Envelope_t *const resumeEnvelopes[] = { NULL, &ENV_DAWN, &ENV_BREATH, &ENV_NIGHT };
+
+#define RESUME_ENV_COUNT   (sizeof(resumeEnvelopes) / sizeof(resumeEnvelopes[0]))
+
+static uint16_t       seq = 0;
+static uint32_t       lastSnapshot = 0;
+static uint8_t        lastRam = 0xFFU;     // poza zakresem – pierwszy obieg zawsze zapisuje
+
+static volatile uint32_t *Bkp(uint8_t i)
+{
+    return &BKP->DR1 + i;   // DR1..DR10 leżą kolejno co 4 bajty
+}
+
+/**
+ * @brief CRC migawki – sprzętowy CRC-32, młodsze 16 bitów.
+ */
+static uint16_t Resume_Crc(const uint16_t *r)
+{
+    CRC->CR = CRC_CR_RESET;
+    for (uint8_t i = 0; i < BK_CRC; i++)
+    {
+        CRC->DR = r[i];
+    }
+    return (uint16_t)CRC->DR;
+}
+
+static uint16_t Resume_Stamp(const RTC_TimeTypeDef *t)
+{
+    return (uint16_t)(((uint32_t)t->hours * 3600U + (uint32_t)t->minutes * 60U + t->seconds) / 2U);
+}
+
+/**
+ * @brief Wiek znacznika czasu (s), z przejściem przez północ.
+ */
+static uint32_t Resume_AgeS(uint16_t stamp)
+{
+    uint32_t now = Resume_Stamp(Clock_Now());
+    return ((now + 43200U - stamp) % 43200U) * 2U;
+}
+
+/* ----------------------------------------------------------------------------
+   Odtwarzanie.
+   -----------------------------------------------------------------------------*/
+
+/**
+ * @brief Lampa: najpierw poziom z chwili resetu (bez błysku), potem to, co nią sterowało.
+ */
+static void Resume_Lamp(const uint16_t *r)
+{
+    uint16_t   flags = r[BK_FLAGS];
+    LampMode_e mode  = (LampMode_e)((flags >> RF_MODE_SHIFT) & 0x03U);
+    uint8_t    envId = (uint8_t)((flags >> RF_ENV_SHIFT) & 0x03U);
+
+    LedFade_RetargetTo(&g_fadeHandle, r[BK_LEVEL], 0);
+
+    if ((mode == LAMP_MODE_ENVELOPE) && (envId > 0U) && (envId < RESUME_ENV_COUNT))
+    {
+        LedFade_PlayEnvelope(&g_fadeHandle, resumeEnvelopes[envId]);
+        Envelope_Seek(g_fadeHandle.channel,
+                      (uint32_t)r[BK_PARAM_LO] | ((uint32_t)r[BK_PARAM_HI] << 16));
+    }
+    else if (mode == LAMP_MODE_RAMP)
+    {
+        LedFade_RetargetTo(&g_fadeHandle, r[BK_PARAM_LO], r[BK_PARAM_HI]);
+    }
+
+    if ((flags & RF_LAMP_REG) != 0U)
+    {
+        LampReg_Enable(lampRegEditLux);
+    }
+}
+
+static bool Resume_FromBkp(Lcd_HandleTypeDef *lcd)
+{
+    uint16_t r[BK_COUNT];
+
+    for (uint8_t i = 0; i < BK_COUNT; i++)
+    {
+        r[i] = (uint16_t)*Bkp(i);
+    }
+
+    if ((r[BK_MAGIC] != RESUME_MAGIC) || (r[BK_CRC] != Resume_Crc(r)) ||
+        (Resume_AgeS(r[BK_STAMP]) > RESUME_MAX_AGE_S))
+    {
+        return false;
+    }
+
+    uint16_t flags = r[BK_FLAGS];
+    seq           = r[BK_SEQ];
+    alarmIsActive = (flags & RF_ALARM_ACTIVE) != 0U;
+    skipLamp      = (flags & RF_SKIP_LAMP) != 0U;
+    l_BulbOnOff   = ((flags & RF_LAMP_ON) != 0U) ? 1 : 2;
+
+    // Drzemka przesuwa alarm tylko w RAM – wracamy do przesuniętego
+    Alarm_RestoreSnooze(r[BK_ALARM]);
+
+    // Lampa przed ekranem: wejście w ALARM_TRIGGERED / ściemniacz zastaje ją jak przed resetem
+    Resume_Lamp(r);
+
+    if (!Menu_RestoreContext(lcd, r[BK_MENU]))
+    {
+        Menu_Start(lcd);
+    }
+    return true;
+}
+
+static bool Resume_FromRtcRam(Lcd_HandleTypeDef *lcd)
+{
+    uint8_t ram;
+
+    if (!RTC_ReadRam(&ram) || ((ram & (RAM_LAMP_ON | RAM_ALARM_ACTIVE)) == 0U))
+    {
+        return false;
+    }
+
+    uint8_t age = (uint8_t)((Clock_Now()->minutes + 60U - (ram & RAM_MINUTE_MASK)) % 60U);
+    if (age > RESUME_RAM_MAX_AGE_MIN)
+    {
+        return false;
+    }
+
+    // Jasność nieznana – lampa od razu w pełni, bez ciemnej przerwy
+    if ((ram & RAM_LAMP_ON) != 0U)
+    {
+        l_BulbOnOff = 1;
+        LedFade_RetargetTo(&g_fadeHandle, LEDFADE_LEVEL_MAX, 0);
+    }
+
+    Menu_Start(lcd);
+
+    if ((ram & RAM_ALARM_ACTIVE) != 0U)
+    {
+        alarmIsActive = true;
+        Menu_Post(UI_EVT_ALARM);
+    }
+    return true;
+}
+
+void Resume_Start(Lcd_HandleTypeDef *lcd)
+{
+    __HAL_RCC_PWR_CLK_ENABLE();
+    __HAL_RCC_BKP_CLK_ENABLE();
+    HAL_PWR_EnableBkUpAccess();
+
+    if (!Resume_FromBkp(lcd) && !Resume_FromRtcRam(lcd))
+    {
+        Menu_Start(lcd);
+    }
+
+    lastSnapshot = HAL_GetTick();
+}
+
+/* ----------------------------------------------------------------------------
+   Zapis migawki.
+   -----------------------------------------------------------------------------*/
+
+static void Resume_Snapshot(void)
+{
+    uint16_t r[BK_COUNT];
+    uint16_t flags = 0;
+    uint32_t param = 0;
+    LampMode_e mode = LAMP_MODE_STATIC;
+
+    if (alarmIsActive)       flags |= RF_ALARM_ACTIVE;
+    if (l_BulbOnOff == 1)    flags |= RF_LAMP_ON;
+    if (skipLamp)            flags |= RF_SKIP_LAMP;
+    if (LampReg_IsEnabled()) flags |= RF_LAMP_REG;
+
+    const Envelope_t *env = Envelope_Current(g_fadeHandle.channel);
+    if (g_fadeHandle.isActive && (g_fadeHandle.mode == FADE_MODE_ENVELOPE) && (env != NULL))
+    {
+        for (uint8_t i = 1; i < RESUME_ENV_COUNT; i++)
+        {
+            if (resumeEnvelopes[i] == env)
+            {
+                mode   = LAMP_MODE_ENVELOPE;
+                param  = Envelope_GetElapsedMs(g_fadeHandle.channel);
+                flags |= (uint16_t)(i << RF_ENV_SHIFT);
+            }
+        }
+    }
+    else if (g_fadeHandle.isActive && (g_fadeHandle.mode == FADE_MODE_SINGLE))
+    {
+        uint32_t elapsed = LedFade_NowUs() - g_fadeHandle.startUs;
+        uint32_t leftMs  = (elapsed < g_fadeHandle.durationUs) ?
+                           (g_fadeHandle.durationUs - elapsed) / 1000U : 0U;
+
+        mode  = LAMP_MODE_RAMP;
+        param = (uint32_t)g_fadeHandle.toLevel | (((leftMs > 0xFFFFU) ? 0xFFFFU : leftMs) << 16);
+    }
+    flags |= (uint16_t)(mode << RF_MODE_SHIFT);
+
+    r[BK_MAGIC]    = RESUME_MAGIC;
+    r[BK_SEQ]      = ++seq;
+    r[BK_MENU]     = Menu_SaveContext();
+    r[BK_FLAGS]    = flags;
+    r[BK_LEVEL]    = LedFade_GetLevel(&g_fadeHandle);
+    r[BK_PARAM_LO] = (uint16_t)param;
+    r[BK_PARAM_HI] = (uint16_t)(param >> 16);
+    r[BK_ALARM]    = Alarm_GetSnoozeS();
+    r[BK_STAMP]    = Resume_Stamp(Clock_Now());
+    r[BK_CRC]      = Resume_Crc(r);
+
+    for (uint8_t i = 0; i < BK_COUNT; i++)
+    {
+        *Bkp(i) = r[i];
+    }
+}
+
+void Resume_Process(uint32_t now)
+{
+    if ((now - lastSnapshot) < RESUME_PERIOD_MS)
+    {
+        return;
+    }
+    lastSnapshot = now;
+
+    Resume_Snapshot();
+
+    // Bajt RAM RTC (I2C) tylko przy zmianie: flagi albo – gdy coś jest do odtworzenia – minuta
+    uint8_t ram = 0;
+    if (l_BulbOnOff == 1) ram |= RAM_LAMP_ON;
+    if (alarmIsActive)    ram |= RAM_ALARM_ACTIVE;
+    if (ram != 0U)
+    {
+        ram |= (uint8_t)(Clock_Now()->minutes & RAM_MINUTE_MASK);
+    }
+
+    if ((ram != lastRam) && RTC_WriteRam(ram))
+    {
+        lastRam = ram;
+    }
+}
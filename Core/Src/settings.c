@@ -0,0 +1,262 @@
+// Created by: Marcin Dziedzic
+// settings.c
+
+#include "settings.h"
+#include "fade.h"
+#include "stm32f1xx_hal.h"
+
+/* ----------------------------------------------------------------------------
+   Dziennik ustawień w dwóch ostatnich stronach flasha (skrypt linkera: SETTINGS).
+
+   Strona = nagłówek + rekordy po 8 bajtów, dopisywane jeden za drugim:
+     [key][value lo][value hi][crc]   (half-words, programowane w tej kolejności)
+   Nagłówek to rekord z kluczem SETTINGS_HDR_KEY i numerem generacji w value.
+   Obowiązuje ostatni poprawny rekord danego klucza. Gdy strona się zapełni,
+   aktualne wartości przepisujemy na drugą stronę (nagłówek na końcu), a starą
+   kasujemy. Przerwany zapis = rekord z błędnym CRC (pomijany) albo strona bez
+   nagłówka (ignorowana).
+   -----------------------------------------------------------------------------*/
+
+extern uint8_t _settings_start[];
+
+typedef struct
+{
+    uint16_t key;
+    uint16_t valueLo;
+    uint16_t valueHi;
+    uint16_t crc;
+} SettingsRecord_t;
+
+_Static_assert(sizeof(SettingsRecord_t) == 8, "rekord = jedno programowanie podwójnego słowa");
+
+#define SETTINGS_HDR_KEY     0x5AA5U
+#define SETTINGS_EMPTY       0xFFFFU
+#define SETTINGS_SLOTS       (FLASH_PAGE_SIZE / sizeof(SettingsRecord_t))
+
+static uint32_t values[SET_KEY_COUNT];
+static uint32_t validMask = 0;          // bit k = klucz k ma zapisaną wartość
+static uint8_t  activePage = 0;         // 0 lub 1
+static uint16_t writeSlot = 0;          // pierwszy wolny rekord na aktywnej stronie
+static SettingsStats_t stats = { 0, SETTINGS_SLOTS, 0, 0, 0 };
+
+_Static_assert(SET_KEY_COUNT <= 32, "validMask ma 32 bity");
+_Static_assert(SET_KEY_COUNT < SETTINGS_SLOTS, "kompaktacja musi zmieścić wszystkie klucze");
+
+static SettingsRecord_t *Settings_Page(uint8_t page)
+{
+    return (SettingsRecord_t *)(void *)(_settings_start + ((uint32_t)page * FLASH_PAGE_SIZE));
+}
+
+/**
+ * @brief CRC rekordu – sprzętowy CRC-32 (wielomian 0x04C11DB7) z dwóch słów,
+ *        młodsze 16 bitów. Sterownik HAL CRC nie jest w projekcie – rejestry wprost.
+ */
+static uint16_t Settings_Crc(uint16_t key, uint32_t value)
+{
+    CRC->CR = CRC_CR_RESET;
+    CRC->DR = (uint32_t)key | (value << 16);
+    CRC->DR = value >> 16;
+    return (uint16_t)CRC->DR;
+}
+
+static bool Settings_RecordOk(const SettingsRecord_t *r)
+{
+    uint32_t value = (uint32_t)r->valueLo | ((uint32_t)r->valueHi << 16);
+    return r->crc == Settings_Crc(r->key, value);
+}
+
+static bool Settings_RecordEmpty(const SettingsRecord_t *r)
+{
+    return (r->key == SETTINGS_EMPTY) && (r->valueLo == SETTINGS_EMPTY) &&
+           (r->valueHi == SETTINGS_EMPTY) && (r->crc == SETTINGS_EMPTY);
+}
+
+/**
+ * @brief Generacja strony albo -1, jeśli strona nie ma poprawnego nagłówka.
+ */
+static int32_t Settings_PageGeneration(uint8_t page)
+{
+    const SettingsRecord_t *hdr = &Settings_Page(page)[0];
+    if ((hdr->key != SETTINGS_HDR_KEY) || !Settings_RecordOk(hdr))
+    {
+        return -1;
+    }
+    return hdr->valueLo;
+}
+
+/**
+ * @brief Zapis rekordu jednym wywołaniem (4 half-words, od klucza do CRC).
+ */
+static bool Settings_Program(uint8_t page, uint16_t slot, uint16_t key, uint32_t value)
+{
+    uint64_t rec = (uint64_t)key |
+                   ((uint64_t)value << 16) |
+                   ((uint64_t)Settings_Crc(key, value) << 48);
+    uint32_t addr = (uint32_t)(uintptr_t)&Settings_Page(page)[slot];
+
+    return HAL_FLASH_Program(FLASH_TYPEPROGRAM_DOUBLEWORD, addr, rec) == HAL_OK;
+}
+
+static bool Settings_Erase(uint8_t page)
+{
+    FLASH_EraseInitTypeDef erase = {
+        .TypeErase   = FLASH_TYPEERASE_PAGES,
+        .PageAddress = (uint32_t)(uintptr_t)Settings_Page(page),
+        .NbPages     = 1,
+    };
+    uint32_t pageError;
+
+    return HAL_FLASHEx_Erase(&erase, &pageError) == HAL_OK;
+}
+
+/**
+ * @brief Przepisanie aktualnych wartości na drugą stronę. Nagłówek programujemy
+ *        na końcu – do tego momentu przy starcie obowiązuje stara strona.
+ *        Wołane z odblokowanym flashem.
+ */
+static bool Settings_Compact(void)
+{
+    uint8_t  spare = activePage ^ 1U;
+    uint16_t slot  = 1;
+
+    if (!Settings_Erase(spare))
+    {
+        return false;
+    }
+
+    for (uint8_t k = 0; k < SET_KEY_COUNT; k++)
+    {
+        if ((validMask & (1UL << k)) != 0U)
+        {
+            if (!Settings_Program(spare, slot++, k, values[k]))
+            {
+                return false;
+            }
+        }
+    }
+
+    uint16_t gen = (uint16_t)(stats.generation + 1U);
+    if (!Settings_Program(spare, 0, SETTINGS_HDR_KEY, gen))
+    {
+        return false;
+    }
+
+    Settings_Erase(activePage);
+    activePage = spare;
+    writeSlot  = slot;
+    stats.generation = gen;
+    return true;
+}
+
+void Settings_Init(void)
+{
+    uint32_t t0 = LedFade_NowUs();
+
+    // Aktywna strona: poprawny nagłówek, przy dwóch – nowsza generacja (z zawinięciem)
+    int32_t g0 = Settings_PageGeneration(0);
+    int32_t g1 = Settings_PageGeneration(1);
+
+    if ((g0 < 0) && (g1 < 0))
+    {
+        // Pierwsze uruchomienie (albo obie strony uszkodzone) – pusta strona 0
+        HAL_FLASH_Unlock();
+        Settings_Erase(0);
+        Settings_Program(0, 0, SETTINGS_HDR_KEY, 0);
+        HAL_FLASH_Lock();
+        activePage = 0;
+        g0 = 0;
+    }
+    else if (g0 < 0)
+    {
+        activePage = 1;
+    }
+    else if (g1 < 0)
+    {
+        activePage = 0;
+    }
+    else
+    {
+        activePage = ((int16_t)(uint16_t)(g1 - g0) > 0) ? 1U : 0U;
+    }
+    stats.generation = (uint16_t)((activePage == 0U) ? g0 : g1);
+
+    // Jedno przejście: ostatni poprawny rekord klucza wygrywa
+    const SettingsRecord_t *rec = Settings_Page(activePage);
+    uint16_t slot;
+
+    validMask = 0;
+    for (slot = 1; slot < SETTINGS_SLOTS; slot++)
+    {
+        const SettingsRecord_t *r = &rec[slot];
+
+        if (Settings_RecordEmpty(r))
+        {
+            break;
+        }
+        if ((r->key < SET_KEY_COUNT) && Settings_RecordOk(r))
+        {
+            values[r->key] = (uint32_t)r->valueLo | ((uint32_t)r->valueHi << 16);
+            validMask |= 1UL << r->key;
+        }
+        else
+        {
+            stats.badRecords++;
+        }
+    }
+    writeSlot = slot;
+
+    stats.scanUs = LedFade_NowUs() - t0;
+}
+
+bool Settings_Get(SettingKey_e key, uint32_t *value)
+{
+    if ((key >= SET_KEY_COUNT) || ((validMask & (1UL << key)) == 0U))
+    {
+        return false;
+    }
+    *value = values[key];
+    return true;
+}
+
+bool Settings_Set(SettingKey_e key, uint32_t value)
+{
+    if (key >= SET_KEY_COUNT)
+    {
+        return false;
+    }
+    if (((validMask & (1UL << key)) != 0U) && (values[key] == value))
+    {
+        return true; // bez zmian – oszczędzamy flash
+    }
+
+    values[key] = value;
+    validMask |= 1UL << key;
+
+    bool ok;
+    HAL_FLASH_Unlock();
+    if (writeSlot < SETTINGS_SLOTS)
+    {
+        ok = Settings_Program(activePage, writeSlot, key, value);
+        // Częściowo zapisany slot pomijamy (przy starcie to zły rekord); slot,
+        // który po błędzie jest nadal pusty, zostaje na następny zapis – skan
+        // w Settings_Init kończy się na pierwszym pustym, dalsze byłyby niewidoczne
+        if (ok || !Settings_RecordEmpty(&Settings_Page(activePage)[writeSlot]))
+        {
+            writeSlot++;
+        }
+    }
+    else
+    {
+        // Strona pełna – kompaktacja zapisuje też nową wartość (jest już w values[])
+        ok = Settings_Compact();
+    }
+    HAL_FLASH_Lock();
+
+    return ok;
+}
+
+const SettingsStats_t *Settings_GetStats(void)
+{
+    stats.used = writeSlot;
+    return &stats;
+}
@@ -0,0 +1,469 @@
+// Created by: Marcin Dziedzic
+// shell.c
+
+#include "shell.h"
+#include "uart_tx.h"
+#include "menu.h"
+#include "clock.h"
+#include "light_sen.h"
+#include "lamp_reg.h"
+#include "telemetry.h"
+#include "prof.h"
+#include "alarm.h"
+#include "calendar.h"
+#include "settings.h"
+#include "boot.h"
+#include "usb_port.h"
+#include "watchdog.h"
+#include "memstat.h"
+#include "trace.h"
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ----------------------------------------------------------------------------
+   Odbiór: DMA pisze w kółko do rxBuf, przerwania (IDLE, połowa i koniec bufora)
+   tylko ustawiają flagę. Pętla główna dogania pozycję DMA i składa linie.
+   -----------------------------------------------------------------------------*/
+
+static UART_HandleTypeDef *shellUart = NULL;
+static uint8_t        rxBuf[SHELL_RX_SIZE];
+static uint16_t       rdPos = 0;
+static volatile bool  rxPending = false;
+
+static char     line[SHELL_LINE_MAX];
+static uint8_t  lineLen = 0;
+static bool     lineOverflow = false;
+
+void Shell_Printf(const char *fmt, ...)
+{
+    char buf[96];
+    va_list ap;
+
+    va_start(ap, fmt);
+    int len = vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+
+    if (len > 0)
+    {
+        if (len >= (int)sizeof(buf))
+        {
+            len = sizeof(buf) - 1;
+        }
+        UartTx_Write(buf, (uint16_t)len);
+    }
+}
+
+/* ----------------------------------------------------------------------------
+   Parsowanie argumentów (bez alokacji – wskaźniki do bufora linii).
+   -----------------------------------------------------------------------------*/
+
+/**
+ * @brief Trzy liczby rozdzielone znakiem sep, np. "2025-05-01" lub "12:30:00".
+ */
+static bool ParseTriple(const char *s, char sep, int out[3])
+{
+    for (uint8_t i = 0; i < 3U; i++)
+    {
+        char *end;
+        long v = strtol(s, &end, 10);
+        if ((end == s) || (v < 0) || (v > 9999))
+        {
+            return false;
+        }
+        out[i] = (int)v;
+
+        if (i < 2U)
+        {
+            if (*end != sep) return false;
+            s = end + 1;
+        }
+        else if (*end != '\0')
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Data "YYYY-MM-DD" (lub "YY-MM-DD") i czas "HH:MM:SS" -> RTC_TimeTypeDef.
+ */
+static bool ParseDateTime(const char *date, const char *time, RTC_TimeTypeDef *t)
+{
+    int d[3];
+    int h[3];
+
+    if (!ParseTriple(date, '-', d) || !ParseTriple(time, ':', h))
+    {
+        return false;
+    }
+    if (d[0] >= 2000) d[0] -= 2000;
+
+    if ((d[0] > 99) || (d[1] > 12) || (d[2] > 31) ||
+        (h[0] > 23) || (h[1] > 59) || (h[2] > 59))
+    {
+        return false;
+    }
+
+    t->year    = (uint8_t)d[0];
+    t->month   = (uint8_t)d[1];
+    t->day     = (uint8_t)d[2];
+    t->hours   = (uint8_t)h[0];
+    t->minutes = (uint8_t)h[1];
+    t->seconds = (uint8_t)h[2];
+
+    // Dzień wg długości miesiąca: 2025-02-29 i 2025-04-31 odrzucone
+    if (!Cal_IsValid(t))
+    {
+        return false;
+    }
+    t->weekday = Cal_Weekday(t->year, t->month, t->day);
+    return true;
+}
+
+/**
+ * @brief "on" / "off" -> true / false.
+ */
+static bool ParseOnOff(const char *s, bool *on)
+{
+    if (strcmp(s, "on") == 0)  { *on = true;  return true; }
+    if (strcmp(s, "off") == 0) { *on = false; return true; }
+    return false;
+}
+
+/* ----------------------------------------------------------------------------
+   Polecenia. Każde kończy się odpowiedzią "OK ..." lub "ERR ...".
+   -----------------------------------------------------------------------------*/
+
+static void Cmd_Help(int argc, char **argv);
+
+static void Cmd_Time(int argc, char **argv)
+{
+    if ((argc == 4) && (strcmp(argv[1], "set") == 0))
+    {
+        RTC_TimeTypeDef t = *Clock_Now();
+        if (!ParseDateTime(argv[2], argv[3], &t))
+        {
+            Shell_Printf("ERR format: time set YYYY-MM-DD HH:MM:SS\r\n");
+            return;
+        }
+        RTC_SetTime(&t);
+        Clock_Resync();
+    }
+    else if (argc != 1)
+    {
+        Shell_Printf("ERR usage: time [set YYYY-MM-DD HH:MM:SS]\r\n");
+        return;
+    }
+
+    const RTC_TimeTypeDef *now = Clock_Now();
+    Shell_Printf("OK %04d-%02d-%02d %02d:%02d:%02d\r\n",
+                 now->year + 2000, now->month, now->day,
+                 now->hours, now->minutes, now->seconds);
+}
+
+static void Cmd_Alarm(int argc, char **argv)
+{
+    // Urządzenie ma jeden alarm (slot 0)
+    if ((argc == 4) && (strcmp(argv[1], "set") == 0))
+    {
+        RTC_TimeTypeDef t;
+        if (!ParseDateTime(argv[2], argv[3], &t))
+        {
+            Shell_Printf("ERR format: alarm set YYYY-MM-DD HH:MM:SS\r\n");
+            return;
+        }
+        Alarm_SetEpoch(Cal_ToEpoch(&t));
+        Alarm_Save();
+    }
+    else if ((argc == 3) && (strcmp(argv[1], "lsensor") == 0))
+    {
+        bool on;
+        if (!ParseOnOff(argv[2], &on))
+        {
+            Shell_Printf("ERR usage: alarm lsensor on|off\r\n");
+            return;
+        }
+        LSensor_Set(on);
+    }
+    else if ((argc != 1) && !((argc == 2) && (strcmp(argv[1], "list") == 0)))
+    {
+        Shell_Printf("ERR usage: alarm [list | set YYYY-MM-DD HH:MM:SS | lsensor on|off]\r\n");
+        return;
+    }
+
+    Shell_Printf("OK 0: %04d-%02d-%02d %02d:%02d:%02d lsensor=%s\r\n",
+                 alarmData.year + 2000, alarmData.month, alarmData.day,
+                 alarmData.hour, alarmData.minute, alarmData.second,
+                 (lightSensorMode == 1) ? "on" : "off");
+}
+
+static void Cmd_Sensor(int argc, char **argv)
+{
+    Shell_Printf("OK lux=%u lampreg=%s target=%u\r\n",
+                 LightSen_GetFilteredLux(),
+                 LampReg_IsEnabled() ? "on" : "off",
+                 LampReg_GetTarget());
+}
+
+static void Cmd_Telem(int argc, char **argv)
+{
+    if (argc == 2)
+    {
+        bool on;
+        if (!ParseOnOff(argv[1], &on))
+        {
+            Shell_Printf("ERR usage: telem [on|off]\r\n");
+            return;
+        }
+        Telemetry_SetEnabled(on);
+        Shell_Printf("OK telem %s\r\n", on ? "on" : "off");
+        return;
+    }
+
+    TelemetryFrame_t f;
+    Telemetry_Snapshot(&f);
+    Shell_Printf("OK loop=%u/%uus state=%u flags=0x%02X lux=%u level=%u alarm=%ld\r\n",
+                 f.loopAvgUs, f.loopMaxUs, f.state, f.flags, f.lux, f.level, (long)f.alarmInS);
+    Shell_Printf("OK i2c=%u/%u stack=%u dropped=%u txdrop=%lu\r\n",
+                 f.rtcErrors, f.luxErrors, f.stackUsed, f.dropped,
+                 (unsigned long)UartTx_GetDropped());
+}
+
+/**
+ * @brief usb1/usb2 bez argumentu – stan portu i licznik przeciążeń.
+ */
+static void Cmd_UsbStatus(const char *name, UsbPort_e port)
+{
+    static const char *const names[] = { "off", "on", "fault" };
+    Shell_Printf("OK %s %s faults=%u retry=%lums\r\n", name,
+                 names[UsbPort_GetState(port)], UsbPort_GetFaultCount(port),
+                 (unsigned long)UsbPort_GetRetryInMs(port, HAL_GetTick()));
+}
+
+/**
+ * @brief usb1/usb2/lamp on|off – te same funkcje co przełączniki w menu.
+ */
+static void Cmd_Switch(int argc, char **argv)
+{
+    bool on;
+    if ((argc == 1) && (strncmp(argv[0], "usb", 3) == 0))
+    {
+        Cmd_UsbStatus(argv[0], (argv[0][3] == '1') ? USB_PORT_1 : USB_PORT_2);
+        return;
+    }
+    if ((argc != 2) || !ParseOnOff(argv[1], &on))
+    {
+        Shell_Printf("ERR usage: %s on|off\r\n", argv[0]);
+        return;
+    }
+
+    if (strcmp(argv[0], "usb1") == 0)      Usb1_Set(on);
+    else if (strcmp(argv[0], "usb2") == 0) Usb2_Set(on);
+    else                                   Bulb_Set(on);
+
+    Shell_Printf("OK %s %s\r\n", argv[0], on ? "on" : "off");
+}
+
+static void Cmd_Settings(int argc, char **argv)
+{
+    const SettingsStats_t *s = Settings_GetStats();
+    Shell_Printf("OK records=%u/%u gen=%u bad=%u scan=%luus\r\n",
+                 s->used, s->capacity, s->generation, s->badRecords,
+                 (unsigned long)s->scanUs);
+}
+
+static void Cmd_Boot(int argc, char **argv)
+{
+    Boot_Report();
+    Shell_Printf("OK\r\n");
+}
+
+static void Cmd_Wdg(int argc, char **argv)
+{
+    Wdg_Report();
+    Shell_Printf("OK\r\n");
+}
+
+static void Cmd_Mem(int argc, char **argv)
+{
+    MemStat_Report();
+    Shell_Printf("OK\r\n");
+}
+
+static void Cmd_Trace(int argc, char **argv)
+{
+#if TRACE_ENABLED
+    Trace_Dump();
+    Shell_Printf("OK\r\n");
+#else
+    Shell_Printf("ERR tracer disabled (Release build)\r\n");
+#endif
+}
+
+static void Cmd_Prof(int argc, char **argv)
+{
+#if PROF_ENABLED
+    Prof_RequestDump();
+    Shell_Printf("OK\r\n");
+#else
+    Shell_Printf("ERR profiler disabled (Release build)\r\n");
+#endif
+}
+
+typedef struct
+{
+    const char *name;
+    void (*fn)(int argc, char **argv);
+    const char *usage;
+} ShellCmd_t;
+
+static const ShellCmd_t commands[] = {
+    { "help",     Cmd_Help,     "" },
+    { "time",     Cmd_Time,     "[set YYYY-MM-DD HH:MM:SS]" },
+    { "alarm",    Cmd_Alarm,    "[list | set YYYY-MM-DD HH:MM:SS | lsensor on|off]" },
+    { "sensor",   Cmd_Sensor,   "" },
+    { "telem",    Cmd_Telem,    "[on|off]" },
+    { "usb1",     Cmd_Switch,   "[on|off]" },
+    { "usb2",     Cmd_Switch,   "[on|off]" },
+    { "lamp",     Cmd_Switch,   "on|off" },
+    { "settings", Cmd_Settings, "" },
+    { "boot",     Cmd_Boot,     "" },
+    { "wdg",      Cmd_Wdg,      "" },
+    { "mem",      Cmd_Mem,      "" },
+    { "prof",     Cmd_Prof,     "" },
+    { "trace",    Cmd_Trace,    "" },
+};
+
+#define SHELL_CMD_COUNT  (sizeof(commands) / sizeof(commands[0]))
+
+static void Cmd_Help(int argc, char **argv)
+{
+    for (uint8_t i = 0; i < SHELL_CMD_COUNT; i++)
+    {
+        Shell_Printf("  %s %s\r\n", commands[i].name, commands[i].usage);
+    }
+    Shell_Printf("OK\r\n");
+}
+
+/**
+ * @brief Podział linii na słowa (w miejscu) i wywołanie polecenia.
+ */
+static void Shell_Execute(char *s)
+{
+    char *argv[SHELL_ARGS_MAX];
+    int   argc = 0;
+
+    while ((*s != '\0') && (argc < (int)SHELL_ARGS_MAX))
+    {
+        while (*s == ' ') s++;
+        if (*s == '\0') break;
+
+        argv[argc++] = s;
+        while ((*s != ' ') && (*s != '\0')) s++;
+        if (*s == ' ') *s++ = '\0';
+    }
+
+    if (argc == 0)
+    {
+        return;
+    }
+
+    for (uint8_t i = 0; i < SHELL_CMD_COUNT; i++)
+    {
+        if (strcmp(argv[0], commands[i].name) == 0)
+        {
+            commands[i].fn(argc, argv);
+            return;
+        }
+    }
+    Shell_Printf("ERR unknown command '%s' (help)\r\n", argv[0]);
+}
+
+/**
+ * @brief Jeden znak z odbiornika: składanie linii, wykonanie po CR/LF.
+ */
+static void Shell_Feed(char c)
+{
+    if ((c == '\r') || (c == '\n'))
+    {
+        if (lineOverflow)
+        {
+            Shell_Printf("ERR line too long\r\n");
+        }
+        else if (lineLen > 0U)
+        {
+            line[lineLen] = '\0';
+            Shell_Execute(line);
+        }
+        lineLen = 0;
+        lineOverflow = false;
+    }
+    else if ((c == '\b') || (c == 0x7F))
+    {
+        if (lineLen > 0U) lineLen--;
+    }
+    else if (lineLen < (SHELL_LINE_MAX - 1U))
+    {
+        line[lineLen++] = c;
+    }
+    else
+    {
+        lineOverflow = true;
+    }
+}
+
+void Shell_Init(UART_HandleTypeDef *huart)
+{
+    shellUart = huart;
+    rdPos = 0;
+    lineLen = 0;
+
+    HAL_UART_Receive_DMA(huart, rxBuf, SHELL_RX_SIZE);
+    __HAL_UART_ENABLE_IT(huart, UART_IT_IDLE);
+}
+
+void Shell_RxEvent(void)
+{
+    rxPending = true;
+}
+
+/**
+ * @brief HAL przerywa odbiór DMA po błędzie (np. overrun) – startujemy od nowa.
+ */
+void Shell_RxRestart(UART_HandleTypeDef *huart)
+{
+    if ((huart != shellUart) || (huart->RxState != HAL_UART_STATE_READY))
+    {
+        return;
+    }
+
+    rdPos = 0;
+    HAL_UART_Receive_DMA(huart, rxBuf, SHELL_RX_SIZE);
+    __HAL_UART_ENABLE_IT(huart, UART_IT_IDLE);
+}
+
+void Shell_Process(void)
+{
+    if ((shellUart == NULL) || !rxPending)
+    {
+        return;
+    }
+    rxPending = false;
+
+    // Pozycja zapisu DMA = rozmiar bufora - pozostała liczba transferów
+    uint16_t wrPos = (uint16_t)(SHELL_RX_SIZE - __HAL_DMA_GET_COUNTER(shellUart->hdmarx));
+    if (wrPos >= SHELL_RX_SIZE)
+    {
+        wrPos = 0;
+    }
+
+    while (rdPos != wrPos)
+    {
+        Shell_Feed((char)rxBuf[rdPos]);
+        rdPos = (uint16_t)((rdPos + 1U) % SHELL_RX_SIZE);
+    }
+}
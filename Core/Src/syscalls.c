@@ -29,6 +29,7 @@
 #include <time.h>
 #include <sys/time.h>
 #include <sys/times.h>
+#include "uart_tx.h"
 
 
 /* Variables */
@@ -77,14 +78,26 @@ __attribute__((weak)) int _read(int file, char *ptr, int len)
   return len;
 }
 
+/* printf -> bufor nadawczy USART2 (uart_tx.c), tylko z pętli głównej.
+   Blok dłuższy niż wolne miejsce jest dzielony; reszta, która się nie mieści, przepada. */
 __attribute__((weak)) int _write(int file, char *ptr, int len)
 {
   (void)file;
-  int DataIdx;
+  int sent = 0;
 
-  for (DataIdx = 0; DataIdx < len; DataIdx++)
+  while (sent < len)
   {
-    __io_putchar(*ptr++);
+    uint16_t chunk = UartTx_Free();
+    if (chunk == 0U)
+    {
+      break;
+    }
+    if (chunk > (uint16_t)(len - sent))
+    {
+      chunk = (uint16_t)(len - sent);
+    }
+    UartTx_Write(ptr + sent, chunk);
+    sent += chunk;
   }
   return len;
 }
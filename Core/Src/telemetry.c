@@ -0,0 +1,164 @@
+// Created by: Marcin Dziedzic
+// telemetry.c
+
+#include "telemetry.h"
+#include "menu.h"
+#include "clock.h"
+#include "alarm.h"
+#include "fade.h"
+#include "light_sen.h"
+#include "lamp_reg.h"
+#include "dimmer.h"
+#include "uart_tx.h"
+#include "settings.h"
+#include "usb_port.h"
+#include "memstat.h"
+#include <stddef.h>
+
+extern bool alarmIsActive;
+
+_Static_assert(sizeof(TelemetryFrame_t) == 34, "format ramki niezgodny z Tools/telemetry_decode.py");
+
+static bool     enabled   = true;
+static uint16_t seq       = 0;
+static uint16_t dropped   = 0;
+static uint32_t lastFrame = 0;
+
+static uint32_t loopLastUs = 0;
+static uint32_t loopSumUs  = 0;
+static uint32_t loopMaxUs  = 0;
+static uint32_t loopCount  = 0;
+
+/**
+ * @brief CRC-16/CCITT-FALSE, tablica 16 pozycji (po 4 bity na krok).
+ */
+static uint16_t Crc16(const uint8_t *data, uint32_t len)
+{
+    static const uint16_t nibble[16] = {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+        0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+    };
+    uint16_t crc = 0xFFFF;
+
+    while (len--)
+    {
+        crc = (uint16_t)((crc << 4) ^ nibble[(crc >> 12) ^ (*data >> 4)]);
+        crc = (uint16_t)((crc << 4) ^ nibble[(crc >> 12) ^ (*data & 0x0F)]);
+        data++;
+    }
+    return crc;
+}
+
+static uint16_t Sat16(uint32_t v)
+{
+    return (v > 0xFFFFU) ? 0xFFFFU : (uint16_t)v;
+}
+
+void Telemetry_Init(void)
+{
+    uint32_t on;
+    if (Settings_Get(SET_KEY_TELEMETRY, &on))
+    {
+        enabled = (on != 0U);
+    }
+
+    loopLastUs = LedFade_NowUs();
+}
+
+/**
+ * @brief Okres pętli = odstęp między kolejnymi znacznikami (z HAL_Delay włącznie).
+ */
+void Telemetry_LoopMark(void)
+{
+    uint32_t t  = LedFade_NowUs();
+    uint32_t dt = t - loopLastUs;
+    loopLastUs = t;
+
+    loopSumUs += dt;
+    loopCount++;
+    if (dt > loopMaxUs)
+    {
+        loopMaxUs = dt;
+    }
+}
+
+/**
+ * @brief Wypełnienie ramki bieżącym stanem (bez zmiany liczników).
+ */
+static void Telemetry_Build(TelemetryFrame_t *f, uint32_t now)
+{
+    uint8_t flags = 0;
+    if (alarmIsActive)       flags |= TELEMETRY_FLAG_ALARM;
+    if (l_BulbOnOff == 1)    flags |= TELEMETRY_FLAG_LAMP;
+    if (LampReg_IsEnabled()) flags |= TELEMETRY_FLAG_LAMPREG;
+    if (Dimmer_IsActive())   flags |= TELEMETRY_FLAG_DIMMER;
+    if (UsbPort_GetState(USB_PORT_1) == USB_STATE_FAULT) flags |= TELEMETRY_FLAG_USB1_FLT;
+    if (UsbPort_GetState(USB_PORT_2) == USB_STATE_FAULT) flags |= TELEMETRY_FLAG_USB2_FLT;
+    if (MemStat_Get()->warning) flags |= TELEMETRY_FLAG_MEM_LOW;
+
+    f->sync[0]   = TELEMETRY_SYNC0;
+    f->sync[1]   = TELEMETRY_SYNC1;
+    f->version   = TELEMETRY_VERSION;
+    f->length    = (uint8_t)(sizeof(*f) - offsetof(TelemetryFrame_t, seq) - sizeof(f->crc));
+    f->seq       = seq;
+    f->tickMs    = now;
+    f->loopAvgUs = Sat16((loopCount != 0U) ? (loopSumUs / loopCount) : 0U);
+    f->loopMaxUs = Sat16(loopMaxUs);
+    f->state     = (uint8_t)gState;
+    f->flags     = flags;
+    f->lux       = LightSen_GetFilteredLux();
+    f->level     = LedFade_GetLevel(&g_fadeHandle);
+    f->alarmInS  = Alarm_SecondsToGo(Clock_Now());
+    f->rtcErrors = RTC_GetErrorCount();
+    f->luxErrors = LightSen_GetErrorCount();
+    f->stackUsed = MemStat_Get()->stackUsed;
+    f->dropped   = dropped;
+    f->crc       = Crc16(&f->version,
+                         offsetof(TelemetryFrame_t, crc) - offsetof(TelemetryFrame_t, version));
+}
+
+/**
+ * @brief Budowa ramki i dopisanie jej do bufora nadawczego UART.
+ *        Brak miejsca = ramka pominięta (liczona w polu dropped).
+ */
+void Telemetry_Process(uint32_t now)
+{
+    if (!enabled || ((now - lastFrame) < TELEMETRY_PERIOD_MS))
+    {
+        return;
+    }
+    lastFrame = now;
+
+    TelemetryFrame_t frame;
+    Telemetry_Build(&frame, now);
+
+    loopSumUs = 0;
+    loopMaxUs = 0;
+    loopCount = 0;
+
+    if (UartTx_Write(&frame, sizeof(frame)) == 0U)
+    {
+        dropped++;
+        return;
+    }
+    seq++;
+}
+
+/**
+ * @brief Bieżąca ramka na żądanie (np. polecenie "telem" w konsoli).
+ */
+void Telemetry_Snapshot(TelemetryFrame_t *frame)
+{
+    Telemetry_Build(frame, HAL_GetTick());
+}
+
+void Telemetry_SetEnabled(bool on)
+{
+    enabled = on;
+    Settings_Set(SET_KEY_TELEMETRY, on ? 1U : 0U);
+}
+
+bool Telemetry_IsEnabled(void)
+{
+    return enabled;
+}
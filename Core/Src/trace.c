@@ -0,0 +1,122 @@
+// Created by: Marcin Dziedzic
+// trace.c
+
+#include "trace.h"
+
+#if TRACE_ENABLED
+
+#include "uart_tx.h"
+#include <stdbool.h>
+#include <stdio.h>
+
+/* ----------------------------------------------------------------------------
+   Zdarzenia trafiają w dwa miejsca: do bufora w RAM (ostatnie TRACE_RING_SIZE,
+   do podglądu w debuggerze albo zrzutu poleceniem "trace") i do portów ITM
+   (strumień SWO na PB3, bez końca). Zapis do ITM nie czeka na FIFO – przy
+   zbyt gęstych zdarzeniach część ginie w strumieniu (licznik itmDropped),
+   bufor w RAM ma je wszystkie.
+   -----------------------------------------------------------------------------*/
+
+_Static_assert((TRACE_RING_SIZE & (TRACE_RING_SIZE - 1U)) == 0U, "TRACE_RING_SIZE: potęga dwójki");
+_Static_assert((TRACE_ITM_PORT_BASE + TRACE_EVT_COUNT) <= 32U, "ITM ma 32 porty");
+
+#define ITM_LAR_KEY      0xC5ACCE55UL
+#define TPI_PROTOCOL_NRZ 2U                 // SPPR: asynchroniczny UART (NRZ)
+
+typedef struct
+{
+    uint32_t cycles;    // DWT CYCCNT
+    uint16_t arg;
+    uint8_t  id;        // TraceEvt_e
+    uint8_t  reserved;
+} TraceRec_t;
+
+static TraceRec_t        ring[TRACE_RING_SIZE];
+static volatile uint32_t head = 0;          // liczba zapisanych zdarzeń (indeks = head % rozmiar)
+static volatile bool     frozen = false;    // zrzut w toku – bufor tylko do odczytu
+static uint32_t          cyclesPerUs = 64U;
+static volatile uint32_t itmDropped = 0;
+
+void Trace_Init(void)
+{
+    cyclesPerUs = SystemCoreClock / 1000000U;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL        |= DWT_CTRL_CYCCNTENA_Msk;
+
+    // TRACESWO na PB3, tryb asynchroniczny (TRACE_MODE = 00)
+    DBGMCU->CR = (DBGMCU->CR & ~DBGMCU_CR_TRACE_MODE) | DBGMCU_CR_TRACE_IOEN;
+
+    TPI->SPPR = TPI_PROTOCOL_NRZ;
+    TPI->ACPR = (SystemCoreClock / TRACE_SWO_BAUD) - 1U;
+    TPI->FFCR = 0x100U;                     // bez formatera – czysty strumień ITM
+
+    ITM->LAR = ITM_LAR_KEY;
+    ITM->TCR = (1UL << ITM_TCR_TraceBusID_Pos) | ITM_TCR_SWOENA_Msk |
+               ITM_TCR_SYNCENA_Msk | ITM_TCR_ITMENA_Msk;
+    ITM->TER |= ((1UL << TRACE_EVT_COUNT) - 1U) << TRACE_ITM_PORT_BASE;
+}
+
+void Trace_Event(TraceEvt_e id, uint16_t arg)
+{
+    uint32_t cycles  = DWT->CYCCNT;
+    uint32_t port    = TRACE_ITM_PORT_BASE + (uint32_t)id;
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (!frozen)
+    {
+        TraceRec_t *r = &ring[head & (TRACE_RING_SIZE - 1U)];
+        r->cycles = cycles;
+        r->arg    = arg;
+        r->id     = (uint8_t)id;
+        head++;
+    }
+
+    // Port włączony (przez Trace_Init albo debugger) i FIFO wolne – jedno słowo, bez czekania
+    if (((ITM->TCR & ITM_TCR_ITMENA_Msk) != 0U) && ((ITM->TER & (1UL << port)) != 0U))
+    {
+        if (ITM->PORT[port].u32 != 0U)
+        {
+            uint32_t us = cycles / cyclesPerUs;
+            ITM->PORT[port].u32 = (us << TRACE_ARG_BITS) | (arg & TRACE_ARG_MASK);
+        }
+        else
+        {
+            itmDropped++;
+        }
+    }
+
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Zrzut bufora od najstarszego zdarzenia. Na czas zrzutu bufor jest
+ *        zamrożony (zdarzenia idą tylko do ITM), żeby nie nadpisać czytanych wpisów.
+ */
+void Trace_Dump(void)
+{
+    char line[48];
+    int  len;
+
+    frozen = true;
+
+    uint32_t n     = (head < TRACE_RING_SIZE) ? head : TRACE_RING_SIZE;
+    uint32_t first = head - n;
+
+    len = snprintf(line, sizeof(line), "# trace: %lu events, itm dropped %lu\r\n",
+                   (unsigned long)n, (unsigned long)itmDropped);
+    UartTx_WriteWait(line, (uint16_t)len, UARTTX_DUMP_WAIT_MS);
+
+    for (uint32_t i = first; i != head; i++)
+    {
+        const TraceRec_t *r = &ring[i & (TRACE_RING_SIZE - 1U)];
+        len = snprintf(line, sizeof(line), "trc %lu %u %u\r\n",
+                       (unsigned long)(r->cycles / cyclesPerUs), r->id, r->arg);
+        UartTx_WriteWait(line, (uint16_t)len, UARTTX_DUMP_WAIT_MS);
+    }
+
+    frozen = false;
+}
+
+#endif // TRACE_ENABLED
@@ -0,0 +1,113 @@
+// Created by: Marcin Dziedzic
+// uart_tx.c
+
+#include "uart_tx.h"
+#include <string.h>
+
+#define UARTTX_MASK  (UARTTX_RING_SIZE - 1U)
+
+/* ----------------------------------------------------------------------------
+   Bufor cykliczny: head przesuwa tylko pętla główna (zapis), tail tylko koniec
+   transmisji DMA. Indeksy liczą bez zawijania, pozycja w buforze = indeks & MASK.
+   -----------------------------------------------------------------------------*/
+
+static UART_HandleTypeDef *txUart = NULL;
+static uint8_t            ring[UARTTX_RING_SIZE];
+static volatile uint16_t  head     = 0;
+static volatile uint16_t  tail     = 0;
+static volatile uint16_t  inFlight = 0;   // długość bloku wysyłanego teraz przez DMA
+static uint32_t           dropped  = 0;
+
+/**
+ * @brief Start DMA dla ciągłego fragmentu od tail (do końca danych lub bufora).
+ *        Wołane z przerwaniami zablokowanymi albo z przerwania UART.
+ */
+static void UartTx_Kick(void)
+{
+    if ((txUart == NULL) || (inFlight != 0U) || (head == tail))
+    {
+        return;
+    }
+
+    uint16_t pos   = tail & UARTTX_MASK;
+    uint16_t count = (uint16_t)(head - tail);
+    if (count > (UARTTX_RING_SIZE - pos))
+    {
+        count = (uint16_t)(UARTTX_RING_SIZE - pos);
+    }
+
+    inFlight = count;
+    if (HAL_UART_Transmit_DMA(txUart, &ring[pos], count) != HAL_OK)
+    {
+        inFlight = 0;   // UART zajęty – spróbujemy przy kolejnym zapisie
+    }
+}
+
+void UartTx_Init(UART_HandleTypeDef *huart)
+{
+    txUart   = huart;
+    head     = 0;
+    tail     = 0;
+    inFlight = 0;
+}
+
+uint16_t UartTx_Free(void)
+{
+    return (uint16_t)(UARTTX_RING_SIZE - (uint16_t)(head - tail));
+}
+
+uint32_t UartTx_GetDropped(void)
+{
+    return dropped;
+}
+
+/**
+ * @brief Zapis bloku – blok nigdy nie jest dzielony, więc ramki binarne
+ *        i linie tekstu nie mieszają się ze sobą.
+ */
+uint16_t UartTx_Write(const void *data, uint16_t len)
+{
+    if ((len == 0U) || (len > UartTx_Free()))
+    {
+        dropped++;
+        return 0;
+    }
+
+    uint16_t pos   = head & UARTTX_MASK;
+    uint16_t first = (uint16_t)(UARTTX_RING_SIZE - pos);
+    if (first > len)
+    {
+        first = len;
+    }
+    memcpy(&ring[pos], data, first);
+    memcpy(&ring[0], (const uint8_t *)data + first, len - first);
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    head = (uint16_t)(head + len);
+    UartTx_Kick();
+    __set_PRIMASK(primask);
+
+    return len;
+}
+
+uint16_t UartTx_WriteWait(const void *data, uint16_t len, uint32_t timeoutMs)
+{
+    uint32_t t0 = HAL_GetTick();
+    while ((UartTx_Free() < len) && ((HAL_GetTick() - t0) < timeoutMs))
+    {
+    }
+    return UartTx_Write(data, len);
+}
+
+void UartTx_TxComplete(UART_HandleTypeDef *huart)
+{
+    if (huart != txUart)
+    {
+        return;
+    }
+
+    tail = (uint16_t)(tail + inFlight);
+    inFlight = 0;
+    UartTx_Kick();
+}
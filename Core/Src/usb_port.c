@@ -0,0 +1,185 @@
+// Created by: Marcin Dziedzic
+// usb_port.c
+
+#include "usb_port.h"
+#include "main.h"
+#include "log.h"
+
+/* ----------------------------------------------------------------------------
+   Przeciążenie: klucz zasilania ściąga FLT do masy, EXTI (zbocze opadające)
+   odcina EN jeszcze w przerwaniu – jeden zapis do BRR, bez czekania na pętlę.
+   Ponowienia i zliczanie przeciążeń z rzędu – w UsbPort_Process.
+   -----------------------------------------------------------------------------*/
+
+typedef struct
+{
+    GPIO_TypeDef *enPort;
+    uint16_t      enPin;
+    GPIO_TypeDef *fltPort;
+    uint16_t      fltPin;
+
+    volatile uint8_t  state;       // UsbPortState_e
+    volatile uint16_t faults;      // przeciążenia od startu
+    volatile uint8_t  streak;      // przeciążenia z rzędu (bez USB_STABLE_MS pracy)
+    volatile uint32_t faultTick;   // chwila ostatniego przeciążenia
+    uint32_t          onTick;      // chwila ostatniego włączenia
+} UsbPortCtl_t;
+
+static UsbPortCtl_t ports[USB_PORT_COUNT] = {
+    [USB_PORT_1] = { USB1_EN_GPIO_Port, USB1_EN_Pin, USB1_FLT_GPIO_Port, USB1_FLT_Pin },
+    [USB_PORT_2] = { USB2_EN_GPIO_Port, USB2_EN_Pin, USB2_FLT_GPIO_Port, USB2_FLT_Pin },
+};
+
+/**
+ * @brief Odcięcie zasilania po przeciążeniu (kontekst przerwania lub sekcja krytyczna).
+ */
+static void UsbPort_Trip(UsbPortCtl_t *p)
+{
+    // Najpierw EN – reszta to już tylko księgowość
+    p->enPort->BRR = p->enPin;
+
+    if (p->state != USB_STATE_ON)
+    {
+        return; // port już wyłączony – kolejne zbocze tego samego zdarzenia
+    }
+    p->state     = USB_STATE_FAULT;
+    p->faultTick = HAL_GetTick();
+    p->faults++;
+    if (p->streak < 0xFFU)
+    {
+        p->streak++;
+    }
+    LOG("usb%u: over-current (fault %u, streak %u)", (uint32_t)(p - ports) + 1U, p->faults, p->streak);
+}
+
+/**
+ * @brief Odstęp ponowienia dla n-tego przeciążenia z rzędu: 250 ms, 500 ms, 1 s, ... 30 s.
+ */
+static uint32_t UsbPort_Backoff(uint8_t streak)
+{
+    uint32_t delay = USB_RETRY_FIRST_MS;
+    for (uint8_t i = 1; (i < streak) && (delay < USB_RETRY_MAX_MS); i++)
+    {
+        delay <<= 1;
+    }
+    return (delay < USB_RETRY_MAX_MS) ? delay : USB_RETRY_MAX_MS;
+}
+
+/**
+ * @brief Włączenie EN; stan ustawiany przed pinem, żeby przeciążenie zaraz po
+ *        włączeniu nie trafiło na USB_STATE_FAULT i nie zostało pominięte.
+ */
+static void UsbPort_PowerOn(UsbPortCtl_t *p, uint32_t now)
+{
+    p->onTick = now;
+    p->state  = USB_STATE_ON;
+    p->enPort->BSRR = p->enPin;
+}
+
+void UsbPort_Init(void)
+{
+    for (uint8_t i = 0; i < USB_PORT_COUNT; i++)
+    {
+        UsbPortCtl_t *p = &ports[i];
+        p->enPort->BRR = p->enPin;
+        p->state  = USB_STATE_OFF;
+        p->faults = 0;
+        p->streak = 0;
+    }
+}
+
+void UsbPort_Set(UsbPort_e port, bool on)
+{
+    UsbPortCtl_t *p = &ports[port];
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (on)
+    {
+        if (p->state != USB_STATE_ON)
+        {
+            p->streak = 0;
+            UsbPort_PowerOn(p, HAL_GetTick());
+        }
+    }
+    else
+    {
+        p->enPort->BRR = p->enPin;
+        p->state = USB_STATE_OFF;
+    }
+
+    __set_PRIMASK(primask);
+}
+
+UsbPortState_e UsbPort_GetState(UsbPort_e port)
+{
+    return (UsbPortState_e)ports[port].state;
+}
+
+uint16_t UsbPort_GetFaultCount(UsbPort_e port)
+{
+    return ports[port].faults;
+}
+
+uint32_t UsbPort_GetRetryInMs(UsbPort_e port, uint32_t now)
+{
+    const UsbPortCtl_t *p = &ports[port];
+    if (p->state != USB_STATE_FAULT)
+    {
+        return 0U;
+    }
+    uint32_t elapsed = now - p->faultTick;
+    uint32_t delay   = UsbPort_Backoff(p->streak);
+    return (elapsed < delay) ? (delay - elapsed) : 0U;
+}
+
+void UsbPort_FaultIrq(uint16_t GPIO_Pin)
+{
+    for (uint8_t i = 0; i < USB_PORT_COUNT; i++)
+    {
+        if (ports[i].fltPin == GPIO_Pin)
+        {
+            UsbPort_Trip(&ports[i]);
+        }
+    }
+}
+
+void UsbPort_Process(uint32_t now)
+{
+    for (uint8_t i = 0; i < USB_PORT_COUNT; i++)
+    {
+        UsbPortCtl_t *p = &ports[i];
+
+        switch (p->state)
+        {
+        case USB_STATE_ON:
+            // Linia FLT niska bez zbocza (np. zwarcie już przy włączeniu) – to samo co EXTI
+            if (HAL_GPIO_ReadPin(p->fltPort, p->fltPin) == GPIO_PIN_RESET)
+            {
+                __disable_irq();
+                UsbPort_Trip(p);
+                __enable_irq();
+            }
+            else if ((p->streak != 0U) && ((now - p->onTick) >= USB_STABLE_MS))
+            {
+                p->streak = 0; // odbiornik pracuje stabilnie – następny błąd znów od 250 ms
+            }
+            break;
+
+        case USB_STATE_FAULT:
+            if ((now - p->faultTick) >= UsbPort_Backoff(p->streak))
+            {
+                __disable_irq();
+                if (p->state == USB_STATE_FAULT) // w międzyczasie mógł być UsbPort_Set
+                {
+                    UsbPort_PowerOn(p, now);
+                }
+                __enable_irq();
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+}
@@ -0,0 +1,180 @@
+// Created by: Marcin Dziedzic
+// watchdog.c
+
+#include "watchdog.h"
+#include "fade.h"
+#include "shell.h"
+#include "stm32f1xx_hal.h"
+
+/* ----------------------------------------------------------------------------
+   IWDG na rejestrach (w projekcie nie ma sterownika HAL IWDG). Odświeża go
+   tylko nadzorca w SysTick – pętla główna zgłasza jedynie postęp zadań, więc
+   zawieszenie jednego z nich (np. I2C na zablokowanej magistrali) kończy się
+   resetem nawet wtedy, gdy przerwania działają dalej.
+   -----------------------------------------------------------------------------*/
+
+#define IWDG_KEY_REFRESH    0xAAAAU
+#define IWDG_KEY_UNLOCK     0x5555U
+#define IWDG_KEY_START      0xCCCCU
+#define IWDG_PRESCALER_32   0x03U                          // 40 kHz / 32 = 1.25 kHz
+#define IWDG_RELOAD         ((WDG_TIMEOUT_MS * 40U) / 32U) // 1250 = 1 s (RLR max 4095)
+
+#define WDG_RECORD_MAGIC    0x57444721UL                    // "WDG!"
+
+_Static_assert(IWDG_RELOAD <= 0x0FFFU, "RLR ma 12 bitów");
+
+/**
+ * @brief Rekord przechowywany przez reset: sekcja .noinit nie jest zerowana
+ *        przez kod startowy. Po włączeniu zasilania zawartość jest przypadkowa –
+ *        stąd magic i dopełnienie numeru zadania.
+ */
+typedef struct
+{
+    uint32_t magic;
+    uint8_t  task;        // WdgTask_e, które zagłodziło watchdog
+    uint8_t  taskInv;     // ~task
+    uint16_t resets;      // liczba resetów z watchdoga od włączenia zasilania
+} WdgRecord_t;
+
+static WdgRecord_t record __attribute__((section(".noinit")));
+
+static const char *const taskNames[WDG_TASK_COUNT] = {
+    "fade", "sensor", "clock", "input", "render",
+};
+
+static uint32_t          deadlineUs[WDG_TASK_COUNT];
+static volatile uint32_t lastUs[WDG_TASK_COUNT];
+static uint32_t          worstUs[WDG_TASK_COUNT];
+static volatile uint8_t  registered = 0;                // maska zarejestrowanych zadań
+static volatile uint8_t  active = WDG_TASK_NONE;        // zadanie w trakcie kroku
+static volatile bool     starved = false;               // odświeżanie zablokowane do resetu
+static bool              wasReset = false;
+
+_Static_assert(WDG_TASK_COUNT <= 8, "maska zadań ma 8 bitów");
+
+void Wdg_Init(void)
+{
+    // Przyczyna poprzedniego resetu – flagi RCC kasujemy, żeby kolejny reset był rozróżnialny
+    wasReset = (RCC->CSR & RCC_CSR_IWDGRSTF) != 0U;
+    RCC->CSR |= RCC_CSR_RMVF;
+
+    bool valid = (record.magic == WDG_RECORD_MAGIC) &&
+                 ((uint8_t)~record.task == record.taskInv);
+    if (!valid)
+    {
+        record.magic  = WDG_RECORD_MAGIC;
+        record.resets = 0;
+    }
+    if (wasReset)
+    {
+        record.resets++;
+    }
+    else
+    {
+        record.task = WDG_TASK_NONE; // reset z innego powodu – stary wpis nieaktualny
+    }
+    record.taskInv = (uint8_t)~record.task;
+
+    // IWDG stoi, gdy rdzeń jest zatrzymany przez debugger
+    DBGMCU->CR |= DBGMCU_CR_DBG_IWDG_STOP;
+
+    IWDG->KR  = IWDG_KEY_START;
+    IWDG->KR  = IWDG_KEY_UNLOCK;
+    IWDG->PR  = IWDG_PRESCALER_32;
+    IWDG->RLR = IWDG_RELOAD;
+    while ((IWDG->SR & (IWDG_SR_PVU | IWDG_SR_RVU)) != 0U)
+    {
+        // zapis do domeny LSI trwa kilka okresów 40 kHz
+    }
+    IWDG->KR = IWDG_KEY_REFRESH;
+
+    if (wasReset)
+    {
+        Wdg_Report();
+    }
+}
+
+void Wdg_Register(WdgTask_e task, uint16_t deadlineMs)
+{
+    deadlineUs[task] = (uint32_t)deadlineMs * 1000U;
+    lastUs[task]     = LedFade_NowUs();
+    registered |= (uint8_t)(1U << task);
+}
+
+void Wdg_Begin(WdgTask_e task)
+{
+    active = (uint8_t)task;
+}
+
+void Wdg_Checkin(WdgTask_e task)
+{
+    uint32_t now = LedFade_NowUs();
+    uint32_t dt  = now - lastUs[task];
+
+    if (((registered & (1U << task)) != 0U) && (dt > worstUs[task]))
+    {
+        worstUs[task] = dt;
+    }
+    lastUs[task] = now;
+    active = WDG_TASK_NONE;
+}
+
+/**
+ * @brief Zapis winnego zadania: to, które jest w trakcie kroku (zawisło w środku),
+ *        a gdy żadne – to, które się spóźniło (pętla stoi poza nadzorowanymi zadaniami).
+ */
+static void Wdg_Starve(uint8_t overdue)
+{
+    uint8_t culprit = (active != WDG_TASK_NONE) ? active : overdue;
+
+    record.task    = culprit;
+    record.taskInv = (uint8_t)~culprit;
+    starved = true;
+}
+
+void Wdg_Tick(void)
+{
+    if (starved)
+    {
+        return; // IWDG dolicza do zera
+    }
+
+    uint32_t now = LedFade_NowUs();
+    for (uint8_t i = 0; i < WDG_TASK_COUNT; i++)
+    {
+        if (((registered & (1U << i)) != 0U) && ((now - lastUs[i]) > deadlineUs[i]))
+        {
+            Wdg_Starve(i);
+            return;
+        }
+    }
+
+    IWDG->KR = IWDG_KEY_REFRESH;
+}
+
+void Wdg_Report(void)
+{
+    if (wasReset)
+    {
+        Shell_Printf("wdg: reset #%u, starved task: %s\r\n", record.resets,
+                     (record.task < WDG_TASK_COUNT) ? taskNames[record.task] : "none (SysTick stalled)");
+    }
+
+    if (registered == 0U)
+    {
+        return;
+    }
+
+    // Najdłuższy odstęp między krokami zadania; "fade" = najdłuższy obieg pętli
+    Shell_Printf("wdg: worst");
+    for (uint8_t i = 0; i < WDG_TASK_COUNT; i++)
+    {
+        if ((registered & (1U << i)) != 0U)
+        {
+            Shell_Printf(" %s=%lu.%lu", taskNames[i],
+                         (unsigned long)(worstUs[i] / 1000U),
+                         (unsigned long)((worstUs[i] % 1000U) / 100U));
+        }
+    }
+    Shell_Printf(" ms\r\n");
+}
@@ -94,6 +94,21 @@ LoopFillZerobss:
   cmp r2, r4
   bcc FillZerobss
 
+/* Paint heap and stack (_end .. SP) for the high-water scan in memstat.c.
+   Pattern must match MEMSTAT_PAINT; both ends are 8-byte aligned. */
+  ldr r2, =_end
+  ldr r3, =0xA5A5A5A5
+  mov r5, r3
+  mov r4, sp
+  b LoopPaintRam
+
+PaintRam:
+  stmia r2!, {r3, r5}
+
+LoopPaintRam:
+  cmp r2, r4
+  bcc PaintRam
+
 /* Call static constructors */
     bl __libc_init_array
 /* Call the application's entry point.*/
@@ -0,0 +1,107 @@
+// Created by: Marcin Dziedzic
+// bh1750.c
+
+#include "sim.h"
+
+/* ----------------------------------------------------------------------------
+   Model BH1750 (I2C 0x23): polecenia jednobajtowe, wynik 2 bajty big-endian.
+   Pomiar kończy się po czasie trybu (H: 120 ms, L: 16 ms); do pierwszego
+   wyniku układ zwraca 0. Wynik = lux * 1.2 (tryb H2: * 2.4), jak w nocie.
+   -----------------------------------------------------------------------------*/
+
+#define BH1750_ADDR7            0x23U
+#define BH1750_POWER_DOWN       0x00U
+#define BH1750_POWER_ON         0x01U
+#define BH1750_RESET            0x07U
+#define BH1750_MODE_H2          0x01U      // młodsze bity polecenia trybu
+#define BH1750_MODE_L           0x03U
+#define BH1750_ONE_TIME         0x20U
+
+#define BH1750_H_MS             120U
+#define BH1750_L_MS             16U
+
+static uint32_t lux;
+static uint8_t  mode;               // ostatnie polecenie pomiaru (0 = brak)
+static bool     powered;
+static uint64_t readyAt;
+static uint16_t result;
+
+static void Bh1750_Start(uint8_t cmd)
+{
+    mode    = cmd;
+    powered = true;
+    readyAt = Sim_Now() + SIM_MS(((cmd & 0x03U) == BH1750_MODE_L) ? BH1750_L_MS : BH1750_H_MS);
+}
+
+/**
+ * @brief Rozliczenie pomiaru, który zakończył się przed bieżącą chwilą.
+ */
+static void Bh1750_Update(void)
+{
+    if ((mode == 0U) || !powered || (Sim_Now() < readyAt))
+    {
+        return;
+    }
+
+    uint32_t count = (lux * ((((mode & 0x03U) == BH1750_MODE_H2) ? 24U : 12U))) / 10U;
+    result = (count > 0xFFFFU) ? 0xFFFFU : (uint16_t)count;
+
+    if ((mode & BH1750_ONE_TIME) != 0U)
+    {
+        powered = false;    // tryb jednorazowy: po pomiarze power down
+        mode    = 0;
+    }
+    else
+    {
+        Bh1750_Start(mode);
+    }
+}
+
+static void Bh1750_Write(const uint8_t *data, uint16_t len)
+{
+    uint8_t cmd = data[len - 1U];
+
+    Bh1750_Update();
+    if (cmd == BH1750_POWER_DOWN)
+    {
+        powered = false;
+    }
+    else if (cmd == BH1750_POWER_ON)
+    {
+        powered = true;
+    }
+    else if ((cmd == BH1750_RESET) && powered)
+    {
+        result = 0;
+    }
+    else if (((cmd & 0xCCU) == 0x00U) && (((cmd & 0x30U) == 0x10U) || ((cmd & 0x30U) == 0x20U))
+             && ((cmd & 0x03U) != 0x02U))
+    {
+        Bh1750_Start(cmd);  // 0x10/0x11/0x13 ciągły, 0x20/0x21/0x23 jednorazowy
+    }
+}
+
+static void Bh1750_Read(uint8_t *data, uint16_t len)
+{
+    Bh1750_Update();
+    for (uint16_t i = 0; i < len; i++)
+    {
+        data[i] = (i == 0U) ? (uint8_t)(result >> 8) : (i == 1U) ? (uint8_t)result : 0xFFU;
+    }
+}
+
+static const SimI2cDevice_t bh1750 = { BH1750_ADDR7, "bh1750", Bh1750_Write, Bh1750_Read };
+
+void Bh1750_SetLux(uint32_t value)
+{
+    lux = value;
+}
+
+void Bh1750_Init(void)
+{
+    lux     = 300U;
+    mode    = 0;
+    powered = false;
+    result  = 0;
+    Sim_I2cAttach(&bh1750);
+}
@@ -0,0 +1,316 @@
+// Created by: Marcin Dziedzic
+// hd44780.c
+
+#include "sim.h"
+#include <string.h>
+
+/* ----------------------------------------------------------------------------
+   Model wyświetlacza HD44780 16x2 na liniach GPIO (main.c, Lcd_create):
+   D4..D7 = PC0, PC1, PB0, PA4, RS = PC2, EN = PC3. Dane zatrzaskiwane przy
+   opadającym zboczu EN; po resecie interfejs jest 8-bitowy (D0..D3 = 0).
+   Model sprawdza czasy z noty: zapis w trakcie wykonywania poprzedniej
+   instrukcji jest liczony jako naruszenie (prawdziwy układ by go zgubił).
+   -----------------------------------------------------------------------------*/
+
+#define LCD_COLS            16U
+#define LCD_ROWS            2U
+#define LCD_LINE_LEN        40U        // DDRAM: 0x00..0x27 i 0x40..0x67
+
+#define LCD_POWER_UP_US     40000U
+#define LCD_EXEC_US         37U
+#define LCD_CLEAR_US        1520U
+#define LCD_INIT1_US        4100U      // po pierwszym 0x3 resetu programowego
+#define LCD_INIT2_US        100U       // po drugim
+
+typedef struct
+{
+    GPIO_TypeDef *port;
+    uint16_t      pin;
+} LcdLine_t;
+
+static const LcdLine_t dataLines[4] = {
+    { GPIOC, GPIO_PIN_0 }, { GPIOC, GPIO_PIN_1 }, { GPIOB, GPIO_PIN_0 }, { GPIOA, GPIO_PIN_4 }
+};
+static const LcdLine_t rsLine = { GPIOC, GPIO_PIN_2 };
+static const LcdLine_t enLine = { GPIOC, GPIO_PIN_3 };
+
+static uint8_t  ddram[LCD_ROWS][LCD_LINE_LEN];
+static uint8_t  cgram[64];
+static uint8_t  ac;                 // licznik adresu
+static bool     cgMode;             // AC wskazuje CGRAM
+static bool     increment;
+static bool     displayOn;
+static bool     eightBit;
+static bool     haveHigh;           // 4-bit: czeka na młodszą połówkę
+static uint8_t  high;
+static uint8_t  initWrites;         // zapisy w trybie 8-bit (reset programowy)
+static uint64_t busyUntil;
+static char     shown[LCD_ROWS][LCD_COLS + 1U];
+
+static uint32_t commands;
+static uint32_t dataWrites;
+static uint32_t violations;
+static char     firstViolation[96];
+
+void Hd44780_Init(void)
+{
+    memset(ddram, ' ', sizeof(ddram));
+    memset(cgram, 0, sizeof(cgram));
+    memset(shown, 0, sizeof(shown));
+    ac         = 0;
+    cgMode     = false;
+    increment  = true;
+    displayOn  = false;
+    eightBit   = true;
+    haveHigh   = false;
+    initWrites = 0;
+    busyUntil  = SIM_US(LCD_POWER_UP_US);
+}
+
+static bool Hd44780_Level(const LcdLine_t *line)
+{
+    return (line->port->ODR & line->pin) != 0U;
+}
+
+static void Hd44780_Violation(const char *what)
+{
+    violations++;
+    if (violations == 1U)
+    {
+        snprintf(firstViolation, sizeof(firstViolation), "%s at %.3f ms (%.1f us early)",
+                 what, Sim_NowMs(), (double)(busyUntil - Sim_Now()) / SIM_CYCLES_PER_US);
+    }
+    if (Sim_Verbose)
+    {
+        fprintf(stdout, "[%10.3f] lcd: %s while busy\n", Sim_NowMs(), what);
+    }
+}
+
+/* ---------------------------------------------------------------------------
+   Pamięć i instrukcje
+   -----------------------------------------------------------------------------*/
+
+static void Hd44780_StepAddress(void)
+{
+    if (cgMode)
+    {
+        ac = (uint8_t)((ac + (increment ? 1U : 63U)) & 0x3FU);
+        return;
+    }
+
+    // Dwie linie: 0x27 -> 0x40 i 0x67 -> 0x00 (w obie strony)
+    if (increment)
+    {
+        ac = (ac == 0x27U) ? 0x40U : (ac == 0x67U) ? 0x00U : (uint8_t)(ac + 1U);
+    }
+    else
+    {
+        ac = (ac == 0x40U) ? 0x27U : (ac == 0x00U) ? 0x67U : (uint8_t)(ac - 1U);
+    }
+}
+
+static uint32_t Hd44780_Data(uint8_t value)
+{
+    if (cgMode)
+    {
+        cgram[ac & 0x3FU] = (uint8_t)(value & 0x1FU);
+    }
+    else
+    {
+        uint8_t row = (ac >= 0x40U) ? 1U : 0U;
+        uint8_t col = (uint8_t)(ac & 0x3FU);
+        if (col < LCD_LINE_LEN)
+        {
+            ddram[row][col] = value;
+        }
+    }
+    Hd44780_StepAddress();
+    dataWrites++;
+    return LCD_EXEC_US + 4U;        // tADD po zapisie do RAM
+}
+
+static uint32_t Hd44780_Command(uint8_t cmd)
+{
+    commands++;
+    if (cmd & 0x80U)                            // Set DDRAM address
+    {
+        ac     = (uint8_t)(cmd & 0x7FU);
+        cgMode = false;
+    }
+    else if (cmd & 0x40U)                       // Set CGRAM address
+    {
+        ac     = (uint8_t)(cmd & 0x3FU);
+        cgMode = true;
+    }
+    else if (cmd & 0x20U)                       // Function set
+    {
+        eightBit = (cmd & 0x10U) != 0U;
+    }
+    else if (cmd & 0x10U)                       // Cursor/display shift (tylko kursor)
+    {
+        if ((cmd & 0x08U) == 0U)
+        {
+            bool inc  = increment;
+            increment = (cmd & 0x04U) != 0U;
+            Hd44780_StepAddress();
+            increment = inc;
+        }
+    }
+    else if (cmd & 0x08U)                       // Display on/off control
+    {
+        displayOn = (cmd & 0x04U) != 0U;
+    }
+    else if (cmd & 0x04U)                       // Entry mode set
+    {
+        increment = (cmd & 0x02U) != 0U;
+    }
+    else if (cmd & 0x02U)                       // Return home
+    {
+        ac     = 0;
+        cgMode = false;
+        return LCD_CLEAR_US;
+    }
+    else if (cmd & 0x01U)                       // Clear display
+    {
+        memset(ddram, ' ', sizeof(ddram));
+        ac        = 0;
+        cgMode    = false;
+        increment = true;
+        return LCD_CLEAR_US;
+    }
+    return LCD_EXEC_US;
+}
+
+/**
+ * @brief Zbocze opadające EN: zatrzaśnięcie połówki (4-bit) albo bajtu (8-bit).
+ */
+static void Hd44780_Latch(void)
+{
+    uint8_t nibble = 0;
+    for (uint8_t i = 0; i < 4U; i++)
+    {
+        if (Hd44780_Level(&dataLines[i]))
+        {
+            nibble |= (uint8_t)(1U << i);
+        }
+    }
+    bool rs = Hd44780_Level(&rsLine);
+
+    // Instrukcja zaczyna się od pierwszej połówki – wtedy układ musi być wolny
+    if (!haveHigh && (Sim_Now() < busyUntil))
+    {
+        Hd44780_Violation(rs ? "data write" : "command");
+    }
+
+    uint32_t execUs;
+    if (eightBit)
+    {
+        uint8_t value = (uint8_t)(nibble << 4);
+        initWrites++;
+        execUs = rs ? Hd44780_Data(value) : Hd44780_Command(value);
+        if (!rs && ((value & 0xF0U) == 0x30U))
+        {
+            execUs = (initWrites == 1U) ? LCD_INIT1_US : (initWrites == 2U) ? LCD_INIT2_US : execUs;
+        }
+    }
+    else if (!haveHigh)
+    {
+        high     = nibble;
+        haveHigh = true;
+        return;
+    }
+    else
+    {
+        uint8_t value = (uint8_t)((high << 4) | nibble);
+        haveHigh = false;
+        execUs   = rs ? Hd44780_Data(value) : Hd44780_Command(value);
+    }
+    busyUntil = Sim_Now() + SIM_US(execUs);
+}
+
+void Hd44780_PinChanged(GPIO_TypeDef *port, uint16_t pins)
+{
+    if ((port == enLine.port) && ((pins & enLine.pin) != 0U) && !Hd44780_Level(&enLine))
+    {
+        Hd44780_Latch();
+    }
+}
+
+/* ---------------------------------------------------------------------------
+   Podgląd i raport
+   -----------------------------------------------------------------------------*/
+
+/**
+ * @brief Znak ekranu jako ASCII; własne znaki CGRAM jako odcień wg liczby
+ *        zapalonych pikseli (pasek DisplayDimmer), 0xFF (pełne pole) jako '#'.
+ */
+static char Hd44780_Glyph(uint8_t code)
+{
+    static const char shades[] = " .:|#";
+
+    if (code < 0x10U)
+    {
+        uint32_t pixels = 0;
+        for (uint8_t i = 0; i < 8U; i++)
+        {
+            pixels += (uint32_t)__builtin_popcount(cgram[((code & 0x07U) << 3) + i]);
+        }
+        return shades[(pixels * 4U + 39U) / 40U];
+    }
+    if (code == 0xFFU)
+    {
+        return '#';
+    }
+    if ((code >= 0x20U) && (code < 0x7FU))
+    {
+        return (char)code;
+    }
+    return '?';
+}
+
+static void Hd44780_Render(char text[LCD_ROWS][LCD_COLS + 1U])
+{
+    for (uint8_t row = 0; row < LCD_ROWS; row++)
+    {
+        for (uint8_t col = 0; col < LCD_COLS; col++)
+        {
+            text[row][col] = displayOn ? Hd44780_Glyph(ddram[row][col]) : ' ';
+        }
+        text[row][LCD_COLS] = '\0';
+    }
+}
+
+void Hd44780_Print(FILE *out)
+{
+    char text[LCD_ROWS][LCD_COLS + 1U];
+    Hd44780_Render(text);
+    fprintf(out, "[%10.3f] lcd: |%s|\n", Sim_NowMs(), text[0]);
+    fprintf(out, "             lcd: |%s|\n", text[1]);
+}
+
+/**
+ * @brief Raz na obieg pętli głównej: w trybie -v wypisuje ekran, gdy się zmienił.
+ */
+void Hd44780_Poll(void)
+{
+    char text[LCD_ROWS][LCD_COLS + 1U];
+    Hd44780_Render(text);
+    if (memcmp(text, shown, sizeof(text)) != 0)
+    {
+        memcpy(shown, text, sizeof(text));
+        if (Sim_Verbose)
+        {
+            Hd44780_Print(stdout);
+        }
+    }
+}
+
+void Hd44780_Report(FILE *out)
+{
+    fprintf(out, "  lcd      %8u commands %8u data writes %6u timing violations\n",
+            commands, dataWrites, violations);
+    if (violations > 0U)
+    {
+        fprintf(out, "  lcd      first violation: %s\n", firstViolation);
+    }
+}
@@ -0,0 +1,860 @@
+// Created by: Marcin Dziedzic
+// stm32f1xx_hal.h
+
+#ifndef STM32F1XX_HAL_H
+#define STM32F1XX_HAL_H
+
+/* ----------------------------------------------------------------------------
+   Wirtualny HAL dla symulacji na PC (Sim/). Zastępuje nagłówek z Drivers/ –
+   tylko typy, stałe i makra, których używa Core/. Rejestry to zwykłe struktury
+   w RAM; te, których odczyt musi przesunąć czas albo zapis wywołać akcję
+   (SysTick, DWT, CRC, ITM, IWDG), idą przez funkcję symulatora (sim_core.c).
+   Wartości stałych jak w bibliotece ST – firmware porównuje je z rejestrami.
+   -----------------------------------------------------------------------------*/
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define __IO    volatile
+#define __I     volatile const
+#define __STATIC_INLINE static inline
+
+#define UNUSED(X)           (void)(X)
+#define HAL_MAX_DELAY       0xFFFFFFFFU
+
+/* ---------------------------------------------------------------------------
+   Typy wspólne
+   -----------------------------------------------------------------------------*/
+typedef enum
+{
+    HAL_OK      = 0x00U,
+    HAL_ERROR   = 0x01U,
+    HAL_BUSY    = 0x02U,
+    HAL_TIMEOUT = 0x03U
+} HAL_StatusTypeDef;
+
+typedef enum
+{
+    HAL_UNLOCKED = 0x00U,
+    HAL_LOCKED   = 0x01U
+} HAL_LockTypeDef;
+
+typedef enum
+{
+    RESET = 0U,
+    SET   = !RESET
+} FlagStatus, ITStatus;
+
+typedef enum
+{
+    DISABLE = 0U,
+    ENABLE  = !DISABLE
+} FunctionalState;
+
+typedef enum
+{
+    NonMaskableInt_IRQn  = -14,
+    SysTick_IRQn         = -1,
+    DMA1_Channel6_IRQn   = 16,
+    DMA1_Channel7_IRQn   = 17,
+    EXTI9_5_IRQn         = 23,
+    TIM1_BRK_IRQn        = 24,
+    TIM1_UP_IRQn         = 25,
+    TIM1_TRG_COM_IRQn    = 26,
+    TIM1_CC_IRQn         = 27,
+    TIM3_IRQn            = 29,
+    I2C1_EV_IRQn         = 31,
+    USART2_IRQn          = 38,
+    EXTI15_10_IRQn       = 40
+} IRQn_Type;
+
+extern uint32_t SystemCoreClock;
+extern __IO uint32_t uwTick;
+
+/* ---------------------------------------------------------------------------
+   Rdzeń Cortex-M3: SysTick, DWT, CoreDebug, ITM, TPI, DBGMCU
+   -----------------------------------------------------------------------------*/
+typedef struct
+{
+    __IO uint32_t CTRL;
+    __IO uint32_t LOAD;
+    __IO uint32_t VAL;
+    __I  uint32_t CALIB;
+} SysTick_Type;
+
+typedef struct
+{
+    __IO uint32_t CTRL;
+    __IO uint32_t CYCCNT;
+    __IO uint32_t CPICNT;
+    __IO uint32_t EXCCNT;
+    __IO uint32_t SLEEPCNT;
+    __IO uint32_t LSUCNT;
+    __IO uint32_t FOLDCNT;
+} DWT_Type;
+
+typedef struct
+{
+    __IO uint32_t DHCSR;
+    __IO uint32_t DCRSR;
+    __IO uint32_t DCRDR;
+    __IO uint32_t DEMCR;
+} CoreDebug_Type;
+
+typedef struct
+{
+    __IO union
+    {
+        __IO uint8_t  u8;
+        __IO uint16_t u16;
+        __IO uint32_t u32;
+    } PORT[32U];
+    __IO uint32_t TER;
+    __IO uint32_t TPR;
+    __IO uint32_t TCR;
+    __IO uint32_t LAR;
+    __IO uint32_t LSR;
+} ITM_Type;
+
+typedef struct
+{
+    __IO uint32_t SSPSR;
+    __IO uint32_t CSPSR;
+    __IO uint32_t ACPR;
+    __IO uint32_t SPPR;
+    __IO uint32_t FFSR;
+    __IO uint32_t FFCR;
+} TPI_Type;
+
+typedef struct
+{
+    __IO uint32_t IDCODE;
+    __IO uint32_t CR;
+} DBGMCU_TypeDef;
+
+#define SysTick_CTRL_ENABLE_Msk        (1UL << 0)
+#define SysTick_CTRL_TICKINT_Msk       (1UL << 1)
+#define SysTick_CTRL_CLKSOURCE_Msk     (1UL << 2)
+#define DWT_CTRL_CYCCNTENA_Msk         (1UL << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk     (1UL << 24)
+#define ITM_TCR_ITMENA_Msk             (1UL << 0)
+#define ITM_TCR_SYNCENA_Msk            (1UL << 2)
+#define ITM_TCR_SWOENA_Msk             (1UL << 4)
+#define ITM_TCR_TraceBusID_Pos         16U
+#define DBGMCU_CR_TRACE_IOEN           0x00000020UL
+#define DBGMCU_CR_TRACE_MODE           0x000000C0UL
+#define DBGMCU_CR_DBG_IWDG_STOP        0x00000100UL
+
+/* ---------------------------------------------------------------------------
+   Peryferia STM32F103
+   -----------------------------------------------------------------------------*/
+typedef struct
+{
+    __IO uint32_t CRL;
+    __IO uint32_t CRH;
+    __IO uint32_t IDR;
+    __IO uint32_t ODR;
+    __IO uint32_t BSRR;
+    __IO uint32_t BRR;
+    __IO uint32_t LCKR;
+} GPIO_TypeDef;
+
+typedef struct
+{
+    __IO uint32_t IMR;
+    __IO uint32_t EMR;
+    __IO uint32_t RTSR;
+    __IO uint32_t FTSR;
+    __IO uint32_t SWIER;
+    __IO uint32_t PR;
+} EXTI_TypeDef;
+
+typedef struct
+{
+    __IO uint32_t CR1;
+    __IO uint32_t CR2;
+    __IO uint32_t SMCR;
+    __IO uint32_t DIER;
+    __IO uint32_t SR;
+    __IO uint32_t EGR;
+    __IO uint32_t CCMR1;
+    __IO uint32_t CCMR2;
+    __IO uint32_t CCER;
+    __IO uint32_t CNT;
+    __IO uint32_t PSC;
+    __IO uint32_t ARR;
+    __IO uint32_t RCR;
+    __IO uint32_t CCR1;
+    __IO uint32_t CCR2;
+    __IO uint32_t CCR3;
+    __IO uint32_t CCR4;
+    __IO uint32_t BDTR;
+    __IO uint32_t DCR;
+    __IO uint32_t DMAR;
+} TIM_TypeDef;
+
+typedef struct
+{
+    __IO uint32_t CR1;
+    __IO uint32_t CR2;
+    __IO uint32_t OAR1;
+    __IO uint32_t OAR2;
+    __IO uint32_t DR;
+    __IO uint32_t SR1;
+    __IO uint32_t SR2;
+    __IO uint32_t CCR;
+    __IO uint32_t TRISE;
+} I2C_TypeDef;
+
+typedef struct
+{
+    __IO uint32_t SR;
+    __IO uint32_t DR;
+    __IO uint32_t BRR;
+    __IO uint32_t CR1;
+    __IO uint32_t CR2;
+    __IO uint32_t CR3;
+    __IO uint32_t GTPR;
+} USART_TypeDef;
+
+typedef struct
+{
+    __IO uint32_t CCR;
+    __IO uint32_t CNDTR;
+    __IO uint32_t CPAR;
+    __IO uint32_t CMAR;
+} DMA_Channel_TypeDef;
+
+typedef struct
+{
+    __IO uint32_t ISR;
+    __IO uint32_t IFCR;
+} DMA_TypeDef;
+
+typedef struct
+{
+    __IO uint32_t DR;
+    __IO uint8_t  IDR;
+    uint8_t       RESERVED0;
+    uint16_t      RESERVED1;
+    __IO uint32_t CR;
+} CRC_TypeDef;
+
+typedef struct
+{
+    uint32_t      RESERVED0;
+    __IO uint32_t DR1;
+    __IO uint32_t DR2;
+    __IO uint32_t DR3;
+    __IO uint32_t DR4;
+    __IO uint32_t DR5;
+    __IO uint32_t DR6;
+    __IO uint32_t DR7;
+    __IO uint32_t DR8;
+    __IO uint32_t DR9;
+    __IO uint32_t DR10;
+    __IO uint32_t RTCCR;
+    __IO uint32_t CR;
+    __IO uint32_t CSR;
+} BKP_TypeDef;
+
+typedef struct
+{
+    __IO uint32_t CR;
+    __IO uint32_t CFGR;
+    __IO uint32_t CIR;
+    __IO uint32_t APB2RSTR;
+    __IO uint32_t APB1RSTR;
+    __IO uint32_t AHBENR;
+    __IO uint32_t APB2ENR;
+    __IO uint32_t APB1ENR;
+    __IO uint32_t BDCR;
+    __IO uint32_t CSR;
+} RCC_TypeDef;
+
+typedef struct
+{
+    __IO uint32_t KR;
+    __IO uint32_t PR;
+    __IO uint32_t RLR;
+    __IO uint32_t SR;
+} IWDG_TypeDef;
+
+#define RCC_CSR_RMVF                   0x01000000UL
+#define RCC_CSR_PINRSTF                0x04000000UL
+#define RCC_CSR_PORRSTF                0x08000000UL
+#define RCC_CSR_SFTRSTF                0x10000000UL
+#define RCC_CSR_IWDGRSTF               0x20000000UL
+#define IWDG_SR_PVU                    0x00000001UL
+#define IWDG_SR_RVU                    0x00000002UL
+#define CRC_CR_RESET                   0x00000001UL
+#define BKP_DR1                        0x0000FFFFUL
+
+#define TIM_CR1_CEN                    0x00000001UL
+#define TIM_SR_UIF                     0x00000001UL
+#define TIM_SR_CC1IF                   0x00000002UL
+#define TIM_SR_CC2IF                   0x00000004UL
+#define TIM_SR_CC3IF                   0x00000008UL
+#define TIM_SR_CC4IF                   0x00000010UL
+#define TIM_CCER_CC1E                  0x00000001UL
+#define TIM_CCER_CC2E                  0x00000010UL
+#define TIM_CCER_CC3E                  0x00000100UL
+#define TIM_CCER_CC4E                  0x00001000UL
+
+#define USART_SR_TC                    0x00000040UL
+#define USART_SR_IDLE                  0x00000010UL
+#define USART_CR1_IDLEIE               0x00000010UL
+#define USART_CR3_DMAR                 0x00000040UL
+#define USART_CR3_DMAT                 0x00000080UL
+
+#define DMA_CCR_EN                     0x00000001UL
+#define DMA_CCR_TCIE                   0x00000002UL
+#define DMA_CCR_HTIE                   0x00000004UL
+#define DMA_CCR_CIRC                   0x00000020UL
+#define DMA_FLAG_GL(ch)                (0x1UL << (4U * ((ch) - 1U)))
+#define DMA_FLAG_TC(ch)                (0x2UL << (4U * ((ch) - 1U)))
+#define DMA_FLAG_HT(ch)                (0x4UL << (4U * ((ch) - 1U)))
+
+/* Instancje – obiekty symulatora (sim_hal.c / sim_core.c) */
+extern GPIO_TypeDef        Sim_GPIO[4];
+extern EXTI_TypeDef        Sim_EXTI;
+extern TIM_TypeDef         Sim_TIM1;
+extern TIM_TypeDef         Sim_TIM3;
+extern I2C_TypeDef         Sim_I2C1;
+extern USART_TypeDef       Sim_USART2;
+extern DMA_TypeDef         Sim_DMA1;
+extern DMA_Channel_TypeDef Sim_DMA1_Channel[7];
+extern BKP_TypeDef         Sim_BKP;
+extern RCC_TypeDef         Sim_RCC;
+extern DBGMCU_TypeDef      Sim_DBGMCU;
+extern CoreDebug_Type      Sim_CoreDebug;
+extern TPI_Type            Sim_TPI;
+
+SysTick_Type *Sim_SysTick(void);
+DWT_Type     *Sim_Dwt(void);
+CRC_TypeDef  *Sim_Crc(void);
+ITM_Type     *Sim_Itm(void);
+IWDG_TypeDef *Sim_Iwdg(void);
+
+#define GPIOA              (&Sim_GPIO[0])
+#define GPIOB              (&Sim_GPIO[1])
+#define GPIOC              (&Sim_GPIO[2])
+#define GPIOD              (&Sim_GPIO[3])
+#define EXTI               (&Sim_EXTI)
+#define TIM1               (&Sim_TIM1)
+#define TIM3               (&Sim_TIM3)
+#define I2C1               (&Sim_I2C1)
+#define USART2             (&Sim_USART2)
+#define DMA1               (&Sim_DMA1)
+#define DMA1_Channel6      (&Sim_DMA1_Channel[5])
+#define DMA1_Channel7      (&Sim_DMA1_Channel[6])
+#define BKP                (&Sim_BKP)
+#define RCC                (&Sim_RCC)
+#define DBGMCU             (&Sim_DBGMCU)
+#define CoreDebug          (&Sim_CoreDebug)
+#define TPI                (&Sim_TPI)
+#define SysTick            (Sim_SysTick())
+#define DWT                (Sim_Dwt())
+#define CRC                (Sim_Crc())
+#define ITM                (Sim_Itm())
+#define IWDG               (Sim_Iwdg())
+
+/* ---------------------------------------------------------------------------
+   Funkcje wewnętrzne rdzenia (CMSIS) – PRIMASK blokuje przerwania symulatora
+   -----------------------------------------------------------------------------*/
+uint32_t __get_PRIMASK(void);
+void     __set_PRIMASK(uint32_t priMask);
+void     __disable_irq(void);
+void     __enable_irq(void);
+uint32_t __get_IPSR(void);
+
+// Przerwanie wchodzi tylko w wywołaniach symulatora, nigdy między LDREX a STREX
+__STATIC_INLINE uint32_t __LDREXW(volatile uint32_t *addr)
+{
+    return *addr;
+}
+
+__STATIC_INLINE uint32_t __STREXW(uint32_t value, volatile uint32_t *addr)
+{
+    *addr = value;
+    return 0U;
+}
+
+__STATIC_INLINE void __CLREX(void)
+{
+}
+
+__STATIC_INLINE uint8_t __CLZ(uint32_t value)
+{
+    return (value == 0U) ? 32U : (uint8_t)__builtin_clz(value);
+}
+
+__STATIC_INLINE void __NOP(void)
+{
+}
+
+/* ---------------------------------------------------------------------------
+   HAL: rdzeń, NVIC, RCC, PWR
+   -----------------------------------------------------------------------------*/
+HAL_StatusTypeDef HAL_Init(void);
+void     HAL_MspInit(void);
+void     HAL_IncTick(void);
+uint32_t HAL_GetTick(void);
+void     HAL_Delay(uint32_t Delay);
+
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority);
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn);
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn);
+
+typedef struct
+{
+    uint32_t PLLState;
+    uint32_t PLLSource;
+    uint32_t PLLMUL;
+} RCC_PLLInitTypeDef;
+
+typedef struct
+{
+    uint32_t OscillatorType;
+    uint32_t HSEState;
+    uint32_t HSEPredivValue;
+    uint32_t LSEState;
+    uint32_t HSIState;
+    uint32_t HSICalibrationValue;
+    uint32_t LSIState;
+    RCC_PLLInitTypeDef PLL;
+} RCC_OscInitTypeDef;
+
+typedef struct
+{
+    uint32_t ClockType;
+    uint32_t SYSCLKSource;
+    uint32_t AHBCLKDivider;
+    uint32_t APB1CLKDivider;
+    uint32_t APB2CLKDivider;
+} RCC_ClkInitTypeDef;
+
+#define RCC_OSCILLATORTYPE_HSI         0x00000002U
+#define RCC_HSI_ON                     0x00000001U
+#define RCC_HSICALIBRATION_DEFAULT     0x10U
+#define RCC_PLL_ON                     0x00000002U
+#define RCC_PLLSOURCE_HSI_DIV2         0x00000000U
+#define RCC_PLL_MUL16                  0x00380000U
+#define RCC_CLOCKTYPE_SYSCLK           0x00000001U
+#define RCC_CLOCKTYPE_HCLK             0x00000002U
+#define RCC_CLOCKTYPE_PCLK1            0x00000004U
+#define RCC_CLOCKTYPE_PCLK2            0x00000008U
+#define RCC_SYSCLKSOURCE_PLLCLK        0x00000002U
+#define RCC_SYSCLK_DIV1                0x00000000U
+#define RCC_HCLK_DIV1                  0x00000000U
+#define RCC_HCLK_DIV2                  0x00000400U
+#define FLASH_LATENCY_2                0x00000002U
+
+HAL_StatusTypeDef HAL_RCC_OscConfig(RCC_OscInitTypeDef *RCC_OscInitStruct);
+HAL_StatusTypeDef HAL_RCC_ClockConfig(RCC_ClkInitTypeDef *RCC_ClkInitStruct, uint32_t FLatency);
+uint32_t          HAL_RCC_GetHCLKFreq(void);
+void              HAL_PWR_EnableBkUpAccess(void);
+
+// Zegary i remapowanie pinów nie mają odpowiednika w symulacji
+#define __HAL_RCC_AFIO_CLK_ENABLE()     do { } while (0)
+#define __HAL_RCC_PWR_CLK_ENABLE()      do { } while (0)
+#define __HAL_RCC_BKP_CLK_ENABLE()      do { } while (0)
+#define __HAL_RCC_CRC_CLK_ENABLE()      do { } while (0)
+#define __HAL_RCC_DMA1_CLK_ENABLE()     do { } while (0)
+#define __HAL_RCC_GPIOA_CLK_ENABLE()    do { } while (0)
+#define __HAL_RCC_GPIOB_CLK_ENABLE()    do { } while (0)
+#define __HAL_RCC_GPIOC_CLK_ENABLE()    do { } while (0)
+#define __HAL_RCC_GPIOD_CLK_ENABLE()    do { } while (0)
+#define __HAL_RCC_I2C1_CLK_ENABLE()     do { } while (0)
+#define __HAL_RCC_I2C1_CLK_DISABLE()    do { } while (0)
+#define __HAL_RCC_TIM1_CLK_ENABLE()     do { } while (0)
+#define __HAL_RCC_TIM1_CLK_DISABLE()    do { } while (0)
+#define __HAL_RCC_TIM3_CLK_ENABLE()     do { } while (0)
+#define __HAL_RCC_TIM3_CLK_DISABLE()    do { } while (0)
+#define __HAL_RCC_USART2_CLK_ENABLE()   do { } while (0)
+#define __HAL_RCC_USART2_CLK_DISABLE()  do { } while (0)
+#define __HAL_AFIO_REMAP_SWJ_NOJTAG()   do { } while (0)
+#define __HAL_AFIO_REMAP_I2C1_ENABLE()  do { } while (0)
+
+/* ---------------------------------------------------------------------------
+   HAL: GPIO
+   -----------------------------------------------------------------------------*/
+typedef enum
+{
+    GPIO_PIN_RESET = 0U,
+    GPIO_PIN_SET
+} GPIO_PinState;
+
+typedef struct
+{
+    uint32_t Pin;
+    uint32_t Mode;
+    uint32_t Pull;
+    uint32_t Speed;
+} GPIO_InitTypeDef;
+
+#define GPIO_PIN_0                     ((uint16_t)0x0001)
+#define GPIO_PIN_1                     ((uint16_t)0x0002)
+#define GPIO_PIN_2                     ((uint16_t)0x0004)
+#define GPIO_PIN_3                     ((uint16_t)0x0008)
+#define GPIO_PIN_4                     ((uint16_t)0x0010)
+#define GPIO_PIN_5                     ((uint16_t)0x0020)
+#define GPIO_PIN_6                     ((uint16_t)0x0040)
+#define GPIO_PIN_7                     ((uint16_t)0x0080)
+#define GPIO_PIN_8                     ((uint16_t)0x0100)
+#define GPIO_PIN_9                     ((uint16_t)0x0200)
+#define GPIO_PIN_10                    ((uint16_t)0x0400)
+#define GPIO_PIN_11                    ((uint16_t)0x0800)
+#define GPIO_PIN_12                    ((uint16_t)0x1000)
+#define GPIO_PIN_13                    ((uint16_t)0x2000)
+#define GPIO_PIN_14                    ((uint16_t)0x4000)
+#define GPIO_PIN_15                    ((uint16_t)0x8000)
+#define GPIO_PIN_All                   ((uint16_t)0xFFFF)
+
+#define GPIO_MODE_INPUT                0x00000000U
+#define GPIO_MODE_OUTPUT_PP            0x00000001U
+#define GPIO_MODE_OUTPUT_OD            0x00000011U
+#define GPIO_MODE_AF_PP                0x00000002U
+#define GPIO_MODE_AF_OD                0x00000012U
+#define GPIO_MODE_ANALOG               0x00000003U
+#define GPIO_MODE_IT_RISING            0x10110000U
+#define GPIO_MODE_IT_FALLING           0x10210000U
+#define GPIO_MODE_IT_RISING_FALLING    0x10310000U
+#define GPIO_NOPULL                    0x00000000U
+#define GPIO_PULLUP                    0x00000001U
+#define GPIO_PULLDOWN                  0x00000002U
+#define GPIO_SPEED_FREQ_LOW            0x00000002U
+#define GPIO_SPEED_FREQ_MEDIUM         0x00000001U
+#define GPIO_SPEED_FREQ_HIGH           0x00000003U
+
+void          HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init);
+void          HAL_GPIO_DeInit(GPIO_TypeDef *GPIOx, uint32_t GPIO_Pin);
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin);
+void          HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState);
+void          HAL_GPIO_EXTI_IRQHandler(uint16_t GPIO_Pin);
+void          HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin);
+
+/* ---------------------------------------------------------------------------
+   HAL: DMA
+   -----------------------------------------------------------------------------*/
+typedef enum
+{
+    HAL_DMA_STATE_RESET = 0x00U,
+    HAL_DMA_STATE_READY = 0x01U,
+    HAL_DMA_STATE_BUSY  = 0x02U
+} HAL_DMA_StateTypeDef;
+
+typedef struct
+{
+    uint32_t Direction;
+    uint32_t PeriphInc;
+    uint32_t MemInc;
+    uint32_t PeriphDataAlignment;
+    uint32_t MemDataAlignment;
+    uint32_t Mode;
+    uint32_t Priority;
+} DMA_InitTypeDef;
+
+typedef struct
+{
+    DMA_Channel_TypeDef  *Instance;
+    DMA_InitTypeDef      Init;
+    HAL_LockTypeDef      Lock;
+    HAL_DMA_StateTypeDef State;
+    void                 *Parent;
+    uint32_t             ErrorCode;
+} DMA_HandleTypeDef;
+
+#define DMA_PERIPH_TO_MEMORY           0x00000000U
+#define DMA_MEMORY_TO_PERIPH           0x00000010U
+#define DMA_PINC_DISABLE               0x00000000U
+#define DMA_MINC_ENABLE                0x00000080U
+#define DMA_PDATAALIGN_BYTE            0x00000000U
+#define DMA_MDATAALIGN_BYTE            0x00000000U
+#define DMA_NORMAL                     0x00000000U
+#define DMA_CIRCULAR                   0x00000020U
+#define DMA_PRIORITY_LOW               0x00000000U
+
+#define __HAL_DMA_GET_COUNTER(__HANDLE__)   ((__HANDLE__)->Instance->CNDTR)
+#define __HAL_LINKDMA(__HANDLE__, __PPP_DMA_FIELD__, __DMA_HANDLE__) \
+    do                                                               \
+    {                                                                \
+        (__HANDLE__)->__PPP_DMA_FIELD__ = &(__DMA_HANDLE__);         \
+        (__DMA_HANDLE__).Parent = (__HANDLE__);                      \
+    } while (0U)
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma);
+HAL_StatusTypeDef HAL_DMA_DeInit(DMA_HandleTypeDef *hdma);
+void              HAL_DMA_IRQHandler(DMA_HandleTypeDef *hdma);
+
+/* ---------------------------------------------------------------------------
+   HAL: TIM
+   -----------------------------------------------------------------------------*/
+typedef enum
+{
+    HAL_TIM_STATE_RESET = 0x00U,
+    HAL_TIM_STATE_READY = 0x01U,
+    HAL_TIM_STATE_BUSY  = 0x02U
+} HAL_TIM_StateTypeDef;
+
+typedef enum
+{
+    HAL_TIM_ACTIVE_CHANNEL_1       = 0x01U,
+    HAL_TIM_ACTIVE_CHANNEL_2       = 0x02U,
+    HAL_TIM_ACTIVE_CHANNEL_3       = 0x04U,
+    HAL_TIM_ACTIVE_CHANNEL_4       = 0x08U,
+    HAL_TIM_ACTIVE_CHANNEL_CLEARED = 0x00U
+} HAL_TIM_ActiveChannel;
+
+typedef struct
+{
+    uint32_t Prescaler;
+    uint32_t CounterMode;
+    uint32_t Period;
+    uint32_t ClockDivision;
+    uint32_t RepetitionCounter;
+    uint32_t AutoReloadPreload;
+} TIM_Base_InitTypeDef;
+
+typedef struct
+{
+    TIM_TypeDef           *Instance;
+    TIM_Base_InitTypeDef  Init;
+    HAL_TIM_ActiveChannel Channel;
+    HAL_LockTypeDef       Lock;
+    HAL_TIM_StateTypeDef  State;
+} TIM_HandleTypeDef;
+
+typedef struct
+{
+    uint32_t EncoderMode;
+    uint32_t IC1Polarity;
+    uint32_t IC1Selection;
+    uint32_t IC1Prescaler;
+    uint32_t IC1Filter;
+    uint32_t IC2Polarity;
+    uint32_t IC2Selection;
+    uint32_t IC2Prescaler;
+    uint32_t IC2Filter;
+} TIM_Encoder_InitTypeDef;
+
+typedef struct
+{
+    uint32_t MasterOutputTrigger;
+    uint32_t MasterSlaveMode;
+} TIM_MasterConfigTypeDef;
+
+typedef struct
+{
+    uint32_t OCMode;
+    uint32_t Pulse;
+    uint32_t OCPolarity;
+    uint32_t OCNPolarity;
+    uint32_t OCFastMode;
+    uint32_t OCIdleState;
+    uint32_t OCNIdleState;
+} TIM_OC_InitTypeDef;
+
+#define TIM_CHANNEL_1                  0x00000000U
+#define TIM_CHANNEL_2                  0x00000004U
+#define TIM_CHANNEL_3                  0x00000008U
+#define TIM_CHANNEL_4                  0x0000000CU
+#define TIM_CHANNEL_ALL                0x0000003CU
+#define TIM_COUNTERMODE_UP             0x00000000U
+#define TIM_CLOCKDIVISION_DIV1         0x00000000U
+#define TIM_CLOCKDIVISION_DIV4         0x00000200U
+#define TIM_AUTORELOAD_PRELOAD_DISABLE 0x00000000U
+#define TIM_ENCODERMODE_TI12           0x00000003U
+#define TIM_ICPOLARITY_RISING          0x00000000U
+#define TIM_ICSELECTION_DIRECTTI       0x00000001U
+#define TIM_ICPSC_DIV1                 0x00000000U
+#define TIM_TRGO_RESET                 0x00000000U
+#define TIM_MASTERSLAVEMODE_DISABLE    0x00000000U
+#define TIM_OCMODE_PWM1                0x00000060U
+#define TIM_OCPOLARITY_HIGH            0x00000000U
+#define TIM_OCFAST_DISABLE             0x00000000U
+#define TIM_IT_UPDATE                  0x00000001U
+#define TIM_IT_CC1                     0x00000002U
+#define TIM_IT_CC2                     0x00000004U
+#define TIM_IT_CC3                     0x00000008U
+#define TIM_IT_CC4                     0x00000010U
+
+#define __HAL_TIM_ENABLE_IT(__HANDLE__, __INTERRUPT__)   ((__HANDLE__)->Instance->DIER |= (__INTERRUPT__))
+#define __HAL_TIM_DISABLE_IT(__HANDLE__, __INTERRUPT__)  ((__HANDLE__)->Instance->DIER &= ~(__INTERRUPT__))
+// SR jest rc_w0: zapis ~flaga w HAL kasuje tylko flagę – na strukturze trzeba AND
+#define __HAL_TIM_CLEAR_IT(__HANDLE__, __INTERRUPT__)    ((__HANDLE__)->Instance->SR &= ~(__INTERRUPT__))
+#define __HAL_TIM_GET_COUNTER(__HANDLE__)                ((__HANDLE__)->Instance->CNT)
+#define __HAL_TIM_GET_AUTORELOAD(__HANDLE__)             ((__HANDLE__)->Instance->ARR)
+#define __HAL_TIM_SET_COMPARE(__HANDLE__, __CHANNEL__, __COMPARE__) \
+    (*(__IO uint32_t *)(&((__HANDLE__)->Instance->CCR1) + ((__CHANNEL__) >> 2U)) = (__COMPARE__))
+#define __HAL_TIM_GET_COMPARE(__HANDLE__, __CHANNEL__) \
+    (*(__IO uint32_t *)(&((__HANDLE__)->Instance->CCR1) + ((__CHANNEL__) >> 2U)))
+
+HAL_StatusTypeDef HAL_TIM_PWM_Init(TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_PWM_ConfigChannel(TIM_HandleTypeDef *htim, TIM_OC_InitTypeDef *sConfig, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef *htim, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_Encoder_Init(TIM_HandleTypeDef *htim, TIM_Encoder_InitTypeDef *sConfig);
+HAL_StatusTypeDef HAL_TIM_Encoder_Start(TIM_HandleTypeDef *htim, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIMEx_MasterConfigSynchronization(TIM_HandleTypeDef *htim, TIM_MasterConfigTypeDef *sMasterConfig);
+void HAL_TIM_IRQHandler(TIM_HandleTypeDef *htim);
+void HAL_TIM_PWM_MspInit(TIM_HandleTypeDef *htim);
+void HAL_TIM_PWM_MspDeInit(TIM_HandleTypeDef *htim);
+void HAL_TIM_Encoder_MspInit(TIM_HandleTypeDef *htim);
+void HAL_TIM_Encoder_MspDeInit(TIM_HandleTypeDef *htim);
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim);
+void HAL_TIM_IC_CaptureCallback(TIM_HandleTypeDef *htim);
+
+/* ---------------------------------------------------------------------------
+   HAL: I2C
+   -----------------------------------------------------------------------------*/
+typedef struct
+{
+    uint32_t ClockSpeed;
+    uint32_t DutyCycle;
+    uint32_t OwnAddress1;
+    uint32_t AddressingMode;
+    uint32_t DualAddressMode;
+    uint32_t OwnAddress2;
+    uint32_t GeneralCallMode;
+    uint32_t NoStretchMode;
+} I2C_InitTypeDef;
+
+typedef struct
+{
+    I2C_TypeDef     *Instance;
+    I2C_InitTypeDef Init;
+    HAL_LockTypeDef Lock;
+    uint32_t        ErrorCode;
+} I2C_HandleTypeDef;
+
+#define I2C_DUTYCYCLE_2                0x00000000U
+#define I2C_ADDRESSINGMODE_7BIT        0x00004000U
+#define I2C_DUALADDRESS_DISABLE        0x00000000U
+#define I2C_GENERALCALL_DISABLE        0x00000000U
+#define I2C_NOSTRETCH_DISABLE          0x00000000U
+#define I2C_MEMADD_SIZE_8BIT           0x00000001U
+#define HAL_I2C_ERROR_AF               0x00000004U
+
+HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef *hi2c);
+HAL_StatusTypeDef HAL_I2C_Master_Transmit(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData,
+                                          uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_I2C_Master_Receive(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData,
+                                         uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+                                    uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+                                   uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+void HAL_I2C_MspInit(I2C_HandleTypeDef *hi2c);
+void HAL_I2C_MspDeInit(I2C_HandleTypeDef *hi2c);
+
+/* ---------------------------------------------------------------------------
+   HAL: UART
+   -----------------------------------------------------------------------------*/
+typedef enum
+{
+    HAL_UART_STATE_RESET   = 0x00U,
+    HAL_UART_STATE_READY   = 0x20U,
+    HAL_UART_STATE_BUSY    = 0x24U,
+    HAL_UART_STATE_BUSY_TX = 0x21U,
+    HAL_UART_STATE_BUSY_RX = 0x22U
+} HAL_UART_StateTypeDef;
+
+typedef struct
+{
+    uint32_t BaudRate;
+    uint32_t WordLength;
+    uint32_t StopBits;
+    uint32_t Parity;
+    uint32_t Mode;
+    uint32_t HwFlowCtl;
+    uint32_t OverSampling;
+} UART_InitTypeDef;
+
+typedef struct __UART_HandleTypeDef
+{
+    USART_TypeDef                  *Instance;
+    UART_InitTypeDef               Init;
+    const uint8_t                  *pTxBuffPtr;
+    uint16_t                       TxXferSize;
+    uint8_t                        *pRxBuffPtr;
+    uint16_t                       RxXferSize;
+    DMA_HandleTypeDef              *hdmatx;
+    DMA_HandleTypeDef              *hdmarx;
+    HAL_LockTypeDef                Lock;
+    __IO HAL_UART_StateTypeDef     gState;
+    __IO HAL_UART_StateTypeDef     RxState;
+    __IO uint32_t                  ErrorCode;
+} UART_HandleTypeDef;
+
+#define UART_WORDLENGTH_8B             0x00000000U
+#define UART_STOPBITS_1                0x00000000U
+#define UART_PARITY_NONE               0x00000000U
+#define UART_MODE_TX_RX                0x0000000CU
+#define UART_HWCONTROL_NONE            0x00000000U
+#define UART_OVERSAMPLING_16           0x00000000U
+#define UART_FLAG_IDLE                 USART_SR_IDLE
+#define UART_FLAG_TC                   USART_SR_TC
+#define UART_IT_IDLE                   USART_CR1_IDLEIE
+
+#define __HAL_UART_GET_FLAG(__HANDLE__, __FLAG__)        (((__HANDLE__)->Instance->SR & (__FLAG__)) == (__FLAG__))
+#define __HAL_UART_GET_IT_SOURCE(__HANDLE__, __IT__)     ((__HANDLE__)->Instance->CR1 & (__IT__))
+#define __HAL_UART_ENABLE_IT(__HANDLE__, __INTERRUPT__)  ((__HANDLE__)->Instance->CR1 |= (__INTERRUPT__))
+#define __HAL_UART_DISABLE_IT(__HANDLE__, __INTERRUPT__) ((__HANDLE__)->Instance->CR1 &= ~(__INTERRUPT__))
+#define __HAL_UART_CLEAR_IDLEFLAG(__HANDLE__)            ((__HANDLE__)->Instance->SR &= ~USART_SR_IDLE)
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart);
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UART_Receive_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
+void HAL_UART_IRQHandler(UART_HandleTypeDef *huart);
+void HAL_UART_MspInit(UART_HandleTypeDef *huart);
+void HAL_UART_MspDeInit(UART_HandleTypeDef *huart);
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart);
+void HAL_UART_RxHalfCpltCallback(UART_HandleTypeDef *huart);
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart);
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart);
+
+/* ---------------------------------------------------------------------------
+   HAL: FLASH (strony ustawień, Sim/sim_hal.c)
+   -----------------------------------------------------------------------------*/
+typedef struct
+{
+    uint32_t TypeErase;
+    uint32_t Banks;
+    uint32_t PageAddress;
+    uint32_t NbPages;
+} FLASH_EraseInitTypeDef;
+
+#define FLASH_PAGE_SIZE                0x400U
+#define FLASH_TYPEERASE_PAGES          0x00U
+#define FLASH_TYPEPROGRAM_HALFWORD     0x01U
+#define FLASH_TYPEPROGRAM_WORD         0x02U
+#define FLASH_TYPEPROGRAM_DOUBLEWORD   0x03U
+
+HAL_StatusTypeDef HAL_FLASH_Unlock(void);
+HAL_StatusTypeDef HAL_FLASH_Lock(void);
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint64_t Data);
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef *pEraseInit, uint32_t *PageError);
+
+/* ---------------------------------------------------------------------------
+   Symbole skryptu linkera (memstat.c) – na hoście wskazują na model RAM
+   urządzenia (Sim_Ram), definiuje je Makefile przez --defsym
+   -----------------------------------------------------------------------------*/
+#define _sdata           SimLd_sdata
+#define _edata           SimLd_edata
+#define _sbss            SimLd_sbss
+#define _ebss            SimLd_ebss
+#define _end             SimLd_end
+#define _estack          SimLd_estack
+#define _Min_Stack_Size  SimLd_Min_Stack_Size
+#define _Min_Heap_Size   SimLd_Min_Heap_Size
+#define _sbrk            Sim_Sbrk
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // STM32F1XX_HAL_H
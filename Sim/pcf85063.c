@@ -0,0 +1,130 @@
+// Created by: Marcin Dziedzic
+// pcf85063.c
+
+#include "sim.h"
+#include <string.h>
+#include <time.h>
+
+/* ----------------------------------------------------------------------------
+   Model PCF85063A (I2C 0x51): 18 rejestrów z autoinkrementacją wskaźnika.
+   Zegar liczy w czasie symulacji od zadanego czasu uniksowego (UTC bez strefy);
+   zapis do 0x04..0x0A ustawia nowy czas i zeruje dzielnik (jak w układzie).
+   Dzień tygodnia nie jest liczony z daty – układ przechowuje to, co wpisano.
+   -----------------------------------------------------------------------------*/
+
+#define PCF_ADDR7           0x51U
+#define PCF_REG_COUNT       0x12U
+#define PCF_REG_SECONDS     0x04U
+#define PCF_REG_WEEKDAYS    0x08U
+#define PCF_REG_YEARS       0x0AU
+
+static uint8_t  regs[PCF_REG_COUNT];
+static uint8_t  pointer;
+static int64_t  baseTime;           // czas uniksowy w chwili baseCycles
+static uint64_t baseCycles;
+static int      weekdayOffset;      // wpisany dzień tygodnia względem kalendarza
+
+static uint8_t Pcf85063_Bcd(int value)
+{
+    return (uint8_t)(((value / 10) << 4) | (value % 10));
+}
+
+static int Pcf85063_Dec(uint8_t bcd)
+{
+    return ((bcd >> 4) * 10) + (bcd & 0x0F);
+}
+
+/**
+ * @brief Rejestry czasu z bieżącego czasu symulacji (zatrzask przy odczycie).
+ */
+static void Pcf85063_Latch(void)
+{
+    time_t    t = (time_t)(baseTime + (int64_t)((Sim_Now() - baseCycles) / SIM_CPU_HZ));
+    struct tm tm;
+    gmtime_r(&t, &tm);
+
+    regs[0x04] = Pcf85063_Bcd(tm.tm_sec);
+    regs[0x05] = Pcf85063_Bcd(tm.tm_min);
+    regs[0x06] = Pcf85063_Bcd(tm.tm_hour);
+    regs[0x07] = Pcf85063_Bcd(tm.tm_mday);
+    regs[0x08] = (uint8_t)((tm.tm_wday + weekdayOffset + 7) % 7);
+    regs[0x09] = Pcf85063_Bcd(tm.tm_mon + 1);
+    regs[0x0A] = Pcf85063_Bcd(tm.tm_year % 100);
+}
+
+void Pcf85063_SetTime(int64_t unixTime)
+{
+    baseTime      = unixTime;
+    baseCycles    = Sim_Now();
+    weekdayOffset = 0;
+}
+
+/**
+ * @brief Nowy czas z wpisanych rejestrów (lata 2000..2099).
+ */
+static void Pcf85063_Load(void)
+{
+    struct tm tm;
+    memset(&tm, 0, sizeof(tm));
+    tm.tm_sec  = Pcf85063_Dec(regs[0x04] & 0x7FU);
+    tm.tm_min  = Pcf85063_Dec(regs[0x05] & 0x7FU);
+    tm.tm_hour = Pcf85063_Dec(regs[0x06] & 0x3FU);
+    tm.tm_mday = Pcf85063_Dec(regs[0x07] & 0x3FU);
+    tm.tm_mon  = Pcf85063_Dec(regs[0x09] & 0x1FU) - 1;
+    tm.tm_year = Pcf85063_Dec(regs[0x0A]) + 100;
+
+    uint8_t weekday = (uint8_t)(regs[PCF_REG_WEEKDAYS] & 0x07U);
+    Pcf85063_SetTime((int64_t)timegm(&tm));
+    gmtime_r(&(time_t){ (time_t)baseTime }, &tm);
+    weekdayOffset = (int)weekday - tm.tm_wday;
+
+    if (Sim_Verbose)
+    {
+        fprintf(stdout, "[%10.3f] rtc: time set to 20%02d-%02d-%02d %02d:%02d:%02d\n", Sim_NowMs(),
+                tm.tm_year - 100, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec);
+    }
+}
+
+static void Pcf85063_Write(const uint8_t *data, uint16_t len)
+{
+    bool timeWritten = false;
+
+    pointer = (uint8_t)(data[0] % PCF_REG_COUNT);
+    for (uint16_t i = 1; i < len; i++)
+    {
+        if ((pointer >= PCF_REG_SECONDS) && (pointer <= PCF_REG_YEARS))
+        {
+            if (!timeWritten)
+            {
+                Pcf85063_Latch();   // niewpisane pola zostają z bieżącego czasu
+                timeWritten = true;
+            }
+        }
+        regs[pointer] = data[i];
+        pointer = (uint8_t)((pointer + 1U) % PCF_REG_COUNT);
+    }
+    if (timeWritten)
+    {
+        Pcf85063_Load();
+    }
+}
+
+static void Pcf85063_Read(uint8_t *data, uint16_t len)
+{
+    Pcf85063_Latch();
+    for (uint16_t i = 0; i < len; i++)
+    {
+        data[i] = regs[pointer];
+        pointer = (uint8_t)((pointer + 1U) % PCF_REG_COUNT);
+    }
+}
+
+static const SimI2cDevice_t pcf85063 = { PCF_ADDR7, "pcf85063", Pcf85063_Write, Pcf85063_Read };
+
+void Pcf85063_Init(int64_t unixTime)
+{
+    memset(regs, 0, sizeof(regs));
+    pointer = 0;
+    Pcf85063_SetTime(unixTime);
+    Sim_I2cAttach(&pcf85063);
+}
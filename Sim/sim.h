@@ -0,0 +1,112 @@
+// Created by: Marcin Dziedzic
+// sim.h
+
+#ifndef SIM_H
+#define SIM_H
+
+#include "stm32f1xx_hal.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/* ----------------------------------------------------------------------------
+   Wspólne API symulatora. Czas jest wirtualny i liczony w taktach rdzenia
+   (64 MHz): przesuwają go tylko wywołania HAL/rejestrów z kosztem z tabeli
+   poniżej, transfery magistral i oczekiwanie (HAL_Delay). Obliczenia samego
+   firmware nic nie kosztują – wynik jest powtarzalny co do taktu.
+   -----------------------------------------------------------------------------*/
+
+#define SIM_CPU_HZ              64000000UL
+#define SIM_CYCLES_PER_MS       (SIM_CPU_HZ / 1000UL)
+#define SIM_CYCLES_PER_US       (SIM_CPU_HZ / 1000000UL)
+#define SIM_US(us)              ((uint64_t)(us) * SIM_CYCLES_PER_US)
+#define SIM_MS(ms)              ((uint64_t)(ms) * SIM_CYCLES_PER_MS)
+
+/**
+ * @brief Koszty operacji w taktach (rząd wielkości z pomiarów DWT na płytce).
+ */
+#define SIM_COST_GETTICK        12U     // HAL_GetTick
+#define SIM_COST_GPIO_WRITE     24U     // HAL_GPIO_WritePin
+#define SIM_COST_GPIO_READ      16U     // HAL_GPIO_ReadPin
+#define SIM_COST_REG_POLL       8U      // odczyt SysTick->VAL w pętli oczekiwania
+#define SIM_COST_REG            2U      // pozostałe rejestry rdzenia (DWT, CRC, ITM)
+#define SIM_COST_ISR            24U     // wejście + wyjście z przerwania
+#define SIM_COST_HAL_CALL       200U    // start DMA, konfiguracja peryferium
+
+/**
+ * @brief Zdarzenie w kolejce czasu (peryferia, skrypt).
+ */
+typedef void (*SimEventFn_t)(uint32_t arg);
+
+/**
+ * @brief Urządzenie na magistrali I2C1 (adres 7-bit). Transakcja = START,
+ *        adres, dane, STOP; Mem_Read to zapis adresu rejestru + odczyt po RESTART.
+ */
+typedef struct
+{
+    uint8_t     addr;
+    const char *name;
+    void      (*write)(const uint8_t *data, uint16_t len);
+    void      (*read)(uint8_t *data, uint16_t len);
+} SimI2cDevice_t;
+
+/**
+ * @brief Liczniki do raportu końcowego.
+ */
+typedef struct
+{
+    uint64_t idleCycles;      // HAL_Delay i czekanie na zdarzenie
+    uint32_t loops;           // obiegi pętli głównej (wywołania HAL_Delay)
+    uint32_t irqCount;
+    uint32_t i2cTransfers;
+    uint32_t i2cBytes;
+    uint32_t i2cErrors;
+    uint32_t uartTxBytes;
+    uint32_t uartRxBytes;
+    uint32_t flashWrites;
+    uint32_t flashErases;
+} SimStats_t;
+
+extern SimStats_t Sim_Stats;
+extern FILE      *Sim_UartOut;    // strumień USART2 TX (NULL = odrzucany)
+extern FILE      *Sim_SwoOut;     // strumień ITM (NULL = odrzucany)
+extern bool       Sim_Verbose;
+
+/* ---- sim_core.c: czas, przerwania, rejestry rdzenia ---- */
+void     Sim_CoreInit(void);
+uint64_t Sim_Now(void);
+double   Sim_NowMs(void);
+void     Sim_Advance(uint32_t cycles);
+void     Sim_AdvanceTo(uint64_t when);
+void     Sim_Idle(void);
+void     Sim_Schedule(uint64_t when, SimEventFn_t fn, uint32_t arg);
+void     Sim_Pend(IRQn_Type irq);
+bool     Sim_IrqEnabled(IRQn_Type irq);
+void     Sim_IrqEnable(IRQn_Type irq, bool enable);
+void     Sim_PrintIrqStats(FILE *out);
+void     Sim_Exit(int code);
+
+/* ---- sim_hal.c: peryferia ---- */
+void     Sim_HalInit(void);
+void     Sim_GpioInput(GPIO_TypeDef *port, uint16_t pin, bool high);
+void     Sim_EncoderStep(int dir);
+void     Sim_UartRx(const char *data, uint16_t len);
+void     Sim_I2cAttach(const SimI2cDevice_t *dev);
+void     Sim_I2cFail(uint8_t addr, uint16_t count);
+void     Sim_I2cReport(FILE *out);
+bool     Sim_FlashOpen(const char *path);
+
+/* ---- modele urządzeń ---- */
+void     Hd44780_Init(void);
+void     Hd44780_PinChanged(GPIO_TypeDef *port, uint16_t pins);
+void     Hd44780_Print(FILE *out);
+void     Hd44780_Poll(void);
+void     Hd44780_Report(FILE *out);
+
+void     Pcf85063_Init(int64_t unixTime);
+void     Pcf85063_SetTime(int64_t unixTime);
+
+void     Bh1750_Init(void);
+void     Bh1750_SetLux(uint32_t lux);
+
+#endif // SIM_H
@@ -0,0 +1,534 @@
+// Created by: Marcin Dziedzic
+// sim_core.c
+
+#include "sim.h"
+#include "stm32f1xx_it.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* ----------------------------------------------------------------------------
+   Czas wirtualny i przerwania. Wszystko, co dzieje się "samo" (SysTick,
+   przepełnienie TIM3, koniec DMA, kroki skryptu), jest zdarzeniem w kolejce
+   czasu. Zdarzenie ustawia flagę peryferium i zgłasza przerwanie; obsługa
+   rusza przy najbliższym wywołaniu symulatora z pętli głównej, jeśli PRIMASK
+   na to pozwala. Przerwania się nie zagnieżdżają (w projekcie wszystkie mają
+   priorytet 0), a oczekujące obsługiwane są według numeru wyjątku – jak w NVIC.
+   -----------------------------------------------------------------------------*/
+
+#define SIM_QUEUE_SIZE      512U
+#define IWDG_KEY_REFRESH    0xAAAAU
+#define IWDG_KEY_START      0xCCCCU
+#define IWDG_LSI_HZ         40000U
+#define ITM_PORT_IDLE       0x5EEDF1F0U // odczyt portu: FIFO wolne (!= 0), nietypowa wartość
+
+typedef struct
+{
+    uint64_t     when;
+    uint32_t     seq;       // kolejność zdarzeń o tym samym czasie
+    SimEventFn_t fn;
+    uint32_t     arg;
+} SimEvent_t;
+
+typedef struct
+{
+    IRQn_Type   irq;
+    void      (*handler)(void);
+    const char *name;
+    uint32_t    count;
+} SimIrq_t;
+
+SimStats_t Sim_Stats;
+FILE      *Sim_UartOut = NULL;
+FILE      *Sim_SwoOut  = NULL;
+bool       Sim_Verbose = false;
+
+uint32_t      SystemCoreClock = SIM_CPU_HZ;
+__IO uint32_t uwTick = 0;
+
+CoreDebug_Type Sim_CoreDebug;
+TPI_Type       Sim_TPI;
+DBGMCU_TypeDef Sim_DBGMCU;
+
+static uint64_t   now = 0;
+static SimEvent_t queue[SIM_QUEUE_SIZE];
+static uint32_t   queueLen = 0;
+static uint32_t   queueSeq = 0;
+
+// Kolejność = numer wyjątku (IPSR); przy równym priorytecie NVIC wybiera niższy
+static SimIrq_t irqs[] = {
+    { SysTick_IRQn,       SysTick_Handler,          "SysTick",   0 },
+    { DMA1_Channel6_IRQn, DMA1_Channel6_IRQHandler, "DMA1_Ch6",  0 },
+    { DMA1_Channel7_IRQn, DMA1_Channel7_IRQHandler, "DMA1_Ch7",  0 },
+    { EXTI9_5_IRQn,       EXTI9_5_IRQHandler,       "EXTI9_5",   0 },
+    { TIM1_UP_IRQn,       TIM1_UP_IRQHandler,       "TIM1_UP",   0 },
+    { TIM1_CC_IRQn,       TIM1_CC_IRQHandler,       "TIM1_CC",   0 },
+    { TIM3_IRQn,          TIM3_IRQHandler,          "TIM3",      0 },
+    { USART2_IRQn,        USART2_IRQHandler,        "USART2",    0 },
+    { EXTI15_10_IRQn,     EXTI15_10_IRQHandler,     "EXTI15_10", 0 },
+};
+#define SIM_IRQ_COUNT   (sizeof(irqs) / sizeof(irqs[0]))
+
+static uint32_t irqPending = 0;     // bit = indeks w irqs[]
+static uint32_t irqEnabled = 1U;    // SysTick włączony od HAL_Init
+static uint32_t primask    = 0;
+static uint32_t activeExc  = 0;     // IPSR: 0 = wątek główny
+
+static SysTick_Type systick;
+static DWT_Type     dwt;
+static uint32_t     dwtShown = 0;   // ostatnia wartość CYCCNT podana firmware
+static int64_t      dwtOffset = 0;
+static CRC_TypeDef  crc;
+static uint32_t     crcShown = 0;
+static ITM_Type     itm;
+static IWDG_TypeDef iwdg;
+static bool         iwdgRunning = false;
+static uint64_t     iwdgDeadline = 0;
+
+/* ---------------------------------------------------------------------------
+   Kolejka zdarzeń (kopiec binarny wg czasu, potem kolejności dodania)
+   -----------------------------------------------------------------------------*/
+
+static bool Sim_EventBefore(const SimEvent_t *a, const SimEvent_t *b)
+{
+    return (a->when < b->when) || ((a->when == b->when) && (a->seq < b->seq));
+}
+
+void Sim_Schedule(uint64_t when, SimEventFn_t fn, uint32_t arg)
+{
+    if (queueLen >= SIM_QUEUE_SIZE)
+    {
+        fprintf(stderr, "sim: event queue full\n");
+        Sim_Exit(2);
+    }
+
+    uint32_t i = queueLen++;
+    SimEvent_t ev = { when, queueSeq++, fn, arg };
+    while ((i > 0U) && Sim_EventBefore(&ev, &queue[(i - 1U) / 2U]))
+    {
+        queue[i] = queue[(i - 1U) / 2U];
+        i = (i - 1U) / 2U;
+    }
+    queue[i] = ev;
+}
+
+static SimEvent_t Sim_PopEvent(void)
+{
+    SimEvent_t top  = queue[0];
+    SimEvent_t last = queue[--queueLen];
+    uint32_t   i    = 0;
+
+    for (;;)
+    {
+        uint32_t child = (2U * i) + 1U;
+        if (child >= queueLen)
+        {
+            break;
+        }
+        if (((child + 1U) < queueLen) && Sim_EventBefore(&queue[child + 1U], &queue[child]))
+        {
+            child++;
+        }
+        if (!Sim_EventBefore(&queue[child], &last))
+        {
+            break;
+        }
+        queue[i] = queue[child];
+        i = child;
+    }
+    queue[i] = last;
+    return top;
+}
+
+/* ---------------------------------------------------------------------------
+   Przerwania
+   -----------------------------------------------------------------------------*/
+
+static int Sim_IrqIndex(IRQn_Type irq)
+{
+    for (uint32_t i = 0; i < SIM_IRQ_COUNT; i++)
+    {
+        if (irqs[i].irq == irq)
+        {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+void Sim_Pend(IRQn_Type irq)
+{
+    int i = Sim_IrqIndex(irq);
+    if (i >= 0)
+    {
+        irqPending |= 1UL << i;
+    }
+}
+
+bool Sim_IrqEnabled(IRQn_Type irq)
+{
+    int i = Sim_IrqIndex(irq);
+    return (i >= 0) && ((irqEnabled & (1UL << i)) != 0U);
+}
+
+void Sim_IrqEnable(IRQn_Type irq, bool enable)
+{
+    int i = Sim_IrqIndex(irq);
+    if (i < 0)
+    {
+        return;
+    }
+    if (enable)
+    {
+        irqEnabled |= 1UL << i;
+    }
+    else
+    {
+        irqEnabled &= ~(1UL << i);
+    }
+}
+
+/**
+ * @brief Obsługa oczekujących przerwań (poza przerwaniem i przy PRIMASK = 0).
+ */
+static void Sim_Dispatch(void)
+{
+    while ((activeExc == 0U) && (primask == 0U))
+    {
+        uint32_t ready = irqPending & irqEnabled;
+        if (ready == 0U)
+        {
+            return;
+        }
+
+        uint32_t i = (uint32_t)__builtin_ctz(ready);
+        irqPending &= ~(1UL << i);
+        irqs[i].count++;
+        Sim_Stats.irqCount++;
+
+        activeExc = (uint32_t)((int32_t)irqs[i].irq + 16);
+        Sim_Advance(SIM_COST_ISR / 2U);
+        irqs[i].handler();
+        Sim_Advance(SIM_COST_ISR / 2U);
+        activeExc = 0;
+    }
+}
+
+void Sim_PrintIrqStats(FILE *out)
+{
+    for (uint32_t i = 0; i < SIM_IRQ_COUNT; i++)
+    {
+        if (irqs[i].count != 0U)
+        {
+            fprintf(out, "  irq %-10s %10u\n", irqs[i].name, irqs[i].count);
+        }
+    }
+}
+
+uint32_t __get_PRIMASK(void)
+{
+    return primask;
+}
+
+void __set_PRIMASK(uint32_t priMask)
+{
+    primask = priMask & 1U;
+    Sim_Dispatch();
+}
+
+void __disable_irq(void)
+{
+    primask = 1U;
+}
+
+void __enable_irq(void)
+{
+    primask = 0U;
+    Sim_Dispatch();
+}
+
+uint32_t __get_IPSR(void)
+{
+    return activeExc;
+}
+
+/* ---------------------------------------------------------------------------
+   Upływ czasu
+   -----------------------------------------------------------------------------*/
+
+uint64_t Sim_Now(void)
+{
+    return now;
+}
+
+double Sim_NowMs(void)
+{
+    return (double)now / (double)SIM_CYCLES_PER_MS;
+}
+
+/**
+ * @brief Czas do target: zdarzenia po kolei, po każdym – oczekujące przerwania.
+ *        Przerwanie samo przesuwa czas (wywołania HAL w obsłudze), więc po
+ *        powrocie "teraz" może być już za target.
+ */
+void Sim_AdvanceTo(uint64_t target)
+{
+    while ((queueLen > 0U) && (queue[0].when <= target))
+    {
+        SimEvent_t ev = Sim_PopEvent();
+        if (ev.when > now)
+        {
+            now = ev.when;
+        }
+        ev.fn(ev.arg);
+        Sim_Dispatch();
+    }
+    if (target > now)
+    {
+        now = target;
+    }
+}
+
+void Sim_Advance(uint32_t cycles)
+{
+    Sim_AdvanceTo(now + cycles);
+}
+
+/**
+ * @brief Rdzeń czeka (HAL_Delay): skok prosto do najbliższego zdarzenia.
+ */
+void Sim_Idle(void)
+{
+    uint64_t from = now;
+    Sim_AdvanceTo((queueLen > 0U) ? queue[0].when : (now + SIM_CYCLES_PER_MS));
+    Sim_Stats.idleCycles += now - from;
+}
+
+/* ---------------------------------------------------------------------------
+   SysTick (1 kHz) i IWDG
+   -----------------------------------------------------------------------------*/
+
+static void Sim_IwdgCheck(void)
+{
+    if (iwdg.KR == IWDG_KEY_START)
+    {
+        iwdgRunning = true;
+    }
+    if ((iwdg.KR == IWDG_KEY_START) || (iwdg.KR == IWDG_KEY_REFRESH))
+    {
+        // Okres = (RLR + 1) * 4 * 2^PR / 40 kHz
+        uint64_t ticks = ((uint64_t)(iwdg.RLR & 0x0FFFU) + 1U) * (4ULL << (iwdg.PR & 0x07U));
+        iwdgDeadline = now + ((ticks * SIM_CPU_HZ) / IWDG_LSI_HZ);
+    }
+    iwdg.KR = 0;
+
+    if (iwdgRunning && (now > iwdgDeadline))
+    {
+        fprintf(stdout, "[%10.3f] sim: IWDG reset (watchdog not refreshed)\n", Sim_NowMs());
+        Sim_Exit(3);
+    }
+}
+
+static void Sim_SysTickEvent(uint32_t arg)
+{
+    (void)arg;
+    if ((systick.CTRL & SysTick_CTRL_TICKINT_Msk) != 0U)
+    {
+        Sim_Pend(SysTick_IRQn);
+    }
+    Sim_IwdgCheck();
+    Sim_Schedule(now + systick.LOAD + 1U, Sim_SysTickEvent, 0);
+}
+
+HAL_StatusTypeDef HAL_Init(void)
+{
+    systick.LOAD = (SystemCoreClock / 1000U) - 1U;
+    systick.CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk | SysTick_CTRL_ENABLE_Msk;
+    Sim_Schedule(now + systick.LOAD + 1U, Sim_SysTickEvent, 0);
+    iwdg.RLR = 0x0FFFU;
+
+    HAL_MspInit();
+    return HAL_OK;
+}
+
+void HAL_IncTick(void)
+{
+    uwTick += 1U;
+}
+
+uint32_t HAL_GetTick(void)
+{
+    Sim_Advance(SIM_COST_GETTICK);
+    return uwTick;
+}
+
+/**
+ * @brief Jak w HAL: co najmniej Delay pełnych milisekund. Obieg pętli głównej
+ *        kończy się HAL_Delay(10) – stąd licznik obiegów.
+ */
+void HAL_Delay(uint32_t Delay)
+{
+    uint32_t start = HAL_GetTick();
+    uint32_t wait  = Delay;
+    if (wait < HAL_MAX_DELAY)
+    {
+        wait += 1U;
+    }
+
+    Sim_Stats.loops++;
+    Hd44780_Poll();
+    while ((uwTick - start) < wait)
+    {
+        Sim_Idle();
+    }
+}
+
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority)
+{
+    (void)IRQn;
+    (void)PreemptPriority;
+    (void)SubPriority;
+}
+
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn)
+{
+    Sim_IrqEnable(IRQn, true);
+}
+
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn)
+{
+    Sim_IrqEnable(IRQn, false);
+}
+
+/* ---------------------------------------------------------------------------
+   Rejestry rdzenia z efektami ubocznymi. Każde użycie w firmware to wywołanie
+   funkcji: najpierw rozliczamy zapis z poprzedniego dostępu (inna wartość niż
+   podana ostatnio), potem przesuwamy czas i podajemy aktualny stan.
+   Ograniczenie: zapis dokładnie tej wartości, którą rejestr już pokazywał,
+   jest niewidoczny (CRC: słowo równe bieżącej sumie, ITM: słowo ITM_PORT_IDLE).
+   -----------------------------------------------------------------------------*/
+
+SysTick_Type *Sim_SysTick(void)
+{
+    Sim_Advance(SIM_COST_REG_POLL);
+    systick.VAL = systick.LOAD - (uint32_t)(now % ((uint64_t)systick.LOAD + 1U));
+    return &systick;
+}
+
+DWT_Type *Sim_Dwt(void)
+{
+    if (dwt.CYCCNT != dwtShown)
+    {
+        dwtOffset = (int64_t)dwt.CYCCNT - (int64_t)now;   // zapis CYCCNT (Prof_Init)
+    }
+    Sim_Advance(SIM_COST_REG);
+
+    bool running = ((dwt.CTRL & DWT_CTRL_CYCCNTENA_Msk) != 0U) &&
+                   ((Sim_CoreDebug.DEMCR & CoreDebug_DEMCR_TRCENA_Msk) != 0U);
+    if (running)
+    {
+        dwt.CYCCNT = (uint32_t)((int64_t)now + dwtOffset);
+    }
+    dwtShown = dwt.CYCCNT;
+    return &dwt;
+}
+
+/**
+ * @brief CRC-32 jak w STM32: wielomian 0x04C11DB7, słowa 32-bit, bez odbić.
+ */
+static uint32_t Sim_CrcWord(uint32_t acc, uint32_t word)
+{
+    acc ^= word;
+    for (uint8_t i = 0; i < 32U; i++)
+    {
+        acc = ((acc & 0x80000000UL) != 0U) ? ((acc << 1) ^ 0x04C11DB7UL) : (acc << 1);
+    }
+    return acc;
+}
+
+CRC_TypeDef *Sim_Crc(void)
+{
+    if ((crc.CR & CRC_CR_RESET) != 0U)
+    {
+        crc.CR &= ~CRC_CR_RESET;
+        crc.DR  = 0xFFFFFFFFUL;
+    }
+    else if (crc.DR != crcShown)
+    {
+        crc.DR = Sim_CrcWord(crcShown, crc.DR);
+    }
+    crcShown = crc.DR;
+    Sim_Advance(SIM_COST_REG);
+    return &crc;
+}
+
+/**
+ * @brief Słowa zapisane do portów ITM -> pakiety SWO (nagłówek + 4 bajty LE).
+ */
+static void Sim_ItmFlush(void)
+{
+    for (uint32_t port = 0; port < 32U; port++)
+    {
+        uint32_t word = itm.PORT[port].u32;
+        if (word == ITM_PORT_IDLE)
+        {
+            continue;
+        }
+        itm.PORT[port].u32 = ITM_PORT_IDLE;
+
+        if ((Sim_SwoOut != NULL) && ((itm.TCR & ITM_TCR_ITMENA_Msk) != 0U) && ((itm.TER & (1UL << port)) != 0U))
+        {
+            uint8_t pkt[5] = { (uint8_t)((port << 3) | 0x03U),
+                               (uint8_t)word, (uint8_t)(word >> 8),
+                               (uint8_t)(word >> 16), (uint8_t)(word >> 24) };
+            fwrite(pkt, 1, sizeof(pkt), Sim_SwoOut);
+        }
+    }
+}
+
+ITM_Type *Sim_Itm(void)
+{
+    Sim_ItmFlush();
+    Sim_Advance(SIM_COST_REG);
+    return &itm;
+}
+
+IWDG_TypeDef *Sim_Iwdg(void)
+{
+    Sim_IwdgCheck();
+    return &iwdg;
+}
+
+/**
+ * @brief Koniec symulacji: domknięcie strumieni i kod wyjścia.
+ */
+void Sim_Exit(int code)
+{
+    Sim_ItmFlush();
+    if (Sim_UartOut != NULL)
+    {
+        fflush(Sim_UartOut);
+    }
+    if (Sim_SwoOut != NULL)
+    {
+        fflush(Sim_SwoOut);
+    }
+    fflush(stdout);
+    exit(code);
+}
+
+/**
+ * @brief Stan początkowy rdzenia (przed HAL_Init).
+ */
+void Sim_CoreInit(void)
+{
+    for (uint32_t port = 0; port < 32U; port++)
+    {
+        itm.PORT[port].u32 = ITM_PORT_IDLE;
+    }
+    // Nagrywanie SWO (-w) = podłączony debugger z "itm ports on" (OpenOCD)
+    if (Sim_SwoOut != NULL)
+    {
+        itm.TER = 0xFFFFFFFFU;
+    }
+    memset(&Sim_Stats, 0, sizeof(Sim_Stats));
+}
@@ -0,0 +1,853 @@
+// Created by: Marcin Dziedzic
+// sim_hal.c
+
+#include "sim.h"
+#include <string.h>
+
+/* ----------------------------------------------------------------------------
+   Peryferia MCU w zakresie, którego używa Core/: GPIO z EXTI, TIM1 (enkoder)
+   i TIM3 (PWM + przerwanie update), I2C1 z urządzeniami-modelami, USART2
+   z DMA (nadawanie blokami, odbiór kołowy z IDLE) i strony flasha ustawień.
+   Uproszczenia: koniec nadawania DMA woła TxCplt od razu z przerwania DMA
+   (bez przerwania TC USART), błędy UART nie występują.
+   -----------------------------------------------------------------------------*/
+
+#define SIM_I2C_DEVICES      4U
+#define SIM_SETTINGS_SIZE    (2U * FLASH_PAGE_SIZE)
+#define FLASH_PROGRAM_US     52U       // tPROG (half-word), RM0008
+#define FLASH_ERASE_MS       20U       // tERASE (strona)
+
+typedef struct
+{
+    const SimI2cDevice_t *dev;
+    uint16_t              failNext;    // tyle kolejnych transakcji dostanie NACK
+    uint32_t              transfers;
+    uint32_t              bytes;
+    uint32_t              errors;
+} SimI2cSlot_t;
+
+GPIO_TypeDef        Sim_GPIO[4];
+EXTI_TypeDef        Sim_EXTI;
+TIM_TypeDef         Sim_TIM1;
+TIM_TypeDef         Sim_TIM3;
+I2C_TypeDef         Sim_I2C1;
+USART_TypeDef       Sim_USART2;
+DMA_TypeDef         Sim_DMA1;
+DMA_Channel_TypeDef Sim_DMA1_Channel[7];
+BKP_TypeDef         Sim_BKP;
+RCC_TypeDef         Sim_RCC;
+
+// Strony ustawień (settings.c) – w urządzeniu dwie ostatnie strony flasha
+uint8_t _settings_start[SIM_SETTINGS_SIZE] __attribute__((aligned(FLASH_PAGE_SIZE)));
+
+static GPIO_TypeDef       *extiPort[16];     // AFIO_EXTICR: port linii EXTI
+static uint16_t            outputMask[4];    // piny wyjściowe (IDR = ODR)
+static uint8_t             encPhase = 0;     // faza kwadratury A/B
+static SimI2cSlot_t        i2c[SIM_I2C_DEVICES];
+static uint8_t             i2cCount = 0;
+static UART_HandleTypeDef *uart = NULL;
+static uint64_t            rxBusyUntil = 0;
+static bool                flashUnlocked = false;
+static const char         *flashPath = NULL;
+
+/* ---------------------------------------------------------------------------
+   GPIO i EXTI
+   -----------------------------------------------------------------------------*/
+
+static uint32_t Sim_PortIndex(const GPIO_TypeDef *port)
+{
+    return (uint32_t)(port - Sim_GPIO);
+}
+
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init)
+{
+    uint32_t idx = Sim_PortIndex(GPIOx);
+
+    for (uint32_t line = 0; line < 16U; line++)
+    {
+        uint32_t bit = 1UL << line;
+        if ((GPIO_Init->Pin & bit) == 0U)
+        {
+            continue;
+        }
+
+        bool output = (GPIO_Init->Mode == GPIO_MODE_OUTPUT_PP) || (GPIO_Init->Mode == GPIO_MODE_OUTPUT_OD);
+        if (output)
+        {
+            outputMask[idx] |= (uint16_t)bit;
+            GPIOx->IDR = (GPIOx->IDR & ~bit) | (GPIOx->ODR & bit);
+        }
+        else
+        {
+            outputMask[idx] &= (uint16_t)~bit;
+            if (GPIO_Init->Pull == GPIO_PULLUP)
+            {
+                GPIOx->IDR |= bit;
+            }
+            else if (GPIO_Init->Pull == GPIO_PULLDOWN)
+            {
+                GPIOx->IDR &= ~bit;
+            }
+        }
+
+        // Tryby IT_*: bity 20/21 = zbocze narastające/opadające (jak w HAL)
+        if ((GPIO_Init->Mode & 0x10000000U) != 0U)
+        {
+            extiPort[line] = GPIOx;
+            EXTI->IMR |= bit;
+            EXTI->RTSR = ((GPIO_Init->Mode & 0x00100000U) != 0U) ? (EXTI->RTSR | bit) : (EXTI->RTSR & ~bit);
+            EXTI->FTSR = ((GPIO_Init->Mode & 0x00200000U) != 0U) ? (EXTI->FTSR | bit) : (EXTI->FTSR & ~bit);
+        }
+    }
+    Sim_Advance(SIM_COST_HAL_CALL);
+}
+
+void HAL_GPIO_DeInit(GPIO_TypeDef *GPIOx, uint32_t GPIO_Pin)
+{
+    outputMask[Sim_PortIndex(GPIOx)] &= (uint16_t)~GPIO_Pin;
+    for (uint32_t line = 0; line < 16U; line++)
+    {
+        if (((GPIO_Pin & (1UL << line)) != 0U) && (extiPort[line] == GPIOx))
+        {
+            extiPort[line] = NULL;
+            EXTI->IMR &= ~(1UL << line);
+        }
+    }
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+    Sim_Advance(SIM_COST_GPIO_READ);
+    return ((GPIOx->IDR & GPIO_Pin) != 0U) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState)
+{
+    uint32_t old = GPIOx->ODR;
+    GPIOx->ODR = (PinState != GPIO_PIN_RESET) ? (old | GPIO_Pin) : (old & ~(uint32_t)GPIO_Pin);
+
+    uint16_t out = outputMask[Sim_PortIndex(GPIOx)];
+    GPIOx->IDR = (GPIOx->IDR & ~(uint32_t)out) | (GPIOx->ODR & out);
+
+    Sim_Advance(SIM_COST_GPIO_WRITE);
+    if ((old ^ GPIOx->ODR) != 0U)
+    {
+        Hd44780_PinChanged(GPIOx, (uint16_t)(old ^ GPIOx->ODR));
+    }
+}
+
+/**
+ * @brief Zmiana poziomu na wejściu (skrypt, model): zbocze zgłasza EXTI linii,
+ *        jeśli linia jest przypisana do tego portu i zbocze włączone.
+ */
+void Sim_GpioInput(GPIO_TypeDef *port, uint16_t pin, bool high)
+{
+    uint32_t old = port->IDR;
+    port->IDR = high ? (old | pin) : (old & ~(uint32_t)pin);
+    if (old == port->IDR)
+    {
+        return;
+    }
+
+    for (uint32_t line = 0; line < 16U; line++)
+    {
+        uint32_t bit = 1UL << line;
+        if (((pin & bit) == 0U) || (extiPort[line] != port) || ((EXTI->IMR & bit) == 0U))
+        {
+            continue;
+        }
+        if ((high && ((EXTI->RTSR & bit) != 0U)) || (!high && ((EXTI->FTSR & bit) != 0U)))
+        {
+            EXTI->PR |= bit;
+            Sim_Pend((line >= 10U) ? EXTI15_10_IRQn : EXTI9_5_IRQn);
+        }
+    }
+}
+
+void HAL_GPIO_EXTI_IRQHandler(uint16_t GPIO_Pin)
+{
+    if ((EXTI->PR & GPIO_Pin) != 0U)
+    {
+        EXTI->PR &= ~(uint32_t)GPIO_Pin;
+        HAL_GPIO_EXTI_Callback(GPIO_Pin);
+    }
+}
+
+/* ---------------------------------------------------------------------------
+   TIM: PWM/update (TIM3) i enkoder (TIM1)
+   -----------------------------------------------------------------------------*/
+
+static void Sim_TimUpdateEvent(uint32_t arg)
+{
+    TIM_TypeDef *tim = (arg == 3U) ? TIM3 : TIM1;
+    if ((tim->CR1 & TIM_CR1_CEN) == 0U)
+    {
+        return;     // licznik zatrzymany – PWM_Start zaplanuje od nowa
+    }
+
+    tim->SR |= TIM_SR_UIF;
+    if ((tim->DIER & TIM_IT_UPDATE) != 0U)
+    {
+        Sim_Pend((tim == TIM3) ? TIM3_IRQn : TIM1_UP_IRQn);
+    }
+    uint64_t period = ((uint64_t)tim->PSC + 1U) * ((uint64_t)tim->ARR + 1U);
+    Sim_Schedule(Sim_Now() + period, Sim_TimUpdateEvent, arg);
+}
+
+static void Sim_TimBaseInit(TIM_HandleTypeDef *htim)
+{
+    htim->Instance->PSC = htim->Init.Prescaler;
+    htim->Instance->ARR = htim->Init.Period;
+    htim->State = HAL_TIM_STATE_READY;
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_Init(TIM_HandleTypeDef *htim)
+{
+    HAL_TIM_PWM_MspInit(htim);
+    Sim_TimBaseInit(htim);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_ConfigChannel(TIM_HandleTypeDef *htim, TIM_OC_InitTypeDef *sConfig, uint32_t Channel)
+{
+    __HAL_TIM_SET_COMPARE(htim, Channel, sConfig->Pulse);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef *htim, uint32_t Channel)
+{
+    TIM_TypeDef *tim = htim->Instance;
+    tim->CCER |= TIM_CCER_CC1E << Channel;
+    if ((tim->CR1 & TIM_CR1_CEN) == 0U)
+    {
+        tim->CR1 |= TIM_CR1_CEN;
+        uint64_t period = ((uint64_t)tim->PSC + 1U) * ((uint64_t)tim->ARR + 1U);
+        Sim_Schedule(Sim_Now() + period, Sim_TimUpdateEvent, (tim == TIM3) ? 3U : 1U);
+    }
+    Sim_Advance(SIM_COST_HAL_CALL);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_Encoder_Init(TIM_HandleTypeDef *htim, TIM_Encoder_InitTypeDef *sConfig)
+{
+    (void)sConfig;
+    HAL_TIM_Encoder_MspInit(htim);
+    Sim_TimBaseInit(htim);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_Encoder_Start(TIM_HandleTypeDef *htim, uint32_t Channel)
+{
+    (void)Channel;
+    // Zliczanie zboczy A/B – bez zdarzeń czasowych, licznik przesuwa Sim_EncoderStep
+    htim->Instance->CCER |= TIM_CCER_CC1E | TIM_CCER_CC2E;
+    htim->Instance->CR1  |= TIM_CR1_CEN;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIMEx_MasterConfigSynchronization(TIM_HandleTypeDef *htim, TIM_MasterConfigTypeDef *sMasterConfig)
+{
+    (void)htim;
+    (void)sMasterConfig;
+    return HAL_OK;
+}
+
+void HAL_TIM_IRQHandler(TIM_HandleTypeDef *htim)
+{
+    static const uint32_t ccFlags[4] = { TIM_SR_CC1IF, TIM_SR_CC2IF, TIM_SR_CC3IF, TIM_SR_CC4IF };
+    TIM_TypeDef *tim = htim->Instance;
+
+    for (uint32_t ch = 0; ch < 4U; ch++)
+    {
+        if (((tim->SR & ccFlags[ch]) != 0U) && ((tim->DIER & ccFlags[ch]) != 0U))
+        {
+            tim->SR &= ~ccFlags[ch];
+            htim->Channel = (HAL_TIM_ActiveChannel)(1U << ch);
+            HAL_TIM_IC_CaptureCallback(htim);
+            htim->Channel = HAL_TIM_ACTIVE_CHANNEL_CLEARED;
+        }
+    }
+    if (((tim->SR & TIM_SR_UIF) != 0U) && ((tim->DIER & TIM_IT_UPDATE) != 0U))
+    {
+        tim->SR &= ~TIM_SR_UIF;
+        HAL_TIM_PeriodElapsedCallback(htim);
+    }
+}
+
+/**
+ * @brief Jedno zbocze enkodera (TI12: 4 zbocza na ząbek, kanały na przemian).
+ *        Obrót w prawo = A wyprzedza B = licznik w górę. Capture (IC1Polarity/
+ *        IC2Polarity = RISING) zgłasza tylko zbocza narastające A i B.
+ */
+void Sim_EncoderStep(int dir)
+{
+    TIM_TypeDef *tim = TIM1;
+    if ((tim->CR1 & TIM_CR1_CEN) == 0U)
+    {
+        return;
+    }
+
+    // Poziomy A/B na PA8/PA9 (faza 0: 00, 1: 10, 2: 11, 3: 01)
+    static const uint8_t levels[4] = { 0x0U, 0x1U, 0x3U, 0x2U };
+    uint8_t oldLevels = levels[encPhase];
+    encPhase = (uint8_t)((encPhase + ((dir > 0) ? 1U : 3U)) & 0x03U);
+    uint8_t rising = (uint8_t)(levels[encPhase] & (uint8_t)~oldLevels);
+
+    GPIOA->IDR = (GPIOA->IDR & ~(uint32_t)(GPIO_PIN_8 | GPIO_PIN_9)) | ((uint32_t)levels[encPhase] << 8);
+
+    uint32_t arr = tim->ARR;
+    uint32_t cnt = tim->CNT;
+    if (dir > 0)
+    {
+        cnt = (cnt >= arr) ? 0U : (cnt + 1U);
+    }
+    else
+    {
+        cnt = (cnt == 0U) ? arr : (cnt - 1U);
+    }
+    if (((dir > 0) && (cnt == 0U)) || ((dir < 0) && (cnt == arr)))
+    {
+        tim->SR |= TIM_SR_UIF;
+        if ((tim->DIER & TIM_IT_UPDATE) != 0U)
+        {
+            Sim_Pend(TIM1_UP_IRQn);
+        }
+    }
+    tim->CNT = cnt;
+
+    if (rising == 0U)
+    {
+        return;
+    }
+    uint32_t flag = ((rising & 0x1U) != 0U) ? TIM_SR_CC1IF : TIM_SR_CC2IF;
+    if (flag == TIM_SR_CC1IF)
+    {
+        tim->CCR1 = cnt;
+    }
+    else
+    {
+        tim->CCR2 = cnt;
+    }
+    tim->SR |= flag;
+    if ((tim->DIER & flag) != 0U)
+    {
+        Sim_Pend(TIM1_CC_IRQn);
+    }
+}
+
+/* ---------------------------------------------------------------------------
+   I2C1: transakcje przekazywane do modeli urządzeń
+   -----------------------------------------------------------------------------*/
+
+void Sim_I2cAttach(const SimI2cDevice_t *dev)
+{
+    if (i2cCount < SIM_I2C_DEVICES)
+    {
+        i2c[i2cCount++].dev = dev;
+    }
+}
+
+static SimI2cSlot_t *Sim_I2cFind(uint8_t addr)
+{
+    for (uint8_t i = 0; i < i2cCount; i++)
+    {
+        if (i2c[i].dev->addr == addr)
+        {
+            return &i2c[i];
+        }
+    }
+    return NULL;
+}
+
+void Sim_I2cFail(uint8_t addr, uint16_t count)
+{
+    SimI2cSlot_t *slot = Sim_I2cFind(addr);
+    if (slot != NULL)
+    {
+        slot->failNext = count;
+    }
+}
+
+/**
+ * @brief Czas na magistrali: 9 bitów na bajt (z ACK) + START/STOP.
+ */
+static void Sim_I2cBusTime(const I2C_HandleTypeDef *hi2c, uint32_t bytes)
+{
+    uint32_t hz   = (hi2c->Init.ClockSpeed != 0U) ? hi2c->Init.ClockSpeed : 100000U;
+    uint64_t bits = ((uint64_t)bytes * 9U) + 2U;
+    Sim_Advance((uint32_t)((bits * SIM_CPU_HZ) / hz));
+}
+
+/**
+ * @brief Transakcja: zapis wrLen bajtów, potem (RESTART) odczyt rdLen bajtów.
+ *        Brak urządzenia albo wymuszony błąd = NACK adresu.
+ */
+static HAL_StatusTypeDef Sim_I2cTransfer(I2C_HandleTypeDef *hi2c, uint16_t devAddress,
+                                         const uint8_t *wr, uint16_t wrLen,
+                                         uint8_t *rd, uint16_t rdLen)
+{
+    SimI2cSlot_t *slot = Sim_I2cFind((uint8_t)(devAddress >> 1));
+
+    Sim_Stats.i2cTransfers++;
+    if ((slot == NULL) || (slot->failNext > 0U))
+    {
+        if (slot != NULL)
+        {
+            slot->failNext--;
+            slot->transfers++;
+            slot->errors++;
+        }
+        Sim_Stats.i2cErrors++;
+        hi2c->ErrorCode = HAL_I2C_ERROR_AF;
+        Sim_I2cBusTime(hi2c, 1U);
+        return HAL_ERROR;
+    }
+
+    uint32_t bytes = 0;
+    if (wrLen > 0U)
+    {
+        slot->dev->write(wr, wrLen);
+        bytes += 1U + wrLen;
+    }
+    if (rdLen > 0U)
+    {
+        slot->dev->read(rd, rdLen);
+        bytes += 1U + rdLen;
+    }
+
+    slot->transfers++;
+    slot->bytes += bytes;
+    Sim_Stats.i2cBytes += bytes;
+    hi2c->ErrorCode = 0;
+    Sim_I2cBusTime(hi2c, bytes);
+    return HAL_OK;
+}
+
+void Sim_I2cReport(FILE *out)
+{
+    for (uint8_t i = 0; i < i2cCount; i++)
+    {
+        fprintf(out, "  i2c 0x%02X %-8s %8u transfers %9u bytes %6u errors\n",
+                i2c[i].dev->addr, i2c[i].dev->name,
+                i2c[i].transfers, i2c[i].bytes, i2c[i].errors);
+    }
+}
+
+HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef *hi2c)
+{
+    HAL_I2C_MspInit(hi2c);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Transmit(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData,
+                                          uint16_t Size, uint32_t Timeout)
+{
+    (void)Timeout;
+    return Sim_I2cTransfer(hi2c, DevAddress, pData, Size, NULL, 0);
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Receive(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData,
+                                         uint16_t Size, uint32_t Timeout)
+{
+    (void)Timeout;
+    return Sim_I2cTransfer(hi2c, DevAddress, NULL, 0, pData, Size);
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+                                    uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+    uint8_t buf[1U + 32U];
+    (void)MemAddSize;
+    (void)Timeout;
+
+    if (Size > 32U)
+    {
+        return HAL_ERROR;
+    }
+    buf[0] = (uint8_t)MemAddress;
+    memcpy(&buf[1], pData, Size);
+    return Sim_I2cTransfer(hi2c, DevAddress, buf, (uint16_t)(Size + 1U), NULL, 0);
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+                                   uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+    uint8_t reg = (uint8_t)MemAddress;
+    (void)MemAddSize;
+    (void)Timeout;
+    return Sim_I2cTransfer(hi2c, DevAddress, &reg, 1, pData, Size);
+}
+
+/* ---------------------------------------------------------------------------
+   USART2 + DMA1 (Channel6 = RX kołowy, Channel7 = TX)
+   -----------------------------------------------------------------------------*/
+
+static uint32_t Sim_DmaChannel(const DMA_HandleTypeDef *hdma)
+{
+    return (uint32_t)(hdma->Instance - Sim_DMA1_Channel) + 1U;
+}
+
+static uint64_t Sim_UartByteCycles(void)
+{
+    uint32_t baud = ((uart != NULL) && (uart->Init.BaudRate != 0U)) ? uart->Init.BaudRate : 115200U;
+    return (10ULL * SIM_CPU_HZ) / baud;     // start + 8 bitów + stop
+}
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma)
+{
+    hdma->State = HAL_DMA_STATE_READY;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_DeInit(DMA_HandleTypeDef *hdma)
+{
+    hdma->Instance->CCR = 0;
+    hdma->State = HAL_DMA_STATE_RESET;
+    return HAL_OK;
+}
+
+void HAL_DMA_IRQHandler(DMA_HandleTypeDef *hdma)
+{
+    uint32_t            ch    = Sim_DmaChannel(hdma);
+    UART_HandleTypeDef *huart = (UART_HandleTypeDef *)hdma->Parent;
+
+    if (((DMA1->ISR & DMA_FLAG_HT(ch)) != 0U) && ((hdma->Instance->CCR & DMA_CCR_HTIE) != 0U))
+    {
+        DMA1->ISR &= ~DMA_FLAG_HT(ch);
+        if ((huart != NULL) && (hdma == huart->hdmarx))
+        {
+            HAL_UART_RxHalfCpltCallback(huart);
+        }
+    }
+    if (((DMA1->ISR & DMA_FLAG_TC(ch)) != 0U) && ((hdma->Instance->CCR & DMA_CCR_TCIE) != 0U))
+    {
+        DMA1->ISR &= ~(DMA_FLAG_TC(ch) | DMA_FLAG_GL(ch));
+        if (huart == NULL)
+        {
+            return;
+        }
+        if (hdma == huart->hdmatx)
+        {
+            hdma->Instance->CCR &= ~DMA_CCR_EN;
+            huart->Instance->CR3 &= ~USART_CR3_DMAT;
+            huart->gState = HAL_UART_STATE_READY;
+            HAL_UART_TxCpltCallback(huart);
+        }
+        else if (hdma == huart->hdmarx)
+        {
+            if ((hdma->Instance->CCR & DMA_CCR_CIRC) == 0U)
+            {
+                hdma->Instance->CCR &= ~DMA_CCR_EN;
+                huart->RxState = HAL_UART_STATE_READY;
+            }
+            HAL_UART_RxCpltCallback(huart);
+        }
+    }
+}
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart)
+{
+    uart = huart;
+    HAL_UART_MspInit(huart);
+    huart->Instance->BRR = SIM_CPU_HZ / 2U / huart->Init.BaudRate;   // PCLK1 = 32 MHz
+    huart->gState  = HAL_UART_STATE_READY;
+    huart->RxState = HAL_UART_STATE_READY;
+    return HAL_OK;
+}
+
+static void Sim_UartTxDone(uint32_t arg)
+{
+    (void)arg;
+    DMA1_Channel7->CNDTR = 0;
+    DMA1->ISR |= DMA_FLAG_TC(7U) | DMA_FLAG_GL(7U);
+    Sim_Pend(DMA1_Channel7_IRQn);
+}
+
+/**
+ * @brief Dane trafiają do strumienia od razu, koniec DMA – po czasie transmisji.
+ */
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size)
+{
+    if (huart->gState != HAL_UART_STATE_READY)
+    {
+        return HAL_BUSY;
+    }
+    if ((pData == NULL) || (Size == 0U) || (huart->hdmatx == NULL))
+    {
+        return HAL_ERROR;
+    }
+
+    huart->gState     = HAL_UART_STATE_BUSY_TX;
+    huart->pTxBuffPtr = pData;
+    huart->TxXferSize = Size;
+    huart->hdmatx->Instance->CNDTR = Size;
+    huart->hdmatx->Instance->CCR   = DMA_CCR_EN | DMA_CCR_TCIE;
+    huart->Instance->CR3 |= USART_CR3_DMAT;
+
+    if (Sim_UartOut != NULL)
+    {
+        fwrite(pData, 1, Size, Sim_UartOut);
+    }
+    Sim_Stats.uartTxBytes += Size;
+
+    Sim_Schedule(Sim_Now() + (Size * Sim_UartByteCycles()), Sim_UartTxDone, 0);
+    Sim_Advance(SIM_COST_HAL_CALL);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Receive_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+    if (huart->RxState != HAL_UART_STATE_READY)
+    {
+        return HAL_BUSY;
+    }
+    if ((pData == NULL) || (Size == 0U) || (huart->hdmarx == NULL))
+    {
+        return HAL_ERROR;
+    }
+
+    DMA_Channel_TypeDef *ch = huart->hdmarx->Instance;
+    huart->RxState    = HAL_UART_STATE_BUSY_RX;
+    huart->pRxBuffPtr = pData;
+    huart->RxXferSize = Size;
+    ch->CMAR  = (uint32_t)(uintptr_t)pData;
+    ch->CNDTR = Size;
+    ch->CCR   = DMA_CCR_EN | DMA_CCR_TCIE | DMA_CCR_HTIE |
+                ((huart->hdmarx->Init.Mode == DMA_CIRCULAR) ? DMA_CCR_CIRC : 0U);
+    huart->Instance->CR3 |= USART_CR3_DMAR;
+
+    Sim_Advance(SIM_COST_HAL_CALL);
+    return HAL_OK;
+}
+
+void HAL_UART_IRQHandler(UART_HandleTypeDef *huart)
+{
+    (void)huart;    // błędy linii nie są modelowane
+}
+
+/**
+ * @brief Bajt na linii RX: zapis DMA do bufora, flagi połowy/końca bufora.
+ */
+static void Sim_UartRxByte(uint32_t byte)
+{
+    DMA_Channel_TypeDef *ch = DMA1_Channel6;
+    Sim_Stats.uartRxBytes++;
+
+    if ((uart == NULL) || (uart->RxState != HAL_UART_STATE_BUSY_RX) || ((ch->CCR & DMA_CCR_EN) == 0U))
+    {
+        return;     // nikt nie odbiera – bajt ginie (overrun)
+    }
+
+    uart->pRxBuffPtr[uart->RxXferSize - ch->CNDTR] = (uint8_t)byte;
+    ch->CNDTR--;
+
+    if (ch->CNDTR == (uart->RxXferSize / 2U))
+    {
+        DMA1->ISR |= DMA_FLAG_HT(6U) | DMA_FLAG_GL(6U);
+        Sim_Pend(DMA1_Channel6_IRQn);
+    }
+    if (ch->CNDTR == 0U)
+    {
+        DMA1->ISR |= DMA_FLAG_TC(6U) | DMA_FLAG_GL(6U);
+        Sim_Pend(DMA1_Channel6_IRQn);
+        if ((ch->CCR & DMA_CCR_CIRC) != 0U)
+        {
+            ch->CNDTR = uart->RxXferSize;
+        }
+    }
+}
+
+static void Sim_UartRxIdle(uint32_t arg)
+{
+    (void)arg;
+    USART2->SR |= USART_SR_IDLE;
+    if ((USART2->CR1 & USART_CR1_IDLEIE) != 0U)
+    {
+        Sim_Pend(USART2_IRQn);
+    }
+}
+
+/**
+ * @brief Tekst na wejściu konsoli: bajty jeden po drugim z prędkością linii,
+ *        po ostatnim – IDLE po czasie jednego znaku.
+ */
+void Sim_UartRx(const char *data, uint16_t len)
+{
+    uint64_t byteCycles = Sim_UartByteCycles();
+    uint64_t t = (rxBusyUntil > Sim_Now()) ? rxBusyUntil : Sim_Now();
+
+    for (uint16_t i = 0; i < len; i++)
+    {
+        t += byteCycles;
+        Sim_Schedule(t, Sim_UartRxByte, (uint8_t)data[i]);
+    }
+    rxBusyUntil = t;
+    Sim_Schedule(t + byteCycles, Sim_UartRxIdle, 0);
+}
+
+/* ---------------------------------------------------------------------------
+   FLASH: strony ustawień (opcjonalnie zapisywane do pliku)
+   -----------------------------------------------------------------------------*/
+
+static void Sim_FlashSave(void)
+{
+    if (flashPath == NULL)
+    {
+        return;
+    }
+    FILE *f = fopen(flashPath, "wb");
+    if (f != NULL)
+    {
+        fwrite(_settings_start, 1, sizeof(_settings_start), f);
+        fclose(f);
+    }
+}
+
+/**
+ * @brief Obraz stron ustawień z pliku (brak pliku = skasowany flash); zmiany
+ *        są zapisywane z powrotem, więc kolejne uruchomienie startuje z nich.
+ */
+bool Sim_FlashOpen(const char *path)
+{
+    flashPath = path;
+    FILE *f = fopen(path, "rb");
+    if (f == NULL)
+    {
+        return false;
+    }
+    size_t n = fread(_settings_start, 1, sizeof(_settings_start), f);
+    fclose(f);
+    return n == sizeof(_settings_start);
+}
+
+static bool Sim_FlashInRange(uint32_t address, uint32_t size)
+{
+    uint32_t start = (uint32_t)(uintptr_t)_settings_start;
+    return (address >= start) && ((address + size) <= (start + SIM_SETTINGS_SIZE));
+}
+
+HAL_StatusTypeDef HAL_FLASH_Unlock(void)
+{
+    flashUnlocked = true;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Lock(void)
+{
+    flashUnlocked = false;
+    return HAL_OK;
+}
+
+/**
+ * @brief Programowanie po half-wordzie; jak w F1 – komórka musi być skasowana
+ *        (0xFFFF), wyjątkiem jest zapis zera.
+ */
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint64_t Data)
+{
+    uint32_t halfWords = (TypeProgram == FLASH_TYPEPROGRAM_HALFWORD) ? 1U :
+                         (TypeProgram == FLASH_TYPEPROGRAM_WORD)     ? 2U : 4U;
+
+    if (!flashUnlocked || ((Address & 1U) != 0U) || !Sim_FlashInRange(Address, halfWords * 2U))
+    {
+        return HAL_ERROR;
+    }
+
+    for (uint32_t i = 0; i < halfWords; i++)
+    {
+        uint16_t *cell  = (uint16_t *)(uintptr_t)(Address + (2U * i));
+        uint16_t  value = (uint16_t)(Data >> (16U * i));
+        Sim_Advance((uint32_t)SIM_US(FLASH_PROGRAM_US));
+        if ((*cell != 0xFFFFU) && (value != 0U))
+        {
+            Sim_FlashSave();
+            return HAL_ERROR;   // PGERR
+        }
+        *cell = value;
+    }
+
+    Sim_Stats.flashWrites++;
+    Sim_FlashSave();
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef *pEraseInit, uint32_t *PageError)
+{
+    *PageError = 0xFFFFFFFFU;
+    if (!flashUnlocked)
+    {
+        return HAL_ERROR;
+    }
+
+    for (uint32_t page = 0; page < pEraseInit->NbPages; page++)
+    {
+        uint32_t addr = pEraseInit->PageAddress + (page * FLASH_PAGE_SIZE);
+        if (!Sim_FlashInRange(addr, FLASH_PAGE_SIZE))
+        {
+            *PageError = addr;
+            return HAL_ERROR;
+        }
+        // Rdzeń stoi w czasie kasowania (odczyt flasha zablokowany)
+        Sim_Advance((uint32_t)SIM_MS(FLASH_ERASE_MS));
+        memset((void *)(uintptr_t)addr, 0xFF, FLASH_PAGE_SIZE);
+        Sim_Stats.flashErases++;
+    }
+
+    Sim_FlashSave();
+    return HAL_OK;
+}
+
+/* ---------------------------------------------------------------------------
+   RCC, PWR
+   -----------------------------------------------------------------------------*/
+
+HAL_StatusTypeDef HAL_RCC_OscConfig(RCC_OscInitTypeDef *RCC_OscInitStruct)
+{
+    (void)RCC_OscInitStruct;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RCC_ClockConfig(RCC_ClkInitTypeDef *RCC_ClkInitStruct, uint32_t FLatency)
+{
+    (void)RCC_ClkInitStruct;
+    (void)FLatency;
+    SystemCoreClock = SIM_CPU_HZ;   // HSI/2 * 16
+    return HAL_OK;
+}
+
+uint32_t HAL_RCC_GetHCLKFreq(void)
+{
+    return SystemCoreClock;
+}
+
+void HAL_PWR_EnableBkUpAccess(void)
+{
+}
+
+/**
+ * @brief Stan po włączeniu zasilania i okablowanie płytki.
+ */
+void Sim_HalInit(void)
+{
+    memset(_settings_start, 0xFF, sizeof(_settings_start));
+    RCC->CSR = RCC_CSR_PORRSTF | RCC_CSR_PINRSTF;
+
+    // B1 na Nucleo: zewnętrzny pull-up, naciśnięcie = stan niski
+    GPIOC->IDR |= GPIO_PIN_13;
+}
+
+/* ---------------------------------------------------------------------------
+   Domyślne (słabe) callbacki i MSP – jak w bibliotece HAL
+   -----------------------------------------------------------------------------*/
+
+__attribute__((weak)) void HAL_MspInit(void) { }
+__attribute__((weak)) void HAL_I2C_MspInit(I2C_HandleTypeDef *hi2c) { (void)hi2c; }
+__attribute__((weak)) void HAL_TIM_PWM_MspInit(TIM_HandleTypeDef *htim) { (void)htim; }
+__attribute__((weak)) void HAL_TIM_Encoder_MspInit(TIM_HandleTypeDef *htim) { (void)htim; }
+__attribute__((weak)) void HAL_UART_MspInit(UART_HandleTypeDef *huart) { (void)huart; }
+__attribute__((weak)) void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin) { (void)GPIO_Pin; }
+__attribute__((weak)) void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim) { (void)htim; }
+__attribute__((weak)) void HAL_TIM_IC_CaptureCallback(TIM_HandleTypeDef *htim) { (void)htim; }
+__attribute__((weak)) void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart) { (void)huart; }
+__attribute__((weak)) void HAL_UART_RxHalfCpltCallback(UART_HandleTypeDef *huart) { (void)huart; }
+__attribute__((weak)) void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart) { (void)huart; }
+__attribute__((weak)) void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart) { (void)huart; }
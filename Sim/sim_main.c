@@ -0,0 +1,436 @@
+// Created by: Marcin Dziedzic
+// sim_main.c
+
+#include "sim.h"
+#include "main.h"
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/* ----------------------------------------------------------------------------
+   Punkt wejścia symulacji: opcje, skrypt scenariusza i raport końcowy.
+   Firmware (Core/Src/main.c, skompilowany jako Firmware_Main) startuje jak po
+   resecie i nie wraca; skrypt działa z kolejki zdarzeń, raport kończy proces.
+
+   Skrypt – jedna komenda na linię, '#' = komentarz:
+     @<ms> <komenda>        czas bezwzględny od resetu
+     +<ms> <komenda>        czas względem poprzedniej linii
+   Komendy:
+     rotate <N> [ms]        N ząbków enkodera (ujemne = w lewo), ms na ząbek
+     press [ms] [drgania]   przycisk enkodera, czas trzymania i drgań styków
+     b1                     przycisk B1 (Nucleo)
+     fault <1|2> [ms]       zwarcie na porcie USB (linia FLT w stanie niskim)
+     lux <lx>               natężenie światła dla BH1750
+     uart <tekst>           linia na konsolę (dopisywane \r)
+     lcd                    wypisuje zawartość wyświetlacza
+     lamp                   wypisuje wypełnienie PWM lampy
+     time <RRRR-MM-DD GG:MM:SS>  przestawia zegar PCF85063
+     nack <adres> <N>       N kolejnych transakcji I2C do adresu dostanie NACK
+     quit                   raport i koniec (także po ostatniej linii skryptu)
+   -----------------------------------------------------------------------------*/
+
+#define SIM_RAM_SIZE            (20U * 1024U)     // STM32F103RB
+#define SIM_SCRIPT_LINES        1024U
+#define SIM_LINE_LEN            128U
+#define SIM_DEFAULT_DETENT_MS   40U
+#define SIM_DEFAULT_PRESS_MS    100U
+#define SIM_DEFAULT_FAULT_MS    50U
+#define SIM_WATCH_MS            10U               // sprawdzanie Ctrl-C / limitu czasu
+
+typedef struct
+{
+    uint64_t when;
+    char     text[SIM_LINE_LEN];
+} SimLine_t;
+
+int Firmware_Main(void);
+
+// Model RAM urządzenia dla memstat.c (symbole linkera z Makefile)
+uint32_t Sim_Ram[SIM_RAM_SIZE / 4U];
+
+static SimLine_t             script[SIM_SCRIPT_LINES];
+static uint32_t              scriptLen = 0;
+static uint32_t              scriptPos = 0;
+static uint8_t              *heapTop = (uint8_t *)Sim_Ram;
+static volatile sig_atomic_t stopRequested = 0;
+static struct timespec       wallStart;
+
+static int      rotateLeft;         // pozostałe zbocza enkodera (znak = kierunek)
+static uint64_t rotateEdgeCycles;
+
+void *Sim_Sbrk(ptrdiff_t incr)
+{
+    uint8_t *prev = heapTop;
+    heapTop += incr;
+    return prev;
+}
+
+/* ---------------------------------------------------------------------------
+   Raport
+   -----------------------------------------------------------------------------*/
+
+static double Sim_WallSeconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)(ts.tv_sec - wallStart.tv_sec) + ((double)(ts.tv_nsec - wallStart.tv_nsec) / 1e9);
+}
+
+static void Sim_Report(void)
+{
+    double simSec  = (double)Sim_Now() / SIM_CPU_HZ;
+    double wallSec = Sim_WallSeconds();
+    double busy    = (Sim_Now() > 0U) ? (1.0 - ((double)Sim_Stats.idleCycles / (double)Sim_Now())) : 0.0;
+    double loopMs  = (Sim_Stats.loops > 0U) ? (Sim_NowMs() / Sim_Stats.loops) : 0.0;
+
+    fflush(Sim_UartOut);
+    fprintf(stdout, "\n---- sim report ----\n");
+    fprintf(stdout, "  simulated  %.3f s, wall %.3f s (x%.1f)\n", simSec, wallSec,
+            (wallSec > 0.0) ? (simSec / wallSec) : 0.0);
+    fprintf(stdout, "  main loop  %u passes, %.3f ms per pass, CPU load %.2f%%\n",
+            Sim_Stats.loops, loopMs, busy * 100.0);
+    fprintf(stdout, "  uart       %u B out, %u B in\n", Sim_Stats.uartTxBytes, Sim_Stats.uartRxBytes);
+    fprintf(stdout, "  flash      %u writes, %u page erases\n", Sim_Stats.flashWrites, Sim_Stats.flashErases);
+    Sim_PrintIrqStats(stdout);
+    Sim_I2cReport(stdout);
+    Hd44780_Report(stdout);
+    Hd44780_Print(stdout);
+}
+
+static void Sim_Quit(void)
+{
+    Sim_Report();
+    Sim_Exit(0);
+}
+
+static void Sim_Signal(int sig)
+{
+    (void)sig;
+    stopRequested = 1;
+}
+
+static void Sim_WatchEvent(uint32_t arg)
+{
+    (void)arg;
+    if (stopRequested)
+    {
+        fprintf(stdout, "[%10.3f] sim: stopped\n", Sim_NowMs());
+        Sim_Quit();
+    }
+    Sim_Schedule(Sim_Now() + SIM_MS(SIM_WATCH_MS), Sim_WatchEvent, 0);
+}
+
+/* ---------------------------------------------------------------------------
+   Wejścia: piny, enkoder
+   -----------------------------------------------------------------------------*/
+
+// arg = indeks portu << 8 | numer pinu << 1 | poziom
+static uint32_t Sim_PinArg(GPIO_TypeDef *port, uint16_t pin, bool high)
+{
+    return ((uint32_t)(port - Sim_GPIO) << 8) | ((uint32_t)__builtin_ctz(pin) << 1) | (high ? 1U : 0U);
+}
+
+static void Sim_PinEvent(uint32_t arg)
+{
+    Sim_GpioInput(&Sim_GPIO[arg >> 8], (uint16_t)(1U << ((arg >> 1) & 0x0FU)), (arg & 1U) != 0U);
+}
+
+/**
+ * @brief Przejście pinu na poziom level w chwili when; przy bounce > 0 styk
+ *        najpierw kilka razy odbija (zmiany co bounce/4).
+ */
+static void Sim_PinSchedule(uint64_t when, GPIO_TypeDef *port, uint16_t pin, bool level, uint64_t bounce)
+{
+    if (bounce > 0U)
+    {
+        for (uint32_t i = 0; i < 3U; i++)
+        {
+            bool l = ((i & 1U) == 0U) ? level : !level;
+            Sim_Schedule(when + ((bounce * i) / 4U), Sim_PinEvent, Sim_PinArg(port, pin, l));
+        }
+    }
+    Sim_Schedule(when + bounce, Sim_PinEvent, Sim_PinArg(port, pin, level));
+}
+
+static void Sim_RotateEvent(uint32_t arg)
+{
+    (void)arg;
+    if (rotateLeft == 0)
+    {
+        return;
+    }
+    Sim_EncoderStep((rotateLeft > 0) ? 1 : -1);
+    rotateLeft += (rotateLeft > 0) ? -1 : 1;
+    if (rotateLeft != 0)
+    {
+        Sim_Schedule(Sim_Now() + rotateEdgeCycles, Sim_RotateEvent, 0);
+    }
+}
+
+static void Sim_PrintLamp(void)
+{
+    uint32_t arr   = TIM3->ARR;
+    uint32_t ccr   = TIM3->CCR4;
+    bool     on    = ((TIM3->CCER & TIM_CCER_CC4E) != 0U) && (ccr < arr);
+    // Wyjście odwrócone (envelope.c): CCR = ARR to lampa wyłączona
+    double   level = on ? ((double)(arr - ccr) * 100.0 / (double)(arr + 1U)) : 0.0;
+    fprintf(stdout, "[%10.3f] lamp: %.2f%% (CCR4=%u ARR=%u)\n", Sim_NowMs(), level, ccr, arr);
+}
+
+/* ---------------------------------------------------------------------------
+   Skrypt
+   -----------------------------------------------------------------------------*/
+
+static bool Sim_ParseTime(const char *text, int64_t *unixTime)
+{
+    struct tm tm;
+    memset(&tm, 0, sizeof(tm));
+    if (sscanf(text, "%d-%d-%d %d:%d:%d", &tm.tm_year, &tm.tm_mon, &tm.tm_mday,
+               &tm.tm_hour, &tm.tm_min, &tm.tm_sec) != 6)
+    {
+        return false;
+    }
+    tm.tm_year -= 1900;
+    tm.tm_mon  -= 1;
+    *unixTime = (int64_t)timegm(&tm);
+    return true;
+}
+
+static void Sim_RunCommand(const char *line)
+{
+    char     cmd[16] = "";
+    int      used    = 0;
+    uint64_t now     = Sim_Now();
+
+    sscanf(line, "%15s %n", cmd, &used);
+    const char *rest = line + used;
+
+    if (strcmp(cmd, "rotate") == 0)
+    {
+        int      detents = 0;
+        unsigned ms      = SIM_DEFAULT_DETENT_MS;
+        sscanf(rest, "%d %u", &detents, &ms);
+        rotateLeft       = detents * 4;     // 4 zbocza na ząbek (TI12)
+        rotateEdgeCycles = SIM_MS(ms) / 4U;
+        Sim_RotateEvent(0);
+    }
+    else if (strcmp(cmd, "press") == 0)
+    {
+        unsigned ms = SIM_DEFAULT_PRESS_MS, bounce = 0;
+        sscanf(rest, "%u %u", &ms, &bounce);
+        Sim_PinSchedule(now, ENCODER_BTN_GPIO_Port, ENCODER_BTN_Pin, false, SIM_MS(bounce));
+        Sim_PinSchedule(now + SIM_MS(ms), ENCODER_BTN_GPIO_Port, ENCODER_BTN_Pin, true, SIM_MS(bounce));
+    }
+    else if (strcmp(cmd, "b1") == 0)
+    {
+        Sim_PinSchedule(now, B1_GPIO_Port, B1_Pin, false, 0);
+        Sim_PinSchedule(now + SIM_MS(SIM_DEFAULT_PRESS_MS), B1_GPIO_Port, B1_Pin, true, 0);
+    }
+    else if (strcmp(cmd, "fault") == 0)
+    {
+        unsigned port = 1, ms = SIM_DEFAULT_FAULT_MS;
+        sscanf(rest, "%u %u", &port, &ms);
+        uint16_t pin = (port == 2U) ? USB2_FLT_Pin : USB1_FLT_Pin;
+        Sim_PinSchedule(now, GPIOC, pin, false, 0);
+        Sim_PinSchedule(now + SIM_MS(ms), GPIOC, pin, true, 0);
+    }
+    else if (strcmp(cmd, "lux") == 0)
+    {
+        Bh1750_SetLux((uint32_t)strtoul(rest, NULL, 0));
+    }
+    else if (strcmp(cmd, "uart") == 0)
+    {
+        char text[SIM_LINE_LEN + 1U];
+        snprintf(text, sizeof(text), "%s\r", rest);
+        Sim_UartRx(text, (uint16_t)strlen(text));
+    }
+    else if (strcmp(cmd, "lcd") == 0)
+    {
+        Hd44780_Print(stdout);
+    }
+    else if (strcmp(cmd, "lamp") == 0)
+    {
+        Sim_PrintLamp();
+    }
+    else if (strcmp(cmd, "time") == 0)
+    {
+        int64_t t;
+        if (Sim_ParseTime(rest, &t))
+        {
+            Pcf85063_SetTime(t);
+        }
+    }
+    else if (strcmp(cmd, "nack") == 0)
+    {
+        unsigned addr = 0, count = 1;
+        sscanf(rest, "%i %u", (int *)&addr, &count);
+        Sim_I2cFail((uint8_t)addr, (uint16_t)count);
+    }
+    else if (strcmp(cmd, "quit") == 0)
+    {
+        Sim_Quit();
+    }
+    else
+    {
+        fprintf(stdout, "[%10.3f] sim: unknown command '%s'\n", Sim_NowMs(), line);
+    }
+}
+
+static void Sim_ScriptEvent(uint32_t arg)
+{
+    (void)arg;
+    while ((scriptPos < scriptLen) && (script[scriptPos].when <= Sim_Now()))
+    {
+        if (Sim_Verbose)
+        {
+            fprintf(stdout, "[%10.3f] > %s\n", Sim_NowMs(), script[scriptPos].text);
+        }
+        Sim_RunCommand(script[scriptPos++].text);
+    }
+
+    if (scriptPos < scriptLen)
+    {
+        Sim_Schedule(script[scriptPos].when, Sim_ScriptEvent, 0);
+    }
+    else
+    {
+        Sim_Quit();
+    }
+}
+
+static bool Sim_LoadScript(const char *path)
+{
+    FILE *f = (strcmp(path, "-") == 0) ? stdin : fopen(path, "r");
+    if (f == NULL)
+    {
+        perror(path);
+        return false;
+    }
+
+    char     line[SIM_LINE_LEN + 16U];
+    uint64_t t      = 0;
+    unsigned lineNo = 0;
+    while (fgets(line, sizeof(line), f) != NULL)
+    {
+        lineNo++;
+        line[strcspn(line, "\r\n#")] = '\0';
+
+        char  *p = line + strspn(line, " \t");
+        char   kind = *p;
+        char  *end;
+        if (kind == '\0')
+        {
+            continue;
+        }
+        if (((kind != '@') && (kind != '+')) || (scriptLen >= SIM_SCRIPT_LINES))
+        {
+            fprintf(stderr, "%s:%u: expected '@ms' or '+ms'\n", path, lineNo);
+            return false;
+        }
+
+        double ms = strtod(p + 1, &end);
+        t = ((kind == '@') ? 0U : t) + (uint64_t)(ms * (double)SIM_CYCLES_PER_MS);
+        script[scriptLen].when = t;
+        snprintf(script[scriptLen].text, SIM_LINE_LEN, "%s", end + strspn(end, " \t"));
+        scriptLen++;
+    }
+    if (f != stdin)
+    {
+        fclose(f);
+    }
+    return true;
+}
+
+/* ---------------------------------------------------------------------------
+   main
+   -----------------------------------------------------------------------------*/
+
+static void Sim_Usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s [options] [script]\n"
+            "  -u FILE   USART2 output (default: stdout, '-' = stdout)\n"
+            "  -w FILE   SWO (ITM) output, e.g. for Tools/trace_timeline.py\n"
+            "  -f FILE   settings flash image (loaded and updated)\n"
+            "  -T SEC    RTC start, unix time (default: host clock)\n"
+            "  -t SEC    wall-clock limit\n"
+            "  -v        print LCD changes and script steps\n",
+            prog);
+}
+
+static FILE *Sim_OpenOut(const char *path)
+{
+    if (strcmp(path, "-") == 0)
+    {
+        return stdout;
+    }
+    FILE *f = fopen(path, "wb");
+    if (f == NULL)
+    {
+        perror(path);
+        exit(2);
+    }
+    return f;
+}
+
+int main(int argc, char **argv)
+{
+    int64_t     rtcStart  = (int64_t)time(NULL);
+    unsigned    wallLimit = 0;
+    const char *flash     = NULL;
+    int         opt;
+
+    Sim_UartOut = stdout;
+    while ((opt = getopt(argc, argv, "u:w:f:T:t:vh")) != -1)
+    {
+        switch (opt)
+        {
+            case 'u': Sim_UartOut = Sim_OpenOut(optarg); break;
+            case 'w': Sim_SwoOut  = Sim_OpenOut(optarg); break;
+            case 'f': flash       = optarg; break;
+            case 'T': rtcStart    = strtoll(optarg, NULL, 0); break;
+            case 't': wallLimit   = (unsigned)strtoul(optarg, NULL, 0); break;
+            case 'v': Sim_Verbose = true; break;
+            default:
+                Sim_Usage(argv[0]);
+                return 2;
+        }
+    }
+    if ((optind < argc) && !Sim_LoadScript(argv[optind]))
+    {
+        return 2;
+    }
+
+    for (uint32_t i = 0; i < (SIM_RAM_SIZE / 4U); i++)
+    {
+        Sim_Ram[i] = 0xA5A5A5A5U;   // MEMSTAT_PAINT – jak kod startowy
+    }
+
+    Sim_CoreInit();
+    Sim_HalInit();
+    Hd44780_Init();
+    Pcf85063_Init(rtcStart);
+    Bh1750_Init();
+    if (flash != NULL)
+    {
+        Sim_FlashOpen(flash);
+    }
+
+    signal(SIGINT, Sim_Signal);
+    signal(SIGALRM, Sim_Signal);
+    if (wallLimit > 0U)
+    {
+        alarm(wallLimit);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &wallStart);
+
+    Sim_Schedule(SIM_MS(SIM_WATCH_MS), Sim_WatchEvent, 0);
+    if (scriptLen > 0U)
+    {
+        Sim_Schedule(script[0].when, Sim_ScriptEvent, 0);
+    }
+
+    return Firmware_Main();
+}
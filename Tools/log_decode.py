@@ -0,0 +1,185 @@
+#!/usr/bin/env python3
+# Created by: Marcin Dziedzic
+# log_decode.py
+"""
+Dekoder binarnego logu (Core/Src/log.c): teksty formatów z sekcji .log_fmt pliku ELF.
+
+Użycie:
+    log_decode.py Debug/LCD_Encoder.elf /dev/ttyACM0     # USART2 (wymaga pyserial)
+    log_decode.py Debug/LCD_Encoder.elf zrzut.bin         # plik z surowym strumieniem UART
+    log_decode.py --swo Debug/LCD_Encoder.elf swo.bin     # strumień ITM (port 24) z SWO
+
+ELF musi pochodzić z tej samej kompilacji co firmware – identyfikator wpisu to
+przesunięcie tekstu w .log_fmt. Ramki telemetrii i tekst konsoli na tym samym
+porcie są pomijane (inny sync / błędne CRC).
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from telemetry_decode import read_chunks  # noqa: E402
+from trace_timeline import itm_words      # noqa: E402
+
+SYNC = b"\xA5\x4C"
+ITM_PORT = 24               # LOG_ITM_PORT
+HDR_VALID = 0x80000000      # LOG_HDR_VALID
+NARGS_SHIFT = 28            # LOG_HDR_NARGS_SHIFT
+ARGS_MAX = 4                # LOG_ARGS_MAX
+
+SPEC = re.compile(r"%([-+ 0#]*)(\d*)(?:\.(\d+))?(?:hh|h|ll|l|z)?([diuxXoc%])")
+
+
+def log_strings(elf_path):
+    """Zawartość sekcji .log_fmt i jej adres (ELF32/ELF64 little-endian, bez zależności).
+
+    ELF64 to build symulacji (Sim/) – ta sama sekcja pod adresem 0."""
+    with open(elf_path, "rb") as f:
+        elf = f.read()
+    if elf[:4] != b"\x7fELF" or elf[4] not in (1, 2):
+        sys.exit("%s: not an ELF file" % elf_path)
+
+    if elf[4] == 1:
+        shoff, = struct.unpack_from("<I", elf, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from("<HHH", elf, 0x2E)
+        shdr = "<IIIIII"
+    else:
+        shoff, = struct.unpack_from("<Q", elf, 0x28)
+        shentsize, shnum, shstrndx = struct.unpack_from("<HHH", elf, 0x3A)
+        shdr = "<IIQQQQ"
+
+    def section(i):
+        name, _, _, addr, offset, size = struct.unpack_from(shdr, elf, shoff + i * shentsize)
+        return name, addr, offset, size
+
+    _, _, str_off, _ = section(shstrndx)
+    for i in range(shnum):
+        name, addr, offset, size = section(i)
+        end = elf.index(b"\0", str_off + name)
+        if elf[str_off + name:end] == b".log_fmt":
+            return elf[offset:offset + size], addr
+    sys.exit("%s: no .log_fmt section (firmware built without log.h?)" % elf_path)
+
+
+def stm32_crc32(words):
+    """Sprzętowy CRC STM32: wielomian 0x04C11DB7, start 0xFFFFFFFF, słowa 32-bit, bez odbić."""
+    crc = 0xFFFFFFFF
+    for w in words:
+        crc ^= w
+        for _ in range(32):
+            crc = ((crc << 1) ^ 0x04C11DB7) if (crc & 0x80000000) else (crc << 1)
+            crc &= 0xFFFFFFFF
+    return crc
+
+
+def format_c(fmt, args):
+    """printf z C dla argumentów 32-bitowych (%d/%i ze znakiem, pozostałe bez)."""
+    args = list(args)
+
+    def repl(m):
+        flags, width, prec, conv = m.groups()
+        if conv == "%":
+            return "%"
+        if not args:
+            return "<?>"
+        v = args.pop(0)
+        if conv in "di":
+            v = v - (1 << 32) if v & 0x80000000 else v
+            conv = "d"
+        elif conv == "u":
+            conv = "d"
+        elif conv == "c":
+            v = chr(v & 0xFF)
+        spec = "%" + flags + width + (("." + prec) if prec else "") + conv
+        return spec % v
+
+    return SPEC.sub(repl, fmt)
+
+
+class Decoder:
+    def __init__(self, elf_path):
+        self.strings, self.base = log_strings(elf_path)
+
+    def text(self, record):
+        hdr, tick, *args = record
+        offset = (hdr & 0xFFFF) - self.base
+        if not 0 <= offset < len(self.strings):
+            return "[%8.3f] <unknown id 0x%04X>" % (tick / 1000.0, hdr & 0xFFFF)
+        end = self.strings.index(b"\0", offset)
+        fmt = self.strings[offset:end].decode("utf-8", "replace")
+        return "[%8.3f] %s" % (tick / 1000.0, format_c(fmt, args))
+
+
+def uart_records(chunks):
+    """Rekordy (listy słów) z ramek A5 4C | n | n słów | CRC-32; resynchronizacja po sync."""
+    buf = bytearray()
+    for chunk in chunks:
+        buf += chunk
+        while True:
+            start = buf.find(SYNC)
+            if start < 0:
+                del buf[:-1]
+                break
+            if len(buf) - start < 3:
+                del buf[:start]
+                break
+            n = buf[start + 2]
+            if not 2 <= n <= 2 + ARGS_MAX:
+                del buf[:start + 1]
+                continue
+            size = 3 + 4 * n + 4
+            if len(buf) - start < size:
+                del buf[:start]
+                break
+
+            words = list(struct.unpack_from("<%dI" % n, buf, start + 3))
+            crc, = struct.unpack_from("<I", buf, start + 3 + 4 * n)
+            if stm32_crc32(words) != crc or not words[0] & HDR_VALID:
+                del buf[:start + 1]
+                continue
+            del buf[:start + size]
+            yield words
+
+
+def swo_records(data):
+    """Rekordy ze słów portu ITM_PORT: nagłówek określa liczbę kolejnych słów."""
+    record = []
+    need = 0
+    for port, word in itm_words(data):
+        if port != ITM_PORT:
+            continue
+        if not record:
+            if not word & HDR_VALID:
+                continue   # środek rekordu sprzed początku nagrania
+            need = 2 + ((word >> NARGS_SHIFT) & 0x07)
+        record.append(word)
+        if len(record) == need:
+            yield record
+            record = []
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("elf", help="plik ELF firmware (z sekcją .log_fmt)")
+    ap.add_argument("source", help="port szeregowy, plik lub '-' (stdin)")
+    ap.add_argument("--swo", action="store_true", help="strumień ITM z SWO zamiast ramek USART2")
+    args = ap.parse_args()
+
+    dec = Decoder(args.elf)
+    if args.swo:
+        records = swo_records(b"".join(read_chunks(args.source)))
+    else:
+        records = uart_records(read_chunks(args.source))
+
+    try:
+        for rec in records:
+            print(dec.text(rec), flush=True)
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
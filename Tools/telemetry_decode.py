@@ -0,0 +1,111 @@
+#!/usr/bin/env python3
+# Created by: Marcin Dziedzic
+# telemetry_decode.py
+"""
+Dekoder binarnej telemetrii z USART2 (Core/Src/telemetry.c).
+
+Użycie:
+    telemetry_decode.py /dev/ttyACM0          # port szeregowy (wymaga pyserial)
+    telemetry_decode.py zrzut.bin             # plik z surowym strumieniem
+    cat zrzut.bin | telemetry_decode.py -     # stdin
+
+Wypisuje jedną linię CSV na ramkę; błędy CRC i luki w numeracji na stderr.
+"""
+
+import argparse
+import os
+import struct
+import sys
+
+SYNC = b"\xA5\x5A"
+VERSION = 1
+
+# Od pola version do dropped (bez sync i crc) – zgodnie z TelemetryFrame_t
+BODY = struct.Struct("<BBHIHHBBHHiHHHH")
+FRAME_LEN = len(SYNC) + BODY.size + 2   # 34 bajty
+
+FIELDS = ("seq", "tick_ms", "loop_avg_us", "loop_max_us", "state", "flags",
+          "lux", "level", "alarm_in_s", "rtc_err", "lux_err", "stack_used", "dropped")
+
+STATES = ("MENU", "OPTION", "TOGGLE", "VALUE", "ALARM_SET", "ALARM", "DIMMER", "UI")
+
+
+def crc16_ccitt_false(data):
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if (crc & 0x8000) else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def frames(chunks):
+    """Generator ramek (dict) z kolejnych kawałków bajtów; resynchronizacja po sync."""
+    buf = bytearray()
+    for chunk in chunks:
+        buf += chunk
+        while True:
+            start = buf.find(SYNC)
+            if start < 0:
+                del buf[:-1]
+                break
+            if len(buf) - start < FRAME_LEN:
+                del buf[:start]
+                break
+
+            raw = bytes(buf[start:start + FRAME_LEN])
+            body = raw[2:-2]
+            crc, = struct.unpack_from("<H", raw, FRAME_LEN - 2)
+            if crc16_ccitt_false(body) != crc or body[0] != VERSION or body[1] != BODY.size - 2:
+                # Fałszywy sync w danych – szukamy dalej od następnego bajtu
+                sys.stderr.write("crc/version mismatch at offset %d\n" % start)
+                del buf[:start + 1]
+                continue
+
+            version, length, *values = BODY.unpack(body)
+            del buf[:start + FRAME_LEN]
+            yield dict(zip(FIELDS, values))
+
+
+def read_chunks(source):
+    if source == "-":
+        stream = sys.stdin.buffer
+    elif os.path.exists(source) and not source.startswith("/dev/"):
+        stream = open(source, "rb")
+    else:
+        import serial  # pyserial
+        stream = serial.Serial(source, 115200, timeout=0.5)
+
+    while True:
+        chunk = stream.read(256)
+        if not chunk:
+            if source == "-" or not source.startswith("/dev/"):
+                return
+            continue
+        yield chunk
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("source", help="port szeregowy, plik lub '-' (stdin)")
+    args = ap.parse_args()
+
+    print(",".join(FIELDS))
+    last_seq = None
+    try:
+        for f in frames(read_chunks(args.source)):
+            if last_seq is not None and f["seq"] != (last_seq + 1) & 0xFFFF:
+                sys.stderr.write("gap: seq %d -> %d\n" % (last_seq, f["seq"]))
+            last_seq = f["seq"]
+
+            state = f["state"]
+            f["state"] = STATES[state] if state < len(STATES) else str(state)
+            f["flags"] = "0x%02X" % f["flags"]
+            print(",".join(str(f[k]) for k in FIELDS), flush=True)
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,213 @@
+#!/usr/bin/env python3
+# Created by: Marcin Dziedzic
+# trace_timeline.py
+"""
+Oś czasu ze zdarzeń tracera (Core/Src/trace.c).
+
+Użycie:
+    trace_timeline.py swo.bin                  # surowy strumień ITM z SWO
+    trace_timeline.py --uart zrzut.txt         # wynik polecenia "trace" z konsoli
+    trace_timeline.py swo.bin --chrome out.json
+
+Strumień SWO zapisuje np. OpenOCD:
+    tpiu config internal swo.bin uart off 64000000 2000000
+    itm ports on
+
+Domyślnie wypisuje oś czasu (µs od pierwszego zdarzenia, odstęp od poprzedniego,
+wcięcie = zagnieżdżenie przerwań/transakcji) i podsumowanie czasów odcinków.
+--chrome zapisuje plik dla chrome://tracing / ui.perfetto.dev.
+"""
+
+import argparse
+import json
+import sys
+
+PORT_BASE = 1          # TRACE_ITM_PORT_BASE
+ARG_BITS = 11          # TRACE_ARG_BITS
+TIME_BITS = 32 - ARG_BITS
+
+# Kolejność jak TraceEvt_e w trace.h
+EVENTS = ("STATE", "ISR_ENTER", "ISR_EXIT", "I2C_START", "I2C_STOP",
+          "LCD_START", "LCD_STOP", "FADE_STEP", "SECOND")
+
+STATES = ("MENU", "OPTION", "TOGGLE", "VALUE", "ALARM_SET", "ALARM", "DIMMER", "UI")
+
+# Numer wyjątku (IPSR) = IRQn + 16
+EXCEPTIONS = {15: "SysTick", 32: "DMA1_Ch6", 33: "DMA1_Ch7", 39: "EXTI9_5",
+              41: "TIM1_UP", 43: "TIM1_CC", 45: "TIM3", 54: "USART2", 56: "EXTI15_10"}
+
+I2C_DEVICES = {0x51: "rtc", 0x23: "bh1750"}
+HAL_STATUS = ("OK", "ERROR", "BUSY", "TIMEOUT")
+
+# Odcinki: zdarzenie początku -> (zdarzenie końca, kategoria)
+SPANS = {"ISR_ENTER": ("ISR_EXIT", "isr"),
+         "I2C_START": ("I2C_STOP", "i2c"),
+         "LCD_START": ("LCD_STOP", "lcd")}
+SPAN_ENDS = {end: start for start, (end, _) in SPANS.items()}
+
+
+def itm_words(data):
+    """Słowa z portów programowych ITM: (port, wartość). Pakiety sync, overflow,
+    znaczniki czasu i rozszerzenia są pomijane."""
+    i = 0
+    n = len(data)
+    while i < n:
+        h = data[i]
+        if h in (0x00, 0x80):   # sync: zera zakończone 0x80
+            i += 1
+            continue
+        if h == 0x70:
+            sys.stderr.write("itm overflow at offset %d\n" % i)
+            i += 1
+            continue
+        size = h & 0x03
+        if size:
+            length = 4 if size == 3 else size
+            if i + 1 + length > n:
+                break
+            if not h & 0x04:   # 0 = stymulacja programowa, 1 = pakiet sprzętowy DWT
+                yield h >> 3, int.from_bytes(data[i + 1:i + 1 + length], "little")
+            i += 1 + length
+            continue
+        # Znaczniki czasu, rozszerzenia: bajty z bitem kontynuacji
+        i += 1
+        if h & 0x80:
+            while i < n and data[i] & 0x80:
+                i += 1
+            i += 1
+
+
+def events_from_swo(data):
+    """(czas_us_narastająco, id, arg); 21-bitowy czas rozwijany od poprzedniego zdarzenia."""
+    mask = (1 << TIME_BITS) - 1
+    last = None
+    t = 0
+    for port, word in itm_words(data):
+        evt = port - PORT_BASE
+        if not 0 <= evt < len(EVENTS):
+            continue
+        raw = word >> ARG_BITS
+        t = 0 if last is None else t + ((raw - last) & mask)
+        last = raw
+        yield t, evt, word & ((1 << ARG_BITS) - 1)
+
+
+def events_from_uart(lines, mhz):
+    """Linie "trc <µs> <id> <arg>" z polecenia trace; µs z CYCCNT zawija się co 2^32 cykli."""
+    wrap = (1 << 32) // mhz
+    last = None
+    t = 0
+    for line in lines:
+        parts = line.split()
+        if len(parts) != 4 or parts[0] != "trc":
+            continue
+        us, evt, arg = (int(p) for p in parts[1:])
+        t = 0 if last is None else t + ((us - last) % wrap)
+        last = us
+        yield t, evt, arg
+
+
+def describe(name, arg):
+    if name == "STATE":
+        return STATES[arg] if arg < len(STATES) else str(arg)
+    if name in ("ISR_ENTER", "ISR_EXIT"):
+        return EXCEPTIONS.get(arg, "exc%d" % arg)
+    if name == "I2C_START":
+        return I2C_DEVICES.get(arg, "0x%02X" % arg)
+    if name == "I2C_STOP":
+        return HAL_STATUS[arg] if arg < len(HAL_STATUS) else str(arg)
+    if name == "LCD_STOP":
+        return "%d chars" % arg
+    if name == "FADE_STEP":
+        return "level %d" % (arg << 5)
+    if name == "SECOND":
+        return ":%02d" % arg
+    return "" if arg == 0 else str(arg)
+
+
+def timeline(events, out):
+    """Tekstowa oś czasu + podsumowanie odcinków {kategoria/nazwa: [czasy]}."""
+    open_spans = []      # stos (nazwa początku, opis, czas)
+    durations = {}
+    prev = None
+    for t, evt, arg in events:
+        name = EVENTS[evt]
+        text = describe(name, arg)
+        dt = 0 if prev is None else t - prev
+        prev = t
+
+        extra = ""
+        if name in SPAN_ENDS:
+            # Zamknięcie najbliższego otwartego odcinka tego rodzaju
+            for k in range(len(open_spans) - 1, -1, -1):
+                if open_spans[k][0] == SPAN_ENDS[name]:
+                    start_name, start_text, t0 = open_spans.pop(k)
+                    key = "%s %s" % (SPANS[start_name][1], start_text)
+                    durations.setdefault(key, []).append(t - t0)
+                    extra = "  [%d us]" % (t - t0)
+                    break
+
+        depth = len(open_spans)
+        out.write("%10d %+8d %s%-10s %s%s\n" % (t, dt, "  " * depth, name, text, extra))
+
+        if name in SPANS:
+            open_spans.append((name, text, t))
+    return durations
+
+
+def chrome_trace(events):
+    """Chrome Trace Event Format: odcinki B/E w osobnych wątkach, reszta jako zdarzenia chwilowe."""
+    tids = {"isr": 1, "i2c": 2, "lcd": 3, "state": 4, "fade": 5, "clock": 6}
+    out = []
+    for t, evt, arg in events:
+        name = EVENTS[evt]
+        text = describe(name, arg)
+        if name in SPANS:
+            cat = SPANS[name][1]
+            out.append({"name": "%s %s" % (cat, text), "cat": cat, "ph": "B", "ts": t,
+                        "pid": 1, "tid": tids[cat]})
+        elif name in SPAN_ENDS:
+            cat = SPANS[SPAN_ENDS[name]][1]
+            out.append({"cat": cat, "ph": "E", "ts": t, "pid": 1, "tid": tids[cat],
+                        "args": {"result": text}})
+        elif name == "FADE_STEP":
+            out.append({"name": "level", "ph": "C", "ts": t, "pid": 1, "args": {"level": arg << 5}})
+        else:
+            cat = "state" if name == "STATE" else "clock"
+            out.append({"name": text, "cat": cat, "ph": "i", "s": "t", "ts": t,
+                        "pid": 1, "tid": tids[cat]})
+    return {"traceEvents": out, "displayTimeUnit": "ms"}
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("source", help="plik lub '-' (stdin)")
+    ap.add_argument("--uart", action="store_true", help="tekstowy zrzut polecenia 'trace' zamiast strumienia SWO")
+    ap.add_argument("--mhz", type=int, default=64, help="zegar rdzenia (MHz) dla --uart, domyślnie 64")
+    ap.add_argument("--chrome", metavar="JSON", help="zapis w formacie chrome://tracing")
+    args = ap.parse_args()
+
+    stream = sys.stdin.buffer if args.source == "-" else open(args.source, "rb")
+    data = stream.read()
+
+    if args.uart:
+        events = list(events_from_uart(data.decode("ascii", "replace").splitlines(), args.mhz))
+    else:
+        events = list(events_from_swo(data))
+
+    if args.chrome:
+        with open(args.chrome, "w") as f:
+            json.dump(chrome_trace(events), f)
+        sys.stderr.write("%d events -> %s\n" % (len(events), args.chrome))
+        return
+
+    durations = timeline(events, sys.stdout)
+    if durations:
+        print("\n%-20s %6s %8s %8s" % ("span", "n", "avg_us", "max_us"))
+        for key in sorted(durations):
+            d = durations[key]
+            print("%-20s %6d %8d %8d" % (key, len(d), sum(d) // len(d), max(d)))
+
+
+if __name__ == "__main__":
+    main()